@@ -1,4 +1,5 @@
 #include "Database.h"
+#include "../Library/Singleton.h"
 
 namespace Gamnet {	namespace Database {
 	void ReadXml(const char* xml_path)
@@ -10,4 +11,14 @@ namespace Gamnet {	namespace Database {
 	{
 		return MySQL::Connect(db_type, host, port, id, passwd, db);
 	}
+
+	Json::Value State()
+	{
+		return Singleton<Statistics>::GetInstance().State();
+	}
+
+	void SetSlowQueryThreshold(int milliseconds)
+	{
+		Singleton<Statistics>::GetInstance().SetSlowQueryThreshold(milliseconds);
+	}
 }}
\ No newline at end of file
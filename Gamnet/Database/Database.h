@@ -4,12 +4,17 @@
 #include "MySQL/MySQL.h"
 #include "Redis/Redis.h"
 #include "SQLite/SQLite.h"
+#include "Statistics.h"
 
 namespace Gamnet {	namespace Database {
 	typedef MySQL::ResultSet ResultSet;
 	typedef MySQL::Transaction Transaction;
 	void ReadXml(const char* xml_path);
 	bool Connect(int db_type, const char* host, int port, const char* id, const char* passwd, const char* db);
+	// query count, latency histogram, error count and pool wait time of every backend and db_type
+	Json::Value State();
+	// queries slower than 'milliseconds' are logged with their fingerprint. 0 disables
+	void SetSlowQueryThreshold(int milliseconds);
 
 	template <class... ARGS>
 	ResultSet Execute(int db_type, ARGS... args)
@@ -67,6 +67,7 @@ namespace Gamnet {	namespace Database { namespace MySQL {
 			for (unsigned int i = 0; (field = mysql_fetch_field(impl->res_)); i++)
 			{
 				impl->mapColumnName_[field->name] = i;
+				impl->vecColumnType_.push_back(ResultSetImpl::GetColumnType(field));
 			}
 		}
 		else
@@ -0,0 +1,261 @@
+#include "Loader.h"
+#include "MySQL.h"
+#include "../../Library/Singleton.h"
+#include "../../Library/Exception.h"
+#include "../../Library/ThreadPool.h"
+#include "../../Log/Log.h"
+#include <algorithm>
+#include <cctype>
+
+namespace Gamnet { namespace Database { namespace MySQL {
+
+	Loader::Loader(int db_type, const std::string& select, const std::string& key_column) : db_type_(db_type), select_(select), key_column_(key_column)
+	{
+	}
+
+	Loader& Loader::Add(const std::string& key)
+	{
+		if (mapRows_.end() == mapRows_.find(key))
+		{
+			pending_.insert(key);
+		}
+		return *this;
+	}
+
+	void Loader::Load()
+	{
+		if (true == pending_.empty())
+		{
+			return;
+		}
+		const std::vector<std::string> keys(pending_.begin(), pending_.end());
+		pending_.clear();
+		Fetch(db_type_, select_, key_column_, keys, mapRows_);
+	}
+
+	const Loader::Rows& Loader::Get(const std::string& key)
+	{
+		auto itr = mapRows_.find(key);
+		if (mapRows_.end() != itr)
+		{
+			return itr->second;
+		}
+		Add(key);
+		Load();
+		return mapRows_[key];
+	}
+
+	std::string Loader::MakeQuery(const std::string& select, const std::string& key_column, const std::string& keys)
+	{
+		// find WHERE and the first clause after it at the top level, out of quotes and parentheses
+		std::string lower = select;
+		std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+		size_t where = std::string::npos;
+		size_t tail = select.size();
+		int depth = 0;
+		for (size_t i = 0; i < lower.size() && select.size() == tail; i++)
+		{
+			const char c = lower[i];
+			if ('\'' == c || '"' == c || '`' == c)
+			{
+				for (i++; i < lower.size() && c != lower[i]; i++)
+				{
+					if ('\\' == lower[i])
+					{
+						i++;
+					}
+				}
+				continue;
+			}
+			if ('(' == c || ')' == c)
+			{
+				depth += ('(' == c ? 1 : -1);
+				continue;
+			}
+			if (0 != depth || 0 == std::isalpha((unsigned char)c) || (0 < i && (0 != std::isalnum((unsigned char)lower[i - 1]) || '_' == lower[i - 1])))
+			{
+				continue;
+			}
+			size_t end = i;
+			while (end < lower.size() && (0 != std::isalnum((unsigned char)lower[end]) || '_' == lower[end]))
+			{
+				end++;
+			}
+			const std::string word = lower.substr(i, end - i);
+			if ("where" == word)
+			{
+				where = i;
+			}
+			else if ("group" == word || "having" == word || "window" == word || "order" == word || "limit" == word || "for" == word || "lock" == word || "union" == word)
+			{
+				tail = i;
+			}
+			i = end - 1;
+		}
+
+		auto trim = [](std::string str) {
+			str.erase(0, std::min(str.size(), str.find_first_not_of(" \t\r\n")));
+			str.erase(str.find_last_not_of(" \t\r\n") + 1);
+			return str;
+		};
+		const std::string condition = key_column + " IN (" + keys + ")";
+		std::string query;
+		if (std::string::npos == where)
+		{
+			query = trim(select.substr(0, tail)) + " WHERE " + condition;
+		}
+		else
+		{
+			// parentheses keep 'a OR b' of the original condition from taking the key condition as its operand
+			query = select.substr(0, where + 5) + " (" + trim(select.substr(where + 5, tail - where - 5)) + ") AND " + condition;
+		}
+		if (select.size() != tail)
+		{
+			query += " " + select.substr(tail);
+		}
+		return query;
+	}
+
+	void Loader::Fetch(int db_type, const std::string& select, const std::string& key_column, const std::vector<std::string>& keys, std::map<std::string, Rows>& rows)
+	{
+		for (size_t begin = 0; begin < keys.size(); begin += MAX_KEY_COUNT)
+		{
+			const size_t end = std::min(keys.size(), begin + (size_t)MAX_KEY_COUNT);
+			std::string in;
+			for (size_t i = begin; i < end; i++)
+			{
+				if (begin != i)
+				{
+					in += ",";
+				}
+				in += Quote(keys[i]);
+				rows[keys[i]];
+			}
+
+			ResultSet res = Execute(db_type, MakeQuery(select, key_column, in));
+			if (0 == res.GetRowCount())
+			{
+				continue;
+			}
+			auto column = res.impl_->mapColumnName_.find(key_column);
+			if (res.impl_->mapColumnName_.end() == column)
+			{
+				throw GAMNET_EXCEPTION(ErrorCode::InvalidKeyError, "Unknown column '", key_column, "' in 'field list'");
+			}
+			for (auto row = res.begin(); row != res.end(); row++)
+			{
+				if (NULL == row->row_[column->second])
+				{
+					continue;
+				}
+				rows[row->row_[column->second]].push_back(row);
+			}
+		}
+	}
+
+	BatchLoader::BatchLoader(int db_type, const std::string& select, const std::string& key_column, int window) :
+		db_type_(db_type),
+		select_(select),
+		key_column_(key_column),
+		window_(window),
+		timer_(Singleton<boost::asio::io_service>::GetInstance()),
+		scheduled_(false)
+	{
+	}
+
+	void BatchLoader::Load(const std::string& key, boost::asio::strand& strand, const HANDLER& handler)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		Waiter waiter = { strand, handler };
+		mapWaiter_[key].push_back(waiter);
+		if (Loader::MAX_KEY_COUNT <= mapWaiter_.size())
+		{
+			// full batch doesn't wait for the window
+			timer_.cancel();
+			PostFlush();
+			return;
+		}
+		if (true == scheduled_)
+		{
+			return;
+		}
+
+		scheduled_ = true;
+		auto self = shared_from_this();
+		timer_.expires_from_now(boost::posix_time::milliseconds(window_));
+		timer_.async_wait([self](const boost::system::error_code& ec) {
+			if (boost::asio::error::operation_aborted == ec)
+			{
+				return;
+			}
+			std::lock_guard<std::mutex> lo(self->lock_);
+			self->PostFlush();
+		});
+	}
+
+	struct BatchLoaderThreadPool : public ThreadPool
+	{
+		BatchLoaderThreadPool() : ThreadPool(BatchLoader::THREAD_COUNT)
+		{
+		}
+	};
+
+	void BatchLoader::PostFlush()
+	{
+		scheduled_ = false;
+		if (true == mapWaiter_.empty())
+		{
+			return;
+		}
+		std::shared_ptr<std::map<std::string, std::vector<Waiter>>> mapWaiter = std::make_shared<std::map<std::string, std::vector<Waiter>>>();
+		mapWaiter->swap(mapWaiter_);
+
+		// 'Fetch' blocks on mysql. timer callback is on an io thread
+		auto self = shared_from_this();
+		Singleton<BatchLoaderThreadPool>::GetInstance().PostTask([self, mapWaiter]() {
+			self->Flush(*mapWaiter);
+		});
+	}
+
+	void BatchLoader::Flush(std::map<std::string, std::vector<Waiter>>& mapWaiter)
+	{
+		std::vector<std::string> keys;
+		for (auto& itr : mapWaiter)
+		{
+			keys.push_back(itr.first);
+		}
+
+		int errorCode = ErrorCode::Success;
+		std::shared_ptr<std::map<std::string, Loader::Rows>> rows = std::make_shared<std::map<std::string, Loader::Rows>>();
+		try {
+			Loader::Fetch(db_type_, select_, key_column_, keys, *rows);
+		}
+		catch (const Exception& e)
+		{
+			LOG(GAMNET_ERR, "[MySQL] batch load fail(db_type:", db_type_, ", key_count:", keys.size(), ", error:", e.what(), ")");
+			errorCode = e.error_code();
+			rows = std::make_shared<std::map<std::string, Loader::Rows>>();
+		}
+
+		for (auto& itr : mapWaiter)
+		{
+			const std::string key = itr.first;
+			for (Waiter& waiter : itr.second)
+			{
+				HANDLER handler = waiter.handler;
+				waiter.strand.post([handler, errorCode, rows, key]() {
+					// handlers of other keys read the same map at the same time, so no 'operator []' here
+					static const Loader::Rows empty;
+					auto itr = rows->find(key);
+					try {
+						handler(errorCode, rows->end() != itr ? itr->second : empty);
+					}
+					catch (const Exception& e)
+					{
+						LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+					}
+				});
+			}
+		}
+	}
+} } }
@@ -0,0 +1,124 @@
+#ifndef GAMNET_DATABASE_MYSQL_LOADER_H_
+#define GAMNET_DATABASE_MYSQL_LOADER_H_
+
+#include <boost/asio.hpp>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "ResultSet.h"
+#include "../../Library/String.h"
+
+namespace Gamnet { namespace Database { namespace MySQL {
+	/*!
+	 * \brief collects key lookups and loads them with one 'SELECT ... WHERE key_column IN (...)'
+	 *
+	 *		create one per table in a handler, add all keys and get rows by key. loaded keys are memoized,
+	 *		so 'Get' for the same key doesn't query again. 'Get' for a key not loaded yet loads all added keys.
+	 *		keys are compared as text returned by mysql, so use the same form(ex. no leading zero for integer).
+	 *		'select' may have its own WHERE, GROUP BY, ORDER BY or LIMIT. its WHERE condition is put in parentheses and
+	 *		the key condition is added before the trailing clauses, but LIMIT applies to the whole batch, not per key.
+	 * <pre>
+		Gamnet::Database::MySQL::Loader loader(db_type, "SELECT USER_SEQ, USER_NAME FROM USER", "USER_SEQ");
+		for(uint64_t friend_seq : friends)
+		{
+			loader.Add(friend_seq);
+		}
+		for(uint64_t friend_seq : friends)
+		{
+			for(auto row : loader.Get(friend_seq))
+			{
+				row->getString("USER_NAME");
+			}
+		}
+	 * </pre>
+	 */
+	class Loader {
+	public :
+		// row refers to the result set of batch query. don't call '++' on it
+		typedef ResultSet::iterator Row;
+		typedef std::vector<Row> Rows;
+
+		enum {
+			MAX_KEY_COUNT = 1000 // max keys in one IN clause
+		};
+	private :
+		const int db_type_;
+		const std::string select_;
+		const std::string key_column_;
+		std::set<std::string> pending_;
+		std::map<std::string, Rows> mapRows_;
+	public :
+		Loader(int db_type, const std::string& select, const std::string& key_column);
+
+		Loader& Add(const std::string& key);
+		template <class T>
+		Loader& Add(const T& key)
+		{
+			return Add(Format(key));
+		}
+
+		// query all added keys not loaded yet
+		void Load();
+
+		const Rows& Get(const std::string& key);
+		template <class T>
+		const Rows& Get(const T& key)
+		{
+			return Get(Format(key));
+		}
+
+		// 'select' with 'key_column IN (' + 'keys' + ')' added to its WHERE
+		static std::string MakeQuery(const std::string& select, const std::string& key_column, const std::string& keys);
+		// run batch queries for 'keys' and put rows of each key to 'rows'. keys without row get empty rows
+		static void Fetch(int db_type, const std::string& select, const std::string& key_column, const std::vector<std::string>& keys, std::map<std::string, Rows>& rows);
+	};
+
+	/*!
+	 * \brief coalesces key lookups from different sessions within 'window' milliseconds into one batch query
+	 *
+	 *		handler is called in the strand given by caller. error_code is ErrorCode::Success or error code of the query.
+	 *		should be created by std::make_shared and shared by the callers.
+	 *		batch query runs on a thread pool shared by all batch loaders, so io threads are not blocked.
+	 */
+	class BatchLoader : public std::enable_shared_from_this<BatchLoader> {
+	public :
+		typedef std::function<void(int error_code, const Loader::Rows& rows)> HANDLER;
+		enum {
+			THREAD_COUNT = 4
+		};
+	private :
+		struct Waiter
+		{
+			boost::asio::strand strand;
+			HANDLER handler;
+		};
+
+		const int db_type_;
+		const std::string select_;
+		const std::string key_column_;
+		const int window_;
+
+		std::mutex lock_;
+		std::map<std::string, std::vector<Waiter>> mapWaiter_;
+		boost::asio::deadline_timer timer_;
+		bool scheduled_;
+
+		// hands the waiting keys over to the thread pool. called with 'lock_' held
+		void PostFlush();
+		void Flush(std::map<std::string, std::vector<Waiter>>& mapWaiter);
+	public :
+		BatchLoader(int db_type, const std::string& select, const std::string& key_column, int window = 2);
+
+		void Load(const std::string& key, boost::asio::strand& strand, const HANDLER& handler);
+		template <class T>
+		void Load(const T& key, boost::asio::strand& strand, const HANDLER& handler)
+		{
+			Load(Format(key), strand, handler);
+		}
+	};
+} } }
+#endif
@@ -1,5 +1,6 @@
 #include "MySQL.h"
 #include "../ConnectionPool.h"
+#include "../Statistics.h"
 #include "../../Library/Singleton.h"
 #include "../../Library/Exception.h"
 #include <boost/property_tree/ptree.hpp>
@@ -8,6 +9,50 @@
 
 namespace Gamnet { namespace Database { namespace MySQL {
 
+static void ReadShardXml(const boost::property_tree::ptree& shard)
+{
+	const int id = shard.get<int>("<xmlattr>.id");
+	const std::string type = shard.get<std::string>("<xmlattr>.type", "hash");
+	std::vector<int> db_types;
+	std::map<uint64_t, int> ranges;
+	for(auto db : shard)
+	{
+		if("db" != db.first)
+		{
+			continue;
+		}
+		db_types.push_back(db.second.get<int>("<xmlattr>.id"));
+		if("range" != type)
+		{
+			continue;
+		}
+		// no default. a missing 'begin' would silently take over the range starting at 0
+		boost::optional<uint64_t> begin = db.second.get_optional<uint64_t>("<xmlattr>.begin");
+		if(false == (bool)begin)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "range shard needs 'begin' of each db(id:", id, ", db:", db_types.back(), ")");
+		}
+		if(false == ranges.insert(std::make_pair(*begin, db_types.back())).second)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "overlapped range shard(id:", id, ", begin:", *begin, ", db:", ranges[*begin], " and ", db_types.back(), ")");
+		}
+	}
+
+	bool result = false;
+	if("range" == type)
+	{
+		result = CreateRangeShard(id, ranges);
+	}
+	else
+	{
+		result = CreateHashShard(id, db_types, shard.get<int>("<xmlattr>.bucket", 1024));
+	}
+	if(false == result)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "invalid shard configuration(id:", id, ", type:", type, ")");
+	}
+}
+
 void ReadXml(const char* xml_path)
 {
 	boost::property_tree::ptree ptree_;
@@ -16,6 +61,11 @@ void ReadXml(const char* xml_path)
 	auto database_ = ptree_.get_child("server");
 	for(auto elmt : database_)
 	{
+		if("shard" == elmt.first)
+		{
+			ReadShardXml(elmt.second);
+			continue;
+		}
 		if("database" != elmt.first)
 		{
 			continue;
@@ -30,6 +80,25 @@ void ReadXml(const char* xml_path)
 		{
 			throw GAMNET_EXCEPTION(ErrorCode::ConnectFailError, "database connect  fail(id:", id, ", host:", host, ", port:", port, ", user:", user, ", password:", passwd, ", db_name:", db);
 		}
+
+		const int max_lag = elmt.second.get<int>("<xmlattr>.max_replica_lag", 5);
+		const int sticky_time = elmt.second.get<int>("<xmlattr>.sticky_time", 3000);
+		for(auto replica : elmt.second)
+		{
+			if("replica" != replica.first)
+			{
+				continue;
+			}
+			const std::string replica_host = replica.second.get<std::string>("<xmlattr>.host");
+			int replica_port = replica.second.get<int>("<xmlattr>.port", port);
+			const std::string replica_user = replica.second.get<std::string>("<xmlattr>.user", user);
+			const std::string replica_passwd = replica.second.get<std::string>("<xmlattr>.passwd", passwd);
+			const std::string replica_db = replica.second.get<std::string>("<xmlattr>.db", db);
+			if(false == AddReplica(id, replica_host.c_str(), replica_port, replica_user.c_str(), replica_passwd.c_str(), replica_db.c_str(), max_lag, sticky_time))
+			{
+				throw GAMNET_EXCEPTION(ErrorCode::ConnectFailError, "replica connect fail(id:", id, ", host:", replica_host, ", port:", replica_port, ", user:", replica_user, ", db_name:", replica_db, ")");
+			}
+		}
 	}
 }
 
@@ -44,15 +113,118 @@ bool Connect(int db_type, const char* host, int port, const char* id, const char
 	return Singleton<ConnectionPool<Connection>>::GetInstance().Connect(db_type, connInfo);
 }
 
-ResultSet Execute(int db_type, const std::string& query)
+bool AddReplica(int db_type, const char* host, int port, const char* id, const char* passwd, const char* db, int max_lag, int sticky_time)
+{
+	Connection::ConnectionInfo connInfo;
+	connInfo.db_ = db;
+	connInfo.id_ = id;
+	connInfo.passwd_ = passwd;
+	connInfo.port_ = port;
+	connInfo.uri_ = host;
+	return Singleton<ReplicaManager>::GetInstance().AddReplica(db_type, connInfo, max_lag, sticky_time);
+}
+
+static ResultSet ExecuteQuery(int db_type, const std::string& query, const std::shared_ptr<ReplicaSet>& replicaSet)
 {
-	std::shared_ptr<Connection> conn = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
+	Statistics::Sample sample("MySQL", db_type, query);
 	ResultSet res;
-	res.impl_ = conn->Execute(query);
-	res.impl_->conn_ = conn;
+	if (nullptr == replicaSet || false == replicaSet->Execute(query, res, sample))
+	{
+		std::shared_ptr<Connection> conn = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
+		sample.Acquire();
+		res.impl_ = conn->Execute(query);
+		res.impl_->conn_ = conn;
+	}
+	sample.Finish(NULL != res.impl_->res_ ? res.GetRowCount() : res.GetAffectedRow());
 	return res;
 }
 
+ResultSet Execute(int db_type, const std::string& query)
+{
+	// caller may read what it has just written, so only explicit reads go to replicas
+	return ExecuteQuery(db_type, query, nullptr);
+}
+
+ResultSet ExecuteRead(int db_type, const std::string& query)
+{
+	std::shared_ptr<ReplicaSet> replicaSet = Singleton<ReplicaManager>::GetInstance().Find(db_type);
+	if (nullptr != replicaSet && false == ReplicaManager::IsReadQuery(query))
+	{
+		replicaSet = nullptr;
+	}
+	return ExecuteQuery(db_type, query, replicaSet);
+}
+
+bool CreateHashShard(int shard_group, const std::vector<int>& db_types, int bucket_count)
+{
+	return Singleton<ShardManager>::GetInstance().CreateHashShard(shard_group, db_types, bucket_count);
+}
+
+bool CreateRangeShard(int shard_group, const std::map<uint64_t, int>& ranges)
+{
+	return Singleton<ShardManager>::GetInstance().CreateRangeShard(shard_group, ranges);
+}
+
+bool MoveShardBuckets(int shard_group, int begin, int end, int db_type)
+{
+	return Singleton<ShardManager>::GetInstance().MoveBuckets(shard_group, begin, end, db_type);
+}
+
+bool SetShardRange(int shard_group, uint64_t begin, int db_type)
+{
+	return Singleton<ShardManager>::GetInstance().SetRange(shard_group, begin, db_type);
+}
+
+ResultSet Execute(const ShardKey& key, const std::string& query)
+{
+	return Execute(Singleton<ShardManager>::GetInstance().GetDBType(key), query);
+}
+
+std::vector<ResultSet> ExecuteAll(int shard_group, const std::string& query)
+{
+	return Singleton<ShardManager>::GetInstance().ExecuteAll(shard_group, query);
+}
+
+std::string Quote(const std::string& value)
+{
+	std::string quoted = "'";
+	for (char c : value)
+	{
+		switch (c)
+		{
+		case '\0': quoted += "\\0"; break;
+		case '\n': quoted += "\\n"; break;
+		case '\r': quoted += "\\r"; break;
+		case '\x1a': quoted += "\\Z"; break;
+		case '\'':
+		case '"':
+		case '\\':
+			quoted += '\\';
+			quoted += c;
+			break;
+		default:
+			quoted += c;
+			break;
+		}
+	}
+	return quoted + "'";
+}
+
+ResultSet Execute(int db_type, StickySession& session, const std::string& query)
+{
+	std::shared_ptr<ReplicaSet> replicaSet = Singleton<ReplicaManager>::GetInstance().Find(db_type);
+	if (false == ReplicaManager::IsReadQuery(query))
+	{
+		session.Write(db_type);
+		replicaSet = nullptr;
+	}
+	else if (nullptr != replicaSet && true == session.IsSticky(db_type, replicaSet->GetStickyTime()))
+	{
+		replicaSet = nullptr;
+	}
+	return ExecuteQuery(db_type, query, replicaSet);
+}
+
 }}}
 
 
@@ -3,16 +3,62 @@
 
 #include "Connection.h"
 #include "Transaction.h"
+#include "Replica.h"
+#include "Shard.h"
+#include "Loader.h"
+#include "WriteBack.h"
 
 namespace Gamnet { namespace Database { namespace MySQL {
 	void ReadXml(const char* xml_path);
 	bool Connect(int db_type, const char* host, int port, const char* id, const char* passwd, const char* db);
+	/*!
+	 * \brief add read replica of 'db_type'. only 'ExecuteRead' and 'Execute' with 'StickySession' read from replicas
+	 * \param max_lag replica lagging more than this seconds is excluded
+	 * \param sticky_time reads of 'StickySession' stay on primary for this milliseconds after the session writes
+	 */
+	bool AddReplica(int db_type, const char* host, int port, const char* id, const char* passwd, const char* db, int max_lag = 5, int sticky_time = 3000);
 	ResultSet Execute(int db_type, const std::string& query);
 	template <class... ARGS>
 	ResultSet Execute(int db_type, ARGS... args)
 	{
 		return Execute(db_type, Format(args...));
 	}
+	// SELECT may go to a replica, so it may not see what was just written. use 'StickySession' to read your writes
+	ResultSet ExecuteRead(int db_type, const std::string& query);
+	template <class... ARGS>
+	ResultSet ExecuteRead(int db_type, ARGS... args)
+	{
+		return ExecuteRead(db_type, Format(args...));
+	}
+	ResultSet Execute(int db_type, StickySession& session, const std::string& query);
+	template <class... ARGS>
+	ResultSet Execute(int db_type, StickySession& session, ARGS... args)
+	{
+		return Execute(db_type, session, Format(args...));
+	}
+	// escape 'value' and enclose it in single quotes as sql string literal
+	std::string Quote(const std::string& value);
+
+	// 'db_types' share buckets evenly. 'shard_group' is used as id of the shard map in 'ShardKey'
+	bool CreateHashShard(int shard_group, const std::vector<int>& db_types, int bucket_count = 1024);
+	// 'ranges' is map of first key of range and db_type
+	bool CreateRangeShard(int shard_group, const std::map<uint64_t, int>& ranges);
+	bool MoveShardBuckets(int shard_group, int begin, int end, int db_type);
+	bool SetShardRange(int shard_group, uint64_t begin, int db_type);
+
+	ResultSet Execute(const ShardKey& key, const std::string& query);
+	template <class... ARGS>
+	ResultSet Execute(const ShardKey& key, ARGS... args)
+	{
+		return Execute(key, Format(args...));
+	}
+	// scatter 'query' to all db_types of 'shard_group' and gather results in ascending order of db_type
+	std::vector<ResultSet> ExecuteAll(int shard_group, const std::string& query);
+	template <class... ARGS>
+	std::vector<ResultSet> ExecuteAll(int shard_group, ARGS... args)
+	{
+		return ExecuteAll(shard_group, Format(args...));
+	}
 }}}
 
 #endif /* DATABASE_H_ */
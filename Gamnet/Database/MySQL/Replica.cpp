@@ -0,0 +1,200 @@
+#include "Replica.h"
+#include "../../Library/Exception.h"
+#include "../../Log/Log.h"
+#include <algorithm>
+#include <cctype>
+
+namespace Gamnet { namespace Database { namespace MySQL {
+
+	void StickySession::Write(int db_type)
+	{
+		mapLastWrite_[db_type] = std::chrono::steady_clock::now();
+	}
+
+	bool StickySession::IsSticky(int db_type, int sticky_time) const
+	{
+		auto itr = mapLastWrite_.find(db_type);
+		if (mapLastWrite_.end() == itr)
+		{
+			return false;
+		}
+		return std::chrono::steady_clock::now() < itr->second + std::chrono::milliseconds(sticky_time);
+	}
+
+	ReplicaSet::ReplicaSet(int max_lag, int sticky_time) : max_lag_(max_lag), sticky_time_(sticky_time), next_(0), lagChecker_(1), checking_(false)
+	{
+	}
+
+	bool ReplicaSet::AddReplica(const Connection::ConnectionInfo& connInfo)
+	{
+		const int index = (int)replicas_.size();
+		if (false == connectionPool_.Connect(index, connInfo))
+		{
+			LOG(GAMNET_ERR, "[MySQL] replica connect fail(host:", connInfo.uri_, ", port:", connInfo.port_, ")");
+			return false;
+		}
+
+		std::shared_ptr<Replica> replica = std::make_shared<Replica>();
+		replica->connInfo = connInfo;
+		replica->healthy = true;
+		replica->lag = 0;
+		replicas_.push_back(replica);
+
+		if (0 == index)
+		{
+			timer_.AutoReset(true);
+			timer_.SetTimer(LAG_CHECK_INTERVAL, std::bind(&ReplicaSet::PostCheckLag, this));
+		}
+		return true;
+	}
+
+	bool ReplicaSet::Execute(const std::string& query, ResultSet& res, Statistics::Sample& sample)
+	{
+		const size_t count = replicas_.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			const size_t index = next_++ % count;
+			Replica& replica = *replicas_[index];
+			if (false == replica.healthy)
+			{
+				continue;
+			}
+
+			try {
+				std::shared_ptr<Connection> conn = connectionPool_.GetConnection((int)index);
+				sample.Acquire();
+				res.impl_ = conn->Execute(query);
+				res.impl_->conn_ = conn;
+				return true;
+			}
+			catch (const Exception& e)
+			{
+				// 2000~2999 are client errors like 'server has gone away'. sql error would fail on primary as well
+				if (ErrorCode::CreateInstanceFailError != e.error_code() && (2000 > e.error_code() || 3000 <= e.error_code()))
+				{
+					throw;
+				}
+				LOG(GAMNET_WRN, "[MySQL] exclude replica(host:", replica.connInfo.uri_, ", port:", replica.connInfo.port_, ", error:", e.what(), ")");
+				replica.healthy = false;
+			}
+		}
+		return false;
+	}
+
+	int ReplicaSet::GetStickyTime() const
+	{
+		return sticky_time_;
+	}
+
+	void ReplicaSet::PostCheckLag()
+	{
+		// 'SHOW SLAVE STATUS' blocks, so timer thread only hands it over. skipped while the last check is running
+		if (true == checking_.exchange(true))
+		{
+			return;
+		}
+		lagChecker_.PostTask([this]() {
+			CheckLag();
+			checking_ = false;
+		});
+	}
+
+	void ReplicaSet::CheckLag()
+	{
+		for (size_t index = 0; index < replicas_.size(); index++)
+		{
+			Replica& replica = *replicas_[index];
+			int lag = -1;
+			try {
+				std::shared_ptr<Connection> conn = connectionPool_.GetConnection((int)index);
+				ResultSet res;
+				res.impl_ = conn->Execute("SHOW SLAVE STATUS");
+				res.impl_->conn_ = conn;
+				if (0 == res.GetRowCount())
+				{
+					lag = 0; // not a replica
+				}
+				for (auto row = res.begin(); row != res.end(); row++)
+				{
+					for (const char* column : { "Seconds_Behind_Master", "Seconds_Behind_Source" })
+					{
+						auto itr = res.impl_->mapColumnName_.find(column);
+						if (res.impl_->mapColumnName_.end() != itr && NULL != row->row_[itr->second])
+						{
+							lag = atoi(row->row_[itr->second]);
+						}
+					}
+				}
+			}
+			catch (const Exception& e)
+			{
+				LOG(GAMNET_WRN, "[MySQL] replica lag check fail(host:", replica.connInfo.uri_, ", port:", replica.connInfo.port_, ", error:", e.what(), ")");
+			}
+
+			// NULL 'Seconds_Behind_Master' means replication is stopped
+			const bool healthy = 0 <= lag && lag <= max_lag_;
+			if (healthy != replica.healthy)
+			{
+				LOG(GAMNET_WRN, "[MySQL] replica ", (true == healthy ? "included" : "excluded"), "(host:", replica.connInfo.uri_, ", port:", replica.connInfo.port_, ", lag:", lag, ", max_lag:", max_lag_, ")");
+			}
+			replica.lag = lag;
+			replica.healthy = healthy;
+		}
+	}
+
+	bool ReplicaManager::AddReplica(int db_type, const Connection::ConnectionInfo& connInfo, int max_lag, int sticky_time)
+	{
+		std::shared_ptr<ReplicaSet>& replicaSet = mapReplicaSet_[db_type];
+		if (nullptr == replicaSet)
+		{
+			replicaSet = std::make_shared<ReplicaSet>(max_lag, sticky_time);
+		}
+		return replicaSet->AddReplica(connInfo);
+	}
+
+	std::shared_ptr<ReplicaSet> ReplicaManager::Find(int db_type) const
+	{
+		auto itr = mapReplicaSet_.find(db_type);
+		if (mapReplicaSet_.end() == itr)
+		{
+			return nullptr;
+		}
+		return itr->second;
+	}
+
+	bool ReplicaManager::IsReadQuery(const std::string& query)
+	{
+		size_t pos = 0;
+		while (pos < query.size())
+		{
+			if (0 != std::isspace((unsigned char)query[pos]) || '(' == query[pos])
+			{
+				pos++;
+			}
+			else if (0 == query.compare(pos, 2, "/*"))
+			{
+				size_t end = query.find("*/", pos + 2);
+				pos = (std::string::npos == end ? query.size() : end + 2);
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		std::string lower = query.substr(pos);
+		std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+		if (0 != lower.compare(0, 6, "select"))
+		{
+			return false;
+		}
+		for (const char* keyword : { "for update", "for share", "lock in share mode", "get_lock(", "last_insert_id(", "found_rows(", " into " })
+		{
+			if (std::string::npos != lower.find(keyword))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} } }
@@ -0,0 +1,78 @@
+#ifndef GAMNET_DATABASE_MYSQL_REPLICA_H_
+#define GAMNET_DATABASE_MYSQL_REPLICA_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
+#include "Connection.h"
+#include "../ConnectionPool.h"
+#include "../Statistics.h"
+#include "../../Library/Timer.h"
+#include "../../Library/ThreadPool.h"
+
+namespace Gamnet { namespace Database { namespace MySQL {
+	/*!
+	 * \brief keeps reads of a session on primary for a while after the session writes
+	 *
+	 *		keep one as a member of user session and pass it to 'Execute'. then the user can read what was just written
+	 *		even if replicas are behind.
+	 */
+	class StickySession {
+		std::map<int, std::chrono::steady_clock::time_point> mapLastWrite_;
+	public :
+		void Write(int db_type);
+		bool IsSticky(int db_type, int sticky_time) const;
+	};
+
+	/*!
+	 * \brief read replicas of one db_type
+	 *
+	 *		replicas are chosen by round robin. replica lagging more than 'max_lag' seconds, or failed to connect,
+	 *		is excluded until next lag check. lag is checked on its own thread, not on io threads.
+	 */
+	class ReplicaSet {
+		struct Replica
+		{
+			Connection::ConnectionInfo connInfo;
+			std::atomic<bool> healthy;
+			std::atomic<int> lag;
+		};
+
+		enum {
+			LAG_CHECK_INTERVAL = 1000 // ms
+		};
+
+		const int max_lag_;
+		const int sticky_time_;
+		std::vector<std::shared_ptr<Replica>> replicas_;
+		ConnectionPool<Connection> connectionPool_;
+		std::atomic<uint32_t> next_;
+		Timer timer_;
+		ThreadPool lagChecker_;
+		std::atomic<bool> checking_;
+
+		void PostCheckLag();
+		void CheckLag();
+	public :
+		ReplicaSet(int max_lag, int sticky_time);
+
+		bool AddReplica(const Connection::ConnectionInfo& connInfo);
+		// return false if no replica is available. 'sample' is told when a replica connection is taken
+		bool Execute(const std::string& query, ResultSet& res, Statistics::Sample& sample);
+		int GetStickyTime() const;
+	};
+
+	class ReplicaManager {
+		std::map<int, std::shared_ptr<ReplicaSet>> mapReplicaSet_;
+	public :
+		bool AddReplica(int db_type, const Connection::ConnectionInfo& connInfo, int max_lag, int sticky_time);
+		// return nullptr if 'db_type' has no replica
+		std::shared_ptr<ReplicaSet> Find(int db_type) const;
+
+		// SELECT without locking read or session dependent function
+		static bool IsReadQuery(const std::string& query);
+	};
+} } }
+#endif
@@ -2,6 +2,7 @@
 #include "Connection.h"
 #include "../../Library/Exception.h"
 #include <boost/lexical_cast.hpp>
+#include <cstring>
 
 namespace Gamnet { namespace Database { namespace MySQL {
 
@@ -35,6 +36,28 @@ ResultSetImpl::~ResultSetImpl()
 	}
 }
 
+Variant::TYPE ResultSetImpl::GetColumnType(const MYSQL_FIELD* field)
+{
+	// ZEROFILL column keeps its text("0007")
+	if (0 != (field->flags & ZEROFILL_FLAG))
+	{
+		return Variant::TYPE_STRING;
+	}
+	switch (field->type)
+	{
+	case MYSQL_TYPE_TINY :
+	case MYSQL_TYPE_SHORT :
+	case MYSQL_TYPE_INT24 :
+	case MYSQL_TYPE_LONG :
+	case MYSQL_TYPE_LONGLONG :
+	case MYSQL_TYPE_YEAR :
+		return (0 != (field->flags & UNSIGNED_FLAG) ? Variant::TYPE_UINT : Variant::TYPE_INT);
+	default :
+		break;
+	}
+	return Variant::TYPE_STRING;
+}
+
 ResultSet::ResultSet() : impl_(NULL)
 {
 }
@@ -293,8 +316,21 @@ double ResultSet::iterator::getDouble(const std::string& column_name)
 
 Variant ResultSet::iterator::operator [] (const std::string& column_name)
 {
-	Variant var(getString(column_name));
-	return var;
+	auto itr = impl_->mapColumnName_.find(column_name);
+	if (impl_->mapColumnName_.end() == itr)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::InvalidKeyError, "Unknown column '", column_name, "' in 'field list'");
+	}
+	if (NULL == row_)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::NullPointerError, "invalid data");
+	}
+	const char* value = row_[itr->second];
+	if (NULL == value)
+	{
+		return Variant();
+	}
+	return Variant(value, ::strlen(value), impl_->vecColumnType_[itr->second]);
 }
 
 } } }
@@ -11,6 +11,7 @@
 #include <mysql.h>
 #include <memory>
 #include <map>
+#include <vector>
 #include "../../Library/Variant.h"
 
 namespace Gamnet { namespace Database { namespace MySQL {
@@ -24,9 +25,13 @@ namespace Gamnet { namespace Database { namespace MySQL {
 		unsigned int affectedRowCount_;
 		unsigned int lastInsertID_;
 		std::map<std::string, unsigned short> mapColumnName_;
+		// integer columns are read into Variant as number without string copy
+		std::vector<Variant::TYPE> vecColumnType_;
 
 		ResultSetImpl();
 		~ResultSetImpl();
+
+		static Variant::TYPE GetColumnType(const MYSQL_FIELD* field);
 	};
 
 	struct ResultSet
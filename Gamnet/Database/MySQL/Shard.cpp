@@ -0,0 +1,196 @@
+#include "Shard.h"
+#include "MySQL.h"
+#include "../../Library/Exception.h"
+#include "../../Log/Log.h"
+#include <future>
+#include <set>
+
+namespace Gamnet { namespace Database { namespace MySQL {
+
+	ShardKey::ShardKey(int shard_group, uint64_t key) : shard_group(shard_group), key(key)
+	{
+	}
+
+	uint64_t ShardMap::Hash(uint64_t key)
+	{
+		// splitmix64 finalizer. sequential user_seq spreads over all buckets
+		key ^= key >> 30;
+		key *= 0xbf58476d1ce4e5b9ULL;
+		key ^= key >> 27;
+		key *= 0x94d049bb133111ebULL;
+		key ^= key >> 31;
+		return key;
+	}
+
+	int ShardMap::GetDBType(uint64_t key) const
+	{
+		if (TYPE_HASH == type)
+		{
+			return buckets[Hash(key) % buckets.size()];
+		}
+
+		auto itr = ranges.upper_bound(key);
+		if (ranges.begin() == itr)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidKeyError, "no shard range for key(key:", key, ")");
+		}
+		return (--itr)->second;
+	}
+
+	std::vector<int> ShardMap::GetDBTypes() const
+	{
+		std::set<int> dbTypes(buckets.begin(), buckets.end());
+		for (auto& itr : ranges)
+		{
+			dbTypes.insert(itr.second);
+		}
+		return std::vector<int>(dbTypes.begin(), dbTypes.end());
+	}
+
+	bool ShardManager::CreateHashShard(int shard_group, const std::vector<int>& db_types, int bucket_count)
+	{
+		if (true == db_types.empty() || (int)db_types.size() > bucket_count)
+		{
+			LOG(GAMNET_ERR, "[MySQL] invalid hash shard(shard_group:", shard_group, ", db_count:", db_types.size(), ", bucket_count:", bucket_count, ")");
+			return false;
+		}
+
+		std::shared_ptr<ShardMap> shardMap = std::make_shared<ShardMap>();
+		shardMap->type = ShardMap::TYPE_HASH;
+		shardMap->buckets.resize(bucket_count);
+		for (int i = 0; i < bucket_count; i++)
+		{
+			// contiguous bucket range per db_type, so moving a range of buckets moves a contiguous part
+			shardMap->buckets[i] = db_types[(size_t)i * db_types.size() / bucket_count];
+		}
+
+		std::lock_guard<std::mutex> lo(lock_);
+		if (false == mapShardMap_.insert(std::make_pair(shard_group, shardMap)).second)
+		{
+			LOG(GAMNET_ERR, "[MySQL] duplicate shard group(shard_group:", shard_group, ")");
+			return false;
+		}
+		return true;
+	}
+
+	bool ShardManager::CreateRangeShard(int shard_group, const std::map<uint64_t, int>& ranges)
+	{
+		if (true == ranges.empty())
+		{
+			LOG(GAMNET_ERR, "[MySQL] invalid range shard(shard_group:", shard_group, ")");
+			return false;
+		}
+
+		std::shared_ptr<ShardMap> shardMap = std::make_shared<ShardMap>();
+		shardMap->type = ShardMap::TYPE_RANGE;
+		shardMap->ranges = ranges;
+
+		std::lock_guard<std::mutex> lo(lock_);
+		if (false == mapShardMap_.insert(std::make_pair(shard_group, shardMap)).second)
+		{
+			LOG(GAMNET_ERR, "[MySQL] duplicate shard group(shard_group:", shard_group, ")");
+			return false;
+		}
+		return true;
+	}
+
+	bool ShardManager::Update(int shard_group, const std::function<bool(ShardMap&)>& edit)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		auto itr = mapShardMap_.find(shard_group);
+		if (mapShardMap_.end() == itr)
+		{
+			LOG(GAMNET_ERR, "[MySQL] can't find shard group(shard_group:", shard_group, ")");
+			return false;
+		}
+
+		std::shared_ptr<ShardMap> shardMap = std::make_shared<ShardMap>(*itr->second);
+		if (false == edit(*shardMap))
+		{
+			return false;
+		}
+		itr->second = shardMap;
+		return true;
+	}
+
+	bool ShardManager::MoveBuckets(int shard_group, int begin, int end, int db_type)
+	{
+		return Update(shard_group, [=](ShardMap& shardMap) {
+			if (ShardMap::TYPE_HASH != shardMap.type || 0 > begin || begin >= end || (int)shardMap.buckets.size() < end)
+			{
+				LOG(GAMNET_ERR, "[MySQL] invalid bucket range(shard_group:", shard_group, ", begin:", begin, ", end:", end, ")");
+				return false;
+			}
+			std::fill(shardMap.buckets.begin() + begin, shardMap.buckets.begin() + end, db_type);
+			LOG(INF, "[MySQL] move shard buckets(shard_group:", shard_group, ", begin:", begin, ", end:", end, ", db_type:", db_type, ")");
+			return true;
+		});
+	}
+
+	bool ShardManager::SetRange(int shard_group, uint64_t begin, int db_type)
+	{
+		return Update(shard_group, [=](ShardMap& shardMap) {
+			if (ShardMap::TYPE_RANGE != shardMap.type)
+			{
+				LOG(GAMNET_ERR, "[MySQL] not a range shard(shard_group:", shard_group, ")");
+				return false;
+			}
+			shardMap.ranges[begin] = db_type;
+			LOG(INF, "[MySQL] set shard range(shard_group:", shard_group, ", begin:", begin, ", db_type:", db_type, ")");
+			return true;
+		});
+	}
+
+	std::shared_ptr<const ShardMap> ShardManager::GetShardMap(int shard_group)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		auto itr = mapShardMap_.find(shard_group);
+		if (mapShardMap_.end() == itr)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidKeyError, "can't find shard group(shard_group:", shard_group, ")");
+		}
+		return itr->second;
+	}
+
+	int ShardManager::GetDBType(const ShardKey& key)
+	{
+		return GetShardMap(key.shard_group)->GetDBType(key.key);
+	}
+
+	std::vector<ResultSet> ShardManager::ExecuteAll(int shard_group, const std::string& query)
+	{
+		const std::vector<int> dbTypes = GetShardMap(shard_group)->GetDBTypes();
+		std::shared_ptr<ThreadPool> threadPool;
+		{
+			std::lock_guard<std::mutex> lo(lock_);
+			if (nullptr == threadPool_)
+			{
+				threadPool_ = std::make_shared<ThreadPool>(SCATTER_THREAD_COUNT);
+			}
+			threadPool = threadPool_;
+		}
+
+		std::vector<std::future<ResultSet>> futures;
+		for (int db_type : dbTypes)
+		{
+			std::shared_ptr<std::promise<ResultSet>> promise = std::make_shared<std::promise<ResultSet>>();
+			futures.push_back(promise->get_future());
+			threadPool->PostTask([promise, db_type, query]() {
+				try {
+					promise->set_value(Execute(db_type, query));
+				}
+				catch (...)
+				{
+					promise->set_exception(std::current_exception());
+				}
+			});
+		}
+
+		std::vector<ResultSet> results;
+		for (std::future<ResultSet>& future : futures)
+		{
+			results.push_back(future.get());
+		}
+		return results;
+	}
+} } }
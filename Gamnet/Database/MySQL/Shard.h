@@ -0,0 +1,78 @@
+#ifndef GAMNET_DATABASE_MYSQL_SHARD_H_
+#define GAMNET_DATABASE_MYSQL_SHARD_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "ResultSet.h"
+#include "../../Library/ThreadPool.h"
+
+namespace Gamnet { namespace Database { namespace MySQL {
+	/*!
+	 * \brief key of sharded data. 'shard_group' is id of shard map and 'key' is usually user_seq
+	 */
+	struct ShardKey
+	{
+		int shard_group;
+		uint64_t key;
+
+		ShardKey(int shard_group, uint64_t key);
+	};
+
+	/*!
+	 * \brief maps shard key to physical db_type
+	 *
+	 *		TYPE_HASH : hash of key selects one of fixed count buckets, and each bucket belongs to a db_type.
+	 *		TYPE_RANGE : key belongs to the db_type of the greatest range begin not greater than the key.
+	 */
+	struct ShardMap
+	{
+		enum TYPE {
+			TYPE_HASH,
+			TYPE_RANGE
+		};
+
+		TYPE type;
+		std::vector<int> buckets;
+		std::map<uint64_t, int> ranges;
+
+		int GetDBType(uint64_t key) const;
+		// distinct db_types in ascending order
+		std::vector<int> GetDBTypes() const;
+		static uint64_t Hash(uint64_t key);
+	};
+
+	/*!
+	 * \brief shard maps by shard_group
+	 *
+	 *		maps are immutable snapshots. editing a map replaces the snapshot, so queries in progress are not affected.
+	 *		moving data between db_types is not done here. copy data first and then edit the map.
+	 */
+	class ShardManager {
+		enum {
+			SCATTER_THREAD_COUNT = 8
+		};
+
+		std::mutex lock_;
+		std::map<int, std::shared_ptr<const ShardMap>> mapShardMap_;
+		std::shared_ptr<ThreadPool> threadPool_;
+
+		bool Update(int shard_group, const std::function<bool(ShardMap&)>& edit);
+	public :
+		bool CreateHashShard(int shard_group, const std::vector<int>& db_types, int bucket_count);
+		bool CreateRangeShard(int shard_group, const std::map<uint64_t, int>& ranges);
+		// assign buckets [begin, end) to 'db_type'
+		bool MoveBuckets(int shard_group, int begin, int end, int db_type);
+		// keys from 'begin' to next range begin belong to 'db_type'
+		bool SetRange(int shard_group, uint64_t begin, int db_type);
+
+		std::shared_ptr<const ShardMap> GetShardMap(int shard_group);
+		int GetDBType(const ShardKey& key);
+		// run 'query' on every db_type of 'shard_group' in parallel. results are in ascending order of db_type
+		std::vector<ResultSet> ExecuteAll(int shard_group, const std::string& query);
+	};
+} } }
+#endif
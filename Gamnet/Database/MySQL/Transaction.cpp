@@ -5,11 +5,15 @@
 
 namespace Gamnet { namespace Database { namespace MySQL {
 
-Transaction::Transaction(int db_type) : commit(false)
+Transaction::Transaction(int db_type) : commit(false), db_type(db_type)
 {
 	connection = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
 	connection->Execute("start transaction");
 }
+Transaction::Transaction(const ShardKey& key) : Transaction(Singleton<ShardManager>::GetInstance().GetDBType(key))
+{
+}
+
 /*
 Transaction::Transaction(int db_type, std::function<void(Transaction& transaction)> t)
 {
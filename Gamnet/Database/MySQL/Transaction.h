@@ -2,23 +2,30 @@
 #define GAMNET_DATABASE_MYSQL_TRANSACTION_H_
 
 #include "Connection.h"
+#include "Shard.h"
+#include "../Statistics.h"
 #include "../../Library/String.h"
 
 namespace Gamnet { namespace Database { namespace MySQL {
 class Transaction {
 	bool commit;
+	int db_type;
 	std::shared_ptr<Connection> connection;
 public:
 	Transaction(int db_type);
+	// transaction on the db_type that 'key' belongs to
+	Transaction(const ShardKey& key);
 	virtual ~Transaction();
 
 	template <class... ARGS>
 	ResultSet Execute(ARGS... args)
 	{
 		const std::string query = Format(args...);
+		Statistics::Sample sample("MySQL", db_type, query);
 		ResultSet res;
 		res.impl_ = connection->Execute(query);
 		res.impl_->conn_ = connection;
+		sample.Finish(NULL != res.impl_->res_ ? res.GetRowCount() : res.GetAffectedRow());
 		return res;
 	}
 	ResultSet Commit();
@@ -0,0 +1,108 @@
+#include "WriteBack.h"
+#include "MySQL.h"
+#include "../../Library/Exception.h"
+#include "../../Log/Log.h"
+
+namespace Gamnet { namespace Database { namespace MySQL {
+
+	void WriteBack::Column::Append(int field, const char* name, const std::string& value)
+	{
+		if (false == set.empty())
+		{
+			set += ",";
+		}
+		set += name;
+		set += "=";
+		set += value;
+		fields.push_back(field);
+	}
+
+	void WriteBack::Entry::Execute(Column& column, const std::function<void(int)>& restore)
+	{
+		if (true == column.fields.empty())
+		{
+			return;
+		}
+		try {
+			MySQL::Execute(db_type, "UPDATE ", table, " SET ", column.set, " WHERE ", where);
+		}
+		catch (const Exception& e)
+		{
+			// keep the fields dirty so that next flush retries them
+			for (int field : column.fields)
+			{
+				restore(field);
+			}
+			LOG(GAMNET_ERR, "[MySQL] write back fail(db_type:", db_type, ", table:", table, ", where:", where, ", error:", e.what(), ")");
+		}
+	}
+
+	WriteBack::WriteBack() : interval_(DEFAULT_INTERVAL), started_(false)
+	{
+	}
+
+	void WriteBack::Init(int interval)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		interval_ = interval;
+		started_ = true;
+		timer_.AutoReset(true);
+		timer_.SetTimer(interval_, std::bind(&WriteBack::OnTimerExpire, this));
+	}
+
+	void WriteBack::Add(const void* data, const std::shared_ptr<Entry>& entry)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		mapEntry_[data] = entry;
+		if (false == started_)
+		{
+			started_ = true;
+			timer_.AutoReset(true);
+			timer_.SetTimer(interval_, std::bind(&WriteBack::OnTimerExpire, this));
+		}
+	}
+
+	void WriteBack::Remove(const void* data)
+	{
+		std::shared_ptr<Entry> entry;
+		{
+			std::lock_guard<std::mutex> lo(lock_);
+			auto itr = mapEntry_.find(data);
+			if (mapEntry_.end() == itr)
+			{
+				return;
+			}
+			entry = itr->second;
+			mapEntry_.erase(itr);
+		}
+		entry->Flush();
+	}
+
+	void WriteBack::OnTimerExpire()
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		for (auto itr = mapEntry_.begin(); itr != mapEntry_.end();)
+		{
+			if (false == itr->second->Post())
+			{
+				LOG(GAMNET_WRN, "[MySQL] session destroyed without unregistering write back data(db_type:", itr->second->db_type, ", table:", itr->second->table, ", where:", itr->second->where, ")");
+				itr = mapEntry_.erase(itr);
+				continue;
+			}
+			itr++;
+		}
+	}
+
+	void WriteBack::FlushAll()
+	{
+		std::map<const void*, std::shared_ptr<Entry>> mapEntry;
+		{
+			std::lock_guard<std::mutex> lo(lock_);
+			mapEntry = mapEntry_;
+		}
+		for (auto& itr : mapEntry)
+		{
+			itr.second->Flush();
+		}
+	}
+} } }
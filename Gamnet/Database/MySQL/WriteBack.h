@@ -0,0 +1,166 @@
+#ifndef GAMNET_DATABASE_MYSQL_WRITEBACK_H_
+#define GAMNET_DATABASE_MYSQL_WRITEBACK_H_
+
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../../Library/String.h"
+#include "../../Library/Timer.h"
+
+namespace Gamnet { namespace Database { namespace MySQL {
+	std::string Quote(const std::string& value);
+
+	/*!
+	 * \brief saves changed fields of session data with 'UPDATE table SET ... WHERE ...' on timer
+	 *
+	 *		data should be a struct generated by 'idlc -d'. updates of a field between flushes are coalesced to one column of
+	 *		one query. only scalar fields are saved. flush is posted to the strand of the session which owns the data,
+	 *		so fields are not read while handlers change them. 'Unregister' on 'Session::OnDestroy' saves the last changes
+	 *		and 'FlushAll' saves every data on shutdown.
+	 * <pre>
+		// after login
+		void Handler_Login::OnLoad(const std::shared_ptr<Session>& session)
+		{
+			Gamnet::Singleton<Gamnet::Database::MySQL::WriteBack>::GetInstance().Register(session, session->user_data, db_type, "USER", Gamnet::Format("USER_SEQ=", session->user_data.user_seq));
+		}
+		void Session::OnDestroy()
+		{
+			Gamnet::Singleton<Gamnet::Database::MySQL::WriteBack>::GetInstance().Unregister(user_data);
+		}
+		user_data.Set_user_id(user_id); // saved on next flush
+	 * </pre>
+	 */
+	class WriteBack {
+	public :
+		enum {
+			DEFAULT_INTERVAL = 10000 // milliseconds
+		};
+
+		// builds 'SET' clause from the dirty fields
+		struct Column
+		{
+			std::string set;
+			std::vector<int> fields;
+
+			void operator () (int field, const char* name, const std::string& value)
+			{
+				Append(field, name, Quote(value));
+			}
+			template <class T>
+			void operator () (int field, const char* name, const T& value)
+			{
+				static_assert(std::is_arithmetic<T>::value, "column should be a number or string");
+				Append(field, name, Number(value));
+			}
+			// max_digits10 reads back the same value. default stream precision keeps only 6 digits
+			template <class T>
+			static typename std::enable_if<std::is_floating_point<T>::value, std::string>::type Number(T value)
+			{
+				std::ostringstream oss;
+				oss.precision(std::numeric_limits<T>::max_digits10);
+				oss << value;
+				return oss.str();
+			}
+			// unary '+' prints char and bool as number
+			template <class T>
+			static typename std::enable_if<false == std::is_floating_point<T>::value, std::string>::type Number(T value)
+			{
+				return Format(+value);
+			}
+			void Append(int field, const char* name, const std::string& value);
+		};
+
+		struct Entry : public std::enable_shared_from_this<Entry>
+		{
+			int db_type;
+			std::string table;
+			std::string where;
+
+			virtual ~Entry() {}
+			// false if owner session was destroyed
+			virtual bool Post() = 0;
+			virtual bool Flush() = 0;
+			void Execute(Column& column, const std::function<void(int)>& restore);
+		};
+
+		template <class SESSION, class T>
+		struct EntryT : public Entry
+		{
+			std::weak_ptr<SESSION> session;
+			T& data;
+
+			EntryT(const std::shared_ptr<SESSION>& session, T& data) : session(session), data(data) {}
+			virtual bool Post() override
+			{
+				std::shared_ptr<SESSION> owner = session.lock();
+				if (nullptr == owner)
+				{
+					return false;
+				}
+				std::shared_ptr<Entry> self = shared_from_this();
+				owner->strand.post([self, owner]() {
+					self->Flush();
+				});
+				return true;
+			}
+			virtual bool Flush() override
+			{
+				std::shared_ptr<SESSION> owner = session.lock();
+				if (nullptr == owner)
+				{
+					return false;
+				}
+				Column column;
+				data.VisitDirtyField(column);
+				for (int field : column.fields)
+				{
+					data.ClearDirty(field);
+				}
+				Execute(column, [this](int field) {
+					data.SetDirty(field);
+				});
+				return true;
+			}
+		};
+	private :
+		std::mutex lock_;
+		std::map<const void*, std::shared_ptr<Entry>> mapEntry_;
+		Timer timer_;
+		int interval_;
+		bool started_;
+
+		void Add(const void* data, const std::shared_ptr<Entry>& entry);
+		void OnTimerExpire();
+	public :
+		WriteBack();
+
+		// start flush timer with 'interval' milliseconds. without 'Init', timer starts on first 'Register' with DEFAULT_INTERVAL
+		void Init(int interval);
+
+		template <class SESSION, class T>
+		void Register(const std::shared_ptr<SESSION>& session, T& data, int db_type, const std::string& table, const std::string& where)
+		{
+			std::shared_ptr<Entry> entry = std::make_shared<EntryT<SESSION, T>>(session, data);
+			entry->db_type = db_type;
+			entry->table = table;
+			entry->where = where;
+			Add(&data, entry);
+		}
+		// save changes of 'data' now and stop tracking it. call in the strand of the session
+		template <class T>
+		void Unregister(T& data)
+		{
+			Remove(&data);
+		}
+		void Remove(const void* data);
+		// save every data in the caller thread. for shutdown after io threads are stopped
+		void FlushAll();
+	};
+} } }
+#endif
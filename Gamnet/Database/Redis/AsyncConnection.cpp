@@ -0,0 +1,529 @@
+#include "AsyncConnection.h"
+#include "../../Library/Singleton.h"
+#include "../../Library/Exception.h"
+#include "../../Log/Log.h"
+#include <cctype>
+
+namespace Gamnet { namespace Database {	namespace Redis {
+
+	static boost::asio::io_service& io_service_ = Singleton<boost::asio::io_service>::GetInstance();
+
+	AsyncConnection::AsyncConnection(const Connection::ConnectionInfo& connInfo) :
+		connInfo_(connInfo),
+		state_(DISCONNECTED),
+		subscribe_mode_(false),
+		generation_(0),
+		socket_(io_service_),
+		resolver_(io_service_),
+		strand_(io_service_),
+		reconnect_timer_(io_service_)
+	{
+	}
+
+	AsyncConnection::~AsyncConnection()
+	{
+	}
+
+	std::vector<std::string> AsyncConnection::Split(const std::string& query)
+	{
+		std::vector<std::string> args;
+		size_t pos = 0;
+		while (true)
+		{
+			while (pos < query.size() && 0 != isspace((unsigned char)query[pos]))
+			{
+				pos++;
+			}
+			if (query.size() <= pos)
+			{
+				return args;
+			}
+
+			std::string arg;
+			while (pos < query.size() && 0 == isspace((unsigned char)query[pos]))
+			{
+				const char c = query[pos++];
+				if ('\'' == c)
+				{
+					size_t end = query.find('\'', pos);
+					if (std::string::npos == end)
+					{
+						throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "unbalanced quotes(query:", query, ")");
+					}
+					arg.append(query, pos, end - pos);
+					pos = end + 1;
+					continue;
+				}
+				if ('"' != c)
+				{
+					arg += c;
+					continue;
+				}
+				while (true)
+				{
+					if (query.size() <= pos)
+					{
+						throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "unbalanced quotes(query:", query, ")");
+					}
+					char q = query[pos++];
+					if ('"' == q)
+					{
+						break;
+					}
+					if ('\\' == q && pos < query.size())
+					{
+						q = query[pos++];
+						switch (q)
+						{
+						case 'n': q = '\n'; break;
+						case 'r': q = '\r'; break;
+						case 't': q = '\t'; break;
+						case 'x':
+							if (pos + 2 <= query.size() && 0 != isxdigit((unsigned char)query[pos]) && 0 != isxdigit((unsigned char)query[pos + 1]))
+							{
+								q = (char)std::stoi(query.substr(pos, 2), nullptr, 16);
+								pos += 2;
+							}
+							break;
+						default: break;
+						}
+					}
+					arg += q;
+				}
+			}
+			args.push_back(arg);
+		}
+	}
+
+	std::string AsyncConnection::Encode(const std::vector<std::string>& args)
+	{
+		std::string command = "*" + std::to_string(args.size()) + "\r\n";
+		for (const std::string& arg : args)
+		{
+			command += "$" + std::to_string(arg.size()) + "\r\n";
+			command += arg;
+			command += "\r\n";
+		}
+		return command;
+	}
+
+	void AsyncConnection::Execute(const std::string& query, boost::asio::strand& strand, const RESULT_HANDLER& handler)
+	{
+		Execute(Split(query), strand, handler);
+	}
+
+	void AsyncConnection::Execute(const std::vector<std::string>& args, boost::asio::strand& strand, const RESULT_HANDLER& handler)
+	{
+		auto self = shared_from_this();
+		boost::asio::strand callerStrand = strand;
+		strand_.post([self, args, callerStrand, handler]() {
+			if (true == self->subscribe_mode_)
+			{
+				LOG(GAMNET_ERR, "[Redis] can not execute command on subscribe connection(command:", (true == args.empty() ? "" : args[0]), ")");
+				std::shared_ptr<ResultSetImpl> impl(new ResultSetImpl());
+				impl->error = "-ERR connection is in subscribe mode";
+				boost::asio::strand(callerStrand).post([handler, impl]() {
+					ResultSet res;
+					res.impl_ = impl;
+					try {
+						handler(res);
+					}
+					catch (const Exception& e)
+					{
+						LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+					}
+				});
+				return;
+			}
+			Request request = { callerStrand, handler };
+			self->requests_.push_back(request);
+			self->Send(args);
+		});
+	}
+
+	void AsyncConnection::Subscribe(const std::string& channel, boost::asio::strand& strand, const MESSAGE_HANDLER& handler)
+	{
+		auto self = shared_from_this();
+		MessageHandler messageHandler = { strand, handler };
+		strand_.post([self, channel, messageHandler]() {
+			self->subscribe_mode_ = true;
+			self->mapMessageHandler_.erase(channel);
+			self->mapMessageHandler_.insert(std::make_pair(channel, messageHandler));
+			self->Send({ "SUBSCRIBE", channel });
+		});
+	}
+
+	void AsyncConnection::PSubscribe(const std::string& pattern, boost::asio::strand& strand, const PMESSAGE_HANDLER& handler)
+	{
+		auto self = shared_from_this();
+		PMessageHandler messageHandler = { strand, handler };
+		strand_.post([self, pattern, messageHandler]() {
+			self->subscribe_mode_ = true;
+			self->mapPMessageHandler_.erase(pattern);
+			self->mapPMessageHandler_.insert(std::make_pair(pattern, messageHandler));
+			self->Send({ "PSUBSCRIBE", pattern });
+		});
+	}
+
+	void AsyncConnection::Unsubscribe(const std::string& channel)
+	{
+		auto self = shared_from_this();
+		strand_.post([self, channel]() {
+			if (0 == self->mapMessageHandler_.erase(channel))
+			{
+				return;
+			}
+			self->Send({ "UNSUBSCRIBE", channel });
+		});
+	}
+
+	void AsyncConnection::PUnsubscribe(const std::string& pattern)
+	{
+		auto self = shared_from_this();
+		strand_.post([self, pattern]() {
+			if (0 == self->mapPMessageHandler_.erase(pattern))
+			{
+				return;
+			}
+			self->Send({ "PUNSUBSCRIBE", pattern });
+		});
+	}
+
+	// should be called in 'strand_'
+	void AsyncConnection::Send(const std::vector<std::string>& args)
+	{
+		if (true == subscribe_mode_ && CONNECTED != state_)
+		{
+			// subscriptions are sent again from handler maps when it connects, so queueing here doubles them
+			if (DISCONNECTED == state_)
+			{
+				AsyncConnect();
+			}
+			return;
+		}
+		send_queue_ += Encode(args);
+		switch (state_)
+		{
+		case DISCONNECTED:
+			AsyncConnect();
+			break;
+		case CONNECTED:
+			if (true == sending_.empty())
+			{
+				FlushSend();
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	void AsyncConnection::AsyncConnect()
+	{
+		state_ = CONNECTING;
+		LOG(INF, "[Redis] async connect...(host:", connInfo_.host, ", port:", connInfo_.port, ")");
+
+		auto self = shared_from_this();
+		const uint32_t generation = generation_;
+		resolver_.async_resolve({ connInfo_.host, Format(connInfo_.port) }, strand_.wrap([self, generation](const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator itr) {
+			if (generation != self->generation_)
+			{
+				return;
+			}
+			if (ec)
+			{
+				self->Close(Format("resolve fail(errstr:", ec.message(), ")"));
+				return;
+			}
+
+			boost::asio::async_connect(self->socket_, itr, self->strand_.wrap([self, generation](const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator) {
+				if (generation != self->generation_)
+				{
+					return;
+				}
+				if (ec)
+				{
+					self->Close(Format("connect fail(errstr:", ec.message(), ")"));
+					return;
+				}
+
+				self->state_ = CONNECTED;
+				self->recv_buffer_.clear();
+				std::string subscribe;
+				for (const auto& itr : self->mapMessageHandler_)
+				{
+					subscribe += Encode({ "SUBSCRIBE", itr.first });
+				}
+				for (const auto& itr : self->mapPMessageHandler_)
+				{
+					subscribe += Encode({ "PSUBSCRIBE", itr.first });
+				}
+				self->send_queue_ = subscribe + self->send_queue_;
+				self->AsyncRead();
+				self->FlushSend();
+			}));
+		}));
+	}
+
+	void AsyncConnection::AsyncRead()
+	{
+		auto self = shared_from_this();
+		const uint32_t generation = generation_;
+		socket_.async_read_some(boost::asio::buffer(read_buffer_, sizeof(read_buffer_)), strand_.wrap([self, generation](const boost::system::error_code& ec, std::size_t readbytes) {
+			if (generation != self->generation_)
+			{
+				return;
+			}
+			if (ec || 0 == readbytes)
+			{
+				self->Close(Format("connection closed(errstr:", ec.message(), ")"));
+				return;
+			}
+
+			self->recv_buffer_.append(self->read_buffer_, readbytes);
+			try
+			{
+				size_t offset = 0;
+				while (offset < self->recv_buffer_.size())
+				{
+					Reply reply;
+					size_t consumed = Reply::Parse(self->recv_buffer_.data() + offset, self->recv_buffer_.size() - offset, reply);
+					if (0 == consumed)
+					{
+						break;
+					}
+					offset += consumed;
+					self->OnReply(reply);
+				}
+				self->recv_buffer_.erase(0, offset);
+			}
+			catch (const Exception& e)
+			{
+				self->Close(e.what());
+				return;
+			}
+			self->AsyncRead();
+		}));
+	}
+
+	void AsyncConnection::FlushSend()
+	{
+		if (true == send_queue_.empty() || CONNECTED != state_)
+		{
+			return;
+		}
+
+		sending_.swap(send_queue_);
+		send_queue_.clear();
+
+		auto self = shared_from_this();
+		const uint32_t generation = generation_;
+		boost::asio::async_write(socket_, boost::asio::buffer(sending_), strand_.wrap([self, generation](const boost::system::error_code& ec, std::size_t) {
+			if (generation != self->generation_)
+			{
+				return;
+			}
+			self->sending_.clear();
+			if (ec)
+			{
+				self->Close(Format("send fail(errstr:", ec.message(), ")"));
+				return;
+			}
+			self->FlushSend();
+		}));
+	}
+
+	void AsyncConnection::OnReply(const Reply& reply)
+	{
+		if (true == subscribe_mode_ && true == OnMessage(reply))
+		{
+			return;
+		}
+
+		if (true == requests_.empty())
+		{
+			LOG(GAMNET_WRN, "[Redis] receive reply without request(host:", connInfo_.host, ", port:", connInfo_.port, ")");
+			return;
+		}
+
+		Request request = requests_.front();
+		requests_.pop_front();
+
+		std::shared_ptr<ResultSetImpl> impl(new ResultSetImpl());
+		reply.ToResultSet(impl);
+		RESULT_HANDLER handler = request.handler;
+		request.strand.post([handler, impl]() {
+			ResultSet res;
+			res.impl_ = impl;
+			try {
+				handler(res);
+			}
+			catch (const Exception& e)
+			{
+				LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+			}
+		});
+	}
+
+	bool AsyncConnection::OnMessage(const Reply& reply)
+	{
+		if (Reply::TYPE_ARRAY != reply.type || 0 == reply.elements.size())
+		{
+			return false;
+		}
+
+		const std::string& kind = reply.elements[0].str;
+		if ("message" == kind && 3 == reply.elements.size())
+		{
+			auto itr = mapMessageHandler_.find(reply.elements[1].str);
+			if (mapMessageHandler_.end() == itr)
+			{
+				return true;
+			}
+			MESSAGE_HANDLER handler = itr->second.handler;
+			const std::string channel = reply.elements[1].str;
+			const std::string message = reply.elements[2].str;
+			itr->second.strand.post([handler, channel, message]() {
+				try {
+					handler(channel, message);
+				}
+				catch (const Exception& e)
+				{
+					LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+				}
+			});
+			return true;
+		}
+
+		if ("pmessage" == kind && 4 == reply.elements.size())
+		{
+			auto itr = mapPMessageHandler_.find(reply.elements[1].str);
+			if (mapPMessageHandler_.end() == itr)
+			{
+				return true;
+			}
+			PMESSAGE_HANDLER handler = itr->second.handler;
+			const std::string pattern = reply.elements[1].str;
+			const std::string channel = reply.elements[2].str;
+			const std::string message = reply.elements[3].str;
+			itr->second.strand.post([handler, pattern, channel, message]() {
+				try {
+					handler(pattern, channel, message);
+				}
+				catch (const Exception& e)
+				{
+					LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+				}
+			});
+			return true;
+		}
+
+		if ("subscribe" == kind || "unsubscribe" == kind || "psubscribe" == kind || "punsubscribe" == kind)
+		{
+			LOG(DEV, "[Redis] ", kind, "(name:", (1 < reply.elements.size() ? reply.elements[1].str : ""), ")");
+			return true;
+		}
+		return false;
+	}
+
+	// should be called in 'strand_'
+	void AsyncConnection::Close(const std::string& reason)
+	{
+		LOG(GAMNET_ERR, "[Redis] ", reason, "(host:", connInfo_.host, ", port:", connInfo_.port, ", pending:", requests_.size(), ")");
+
+		boost::system::error_code ignored_ec;
+		socket_.close(ignored_ec);
+		resolver_.cancel();
+		generation_++;
+		state_ = DISCONNECTED;
+		send_queue_.clear();
+		sending_.clear();
+		recv_buffer_.clear();
+
+		std::shared_ptr<ResultSetImpl> impl(new ResultSetImpl());
+		impl->error = "-ERR " + reason;
+		for (const Request& request : requests_)
+		{
+			RESULT_HANDLER handler = request.handler;
+			boost::asio::strand(request.strand).post([handler, impl]() {
+				ResultSet res;
+				res.impl_ = impl;
+				try {
+					handler(res);
+				}
+				catch (const Exception& e)
+				{
+					LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+				}
+			});
+		}
+		requests_.clear();
+
+		if (true == mapMessageHandler_.empty() && true == mapPMessageHandler_.empty())
+		{
+			return;
+		}
+
+		// subscriber should be alive to receive messages. retry after a second
+		auto self = shared_from_this();
+		reconnect_timer_.expires_from_now(boost::posix_time::seconds(1));
+		reconnect_timer_.async_wait(strand_.wrap([self](const boost::system::error_code& ec) {
+			if (ec || DISCONNECTED != self->state_)
+			{
+				return;
+			}
+			self->AsyncConnect();
+		}));
+	}
+
+	bool AsyncConnectionManager::Connect(int db_type, const Connection::ConnectionInfo& connInfo)
+	{
+		return Connect(db_type, std::vector<Connection::ConnectionInfo>(1, connInfo));
+	}
+
+	bool AsyncConnectionManager::Connect(int db_type, const std::vector<Connection::ConnectionInfo>& nodes)
+	{
+		if (true == nodes.empty())
+		{
+			LOG(GAMNET_ERR, "no connection info(db_type:", db_type, ")");
+			return false;
+		}
+		std::lock_guard<std::mutex> lo(lock_);
+		if (false == mapConnectionInfo_.insert(std::make_pair(db_type, nodes)).second)
+		{
+			LOG(GAMNET_ERR, "duplicate connection info(db_type:", db_type, ")");
+			return false;
+		}
+		return true;
+	}
+
+	std::shared_ptr<AsyncConnection> AsyncConnectionManager::Find(std::map<std::pair<int, size_t>, std::shared_ptr<AsyncConnection>>& connections, int db_type, size_t node)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		auto itr = connections.find(std::make_pair(db_type, node));
+		if (connections.end() != itr)
+		{
+			return itr->second;
+		}
+
+		auto info = mapConnectionInfo_.find(db_type);
+		if (mapConnectionInfo_.end() == info || info->second.size() <= node)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidKeyError, "can't find connection information for db(db_type:", db_type, ", node:", node, ")");
+		}
+
+		std::shared_ptr<AsyncConnection> conn = std::make_shared<AsyncConnection>(info->second[node]);
+		connections.insert(std::make_pair(std::make_pair(db_type, node), conn));
+		return conn;
+	}
+
+	std::shared_ptr<AsyncConnection> AsyncConnectionManager::GetConnection(int db_type, size_t node)
+	{
+		return Find(mapConnection_, db_type, node);
+	}
+
+	std::shared_ptr<AsyncConnection> AsyncConnectionManager::GetSubscriber(int db_type)
+	{
+		return Find(mapSubscriber_, db_type, 0);
+	}
+} } }
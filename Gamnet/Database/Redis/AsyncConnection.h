@@ -0,0 +1,116 @@
+#ifndef _GAMNET_DATABASE_REDIS_ASYNCCONNECTION_H_
+#define _GAMNET_DATABASE_REDIS_ASYNCCONNECTION_H_
+
+#include <boost/asio.hpp>
+#include <deque>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include "Connection.h"
+#include "Reply.h"
+
+namespace Gamnet { namespace Database {	namespace Redis {
+	/*!
+	 * \brief non-blocking redis connection
+	 *
+	 *		commands are pipelined on one socket and replies are matched in order.
+	 *		commands are sent as RESP arrays, so an argument may have spaces and CR/LF.
+	 *		result handlers are posted to the strand given by caller.
+	 *		once 'Subscribe' or 'PSubscribe' is called, the connection only serves pub/sub messages.
+	 */
+	class AsyncConnection : public std::enable_shared_from_this<AsyncConnection> {
+	public :
+		typedef std::function<void(const ResultSet& res)> RESULT_HANDLER;
+		typedef std::function<void(const std::string& channel, const std::string& message)> MESSAGE_HANDLER;
+		typedef std::function<void(const std::string& pattern, const std::string& channel, const std::string& message)> PMESSAGE_HANDLER;
+	private :
+		enum STATE {
+			DISCONNECTED,
+			CONNECTING,
+			CONNECTED
+		};
+
+		struct Request
+		{
+			boost::asio::strand strand;
+			RESULT_HANDLER handler;
+		};
+
+		struct MessageHandler
+		{
+			boost::asio::strand strand;
+			MESSAGE_HANDLER handler;
+		};
+
+		struct PMessageHandler
+		{
+			boost::asio::strand strand;
+			PMESSAGE_HANDLER handler;
+		};
+
+		Connection::ConnectionInfo connInfo_;
+		STATE state_;
+		bool subscribe_mode_;
+		// increased on every close. callbacks of the closed socket see different one and do nothing
+		uint32_t generation_;
+
+		boost::asio::ip::tcp::socket socket_;
+		boost::asio::ip::tcp::resolver resolver_;
+		boost::asio::strand strand_;
+		boost::asio::deadline_timer reconnect_timer_;
+
+		std::deque<Request> requests_;
+		std::string send_queue_;
+		std::string sending_;
+		std::string recv_buffer_;
+		char read_buffer_[8192];
+
+		std::map<std::string, MessageHandler> mapMessageHandler_;
+		std::map<std::string, PMessageHandler> mapPMessageHandler_;
+
+		void AsyncConnect();
+		void AsyncRead();
+		void FlushSend();
+		void Close(const std::string& reason);
+		void OnReply(const Reply& reply);
+		bool OnMessage(const Reply& reply);
+		void Send(const std::vector<std::string>& args);
+	public :
+		AsyncConnection(const Connection::ConnectionInfo& connInfo);
+		virtual ~AsyncConnection();
+
+		// splits 'query' like redis-cli. "..." may have spaces and \r \n \" \\ \xHH escapes, '...' is taken as it is
+		static std::vector<std::string> Split(const std::string& query);
+		// *<argc>\r\n $<len>\r\n<arg>\r\n ...
+		static std::string Encode(const std::vector<std::string>& args);
+
+		void Execute(const std::string& query, boost::asio::strand& strand, const RESULT_HANDLER& handler);
+		void Execute(const std::vector<std::string>& args, boost::asio::strand& strand, const RESULT_HANDLER& handler);
+		void Subscribe(const std::string& channel, boost::asio::strand& strand, const MESSAGE_HANDLER& handler);
+		void PSubscribe(const std::string& pattern, boost::asio::strand& strand, const PMESSAGE_HANDLER& handler);
+		void Unsubscribe(const std::string& channel);
+		void PUnsubscribe(const std::string& pattern);
+	};
+
+	/*!
+	 * \brief one command connection per node and one subscriber connection per db_type
+	 *
+	 *		connections are created on the first call and connected asynchronously.
+	 *		db_type of one node has node 0 only. subscriber of sharded db_type is on the first node.
+	 */
+	class AsyncConnectionManager {
+		std::mutex lock_;
+		std::map<int, std::vector<Connection::ConnectionInfo>> mapConnectionInfo_;
+		std::map<std::pair<int, size_t>, std::shared_ptr<AsyncConnection>> mapConnection_;
+		std::map<std::pair<int, size_t>, std::shared_ptr<AsyncConnection>> mapSubscriber_;
+
+		std::shared_ptr<AsyncConnection> Find(std::map<std::pair<int, size_t>, std::shared_ptr<AsyncConnection>>& connections, int db_type, size_t node);
+	public :
+		bool Connect(int db_type, const Connection::ConnectionInfo& connInfo);
+		bool Connect(int db_type, const std::vector<Connection::ConnectionInfo>& nodes);
+		std::shared_ptr<AsyncConnection> GetConnection(int db_type, size_t node = 0);
+		std::shared_ptr<AsyncConnection> GetSubscriber(int db_type);
+	};
+} } }
+#endif
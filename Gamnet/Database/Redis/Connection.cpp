@@ -17,6 +17,7 @@ namespace Gamnet { namespace Database {	namespace Redis {
 
 	bool Connection::Connect(const ConnectionInfo& connInfo)
 	{
+		connInfo_ = connInfo;
 		deadline_.expires_at(boost::posix_time::pos_infin);
 		deadline_.async_wait([this](boost::system::error_code) {
 			if (this->deadline_.expires_at() <= boost::asio::deadline_timer::traits_type::now())
@@ -49,10 +50,7 @@ namespace Gamnet { namespace Database {	namespace Redis {
 
 	std::shared_ptr<ResultSetImpl> Connection::Execute(const std::string& query)
 	{	
-		if (false == socket_.is_open())
-		{
-			throw GAMNET_EXCEPTION(ErrorCode::ConnectFailError);
-		}
+		Reconnect();
 	
 		socket_.write_some(boost::asio::buffer(query + "\r\n", query.length()+2));
 		
@@ -110,6 +108,56 @@ namespace Gamnet { namespace Database {	namespace Redis {
 		return impl;
 	}
 
+	void Connection::Reconnect()
+	{
+		if (true == socket_.is_open())
+		{
+			return;
+		}
+		if (true == connInfo_.host.empty() || false == Connect(connInfo_))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::ConnectFailError, "[Redis] reconnect fail(host:", connInfo_.host, ", port:", connInfo_.port, ")");
+		}
+	}
+
+	std::vector<Reply> Connection::Pipeline(const std::vector<std::string>& queries)
+	{
+		Reconnect();
+
+		std::string command;
+		for (const std::string& query : queries)
+		{
+			command += query + "\r\n";
+		}
+
+		std::vector<Reply> replies(queries.size());
+		try {
+			boost::asio::write(socket_, boost::asio::buffer(command));
+			std::string buffer;
+			size_t offset = 0;
+			char chunk[8192];
+			for (size_t i = 0; i < replies.size();)
+			{
+				size_t consumed = Reply::Parse(buffer.data() + offset, buffer.size() - offset, replies[i]);
+				if (0 == consumed)
+				{
+					buffer.append(chunk, socket_.read_some(boost::asio::buffer(chunk, sizeof(chunk))));
+					continue;
+				}
+				offset += consumed;
+				i++;
+			}
+		}
+		catch (const std::exception&)
+		{
+			// replies after the failed one may still come. they belong to no one
+			boost::system::error_code ignored_ec;
+			socket_.close(ignored_ec);
+			throw;
+		}
+		return replies;
+	}
+
 	void Connection::Parse(const std::shared_ptr<ResultSetImpl>& impl, std::list<std::string>::iterator& itr_token)
 	{
 		const std::string& token = *itr_token;
@@ -3,19 +3,25 @@
 
 #include <boost/asio.hpp>
 #include <list>
+#include <vector>
 #include "ResultSet.h"
+#include "Reply.h"
 
 namespace Gamnet { namespace Database {	namespace Redis {
 	class Connection {
-		boost::asio::ip::tcp::socket socket_;
-		void Parse(const std::shared_ptr<ResultSetImpl>& impl, std::list<std::string>::iterator& itr_token);
 	public:
 		struct ConnectionInfo
 		{
 			std::string host;
 			int port;
 		};
-
+	private:
+		boost::asio::ip::tcp::socket socket_;
+		ConnectionInfo connInfo_;
+		// socket closed by a failed command is connected again before the next one
+		void Reconnect();
+		void Parse(const std::shared_ptr<ResultSetImpl>& impl, std::list<std::string>::iterator& itr_token);
+	public:
 		boost::asio::deadline_timer deadline_;
 
 		Connection();
@@ -23,6 +29,9 @@ namespace Gamnet { namespace Database {	namespace Redis {
 
 		bool Connect(const ConnectionInfo& connInfo);
 		std::shared_ptr<ResultSetImpl> Execute(const std::string& query);
+		// send all queries at once and read replies in the same order.
+		// on failure the socket is closed, so replies left unread are never taken by the next user of this connection
+		std::vector<Reply> Pipeline(const std::vector<std::string>& queries);
 	};
 } } }
 #endif
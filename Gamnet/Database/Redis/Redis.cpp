@@ -1,5 +1,6 @@
 #include "Redis.h"
 #include "../ConnectionPool.h"
+#include "../Statistics.h"
 #include "../../Library/Singleton.h"
 #include "../../Library/Exception.h"
 #include <boost/property_tree/ptree.hpp>
@@ -21,6 +22,26 @@ namespace Gamnet { namespace Database { namespace Redis {
 				continue;
 			}
 			int id = elmt.second.get<int>("<xmlattr>.id");
+			if (0 < elmt.second.count("node"))
+			{
+				std::vector<Connection::ConnectionInfo> nodes;
+				for (auto node : elmt.second)
+				{
+					if ("node" != node.first)
+					{
+						continue;
+					}
+					Connection::ConnectionInfo connInfo;
+					connInfo.host = node.second.get<std::string>("<xmlattr>.host");
+					connInfo.port = node.second.get<int>("<xmlattr>.port");
+					nodes.push_back(connInfo);
+				}
+				if (false == Connect(id, nodes))
+				{
+					throw GAMNET_EXCEPTION(ErrorCode::ConnectFailError, "database connect fail(id:", id, ", nodes:", nodes.size(), ")");
+				}
+				continue;
+			}
 			int port = elmt.second.get<int>("<xmlattr>.port");
 			const std::string host = elmt.second.get<std::string>("<xmlattr>.host");
 			if (false == Connect(id, host.c_str(), port))
@@ -35,15 +56,109 @@ namespace Gamnet { namespace Database { namespace Redis {
 		Connection::ConnectionInfo connInfo;
 		connInfo.host = host;
 		connInfo.port = port;
-		return Singleton<ConnectionPool<Connection>>::GetInstance().Connect(db_type, connInfo);
+		if (false == Singleton<ConnectionPool<Connection>>::GetInstance().Connect(db_type, connInfo))
+		{
+			return false;
+		}
+		return Singleton<AsyncConnectionManager>::GetInstance().Connect(db_type, connInfo);
+	}
+
+	bool Connect(int db_type, const std::vector<Connection::ConnectionInfo>& nodes)
+	{
+		if (false == Singleton<ShardManager>::GetInstance().Connect(db_type, nodes))
+		{
+			return false;
+		}
+		return Singleton<AsyncConnectionManager>::GetInstance().Connect(db_type, nodes);
 	}
 
 	ResultSet Execute(int db_type, const std::string& query)
 	{
-		std::shared_ptr<Connection> conn = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
+		Statistics::Sample sample("Redis", db_type, query);
 		ResultSet res;
-		res.impl_ = conn->Execute(query);
-		res.impl_->conn_ = conn;
+		std::shared_ptr<Shard> shard = Singleton<ShardManager>::GetInstance().Find(db_type);
+		if (nullptr != shard)
+		{
+			res = shard->Execute(query);
+		}
+		else
+		{
+			std::shared_ptr<Connection> conn = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
+			sample.Acquire();
+			res.impl_ = conn->Execute(query);
+			res.impl_->conn_ = conn;
+		}
+		sample.Finish(res->size(), false == res.error().empty());
 		return res;
 	}
+
+	std::vector<ResultSet> Pipeline(int db_type, const std::vector<std::string>& queries)
+	{
+		const std::string query = Format("PIPELINE(", queries.size(), ") ", (true == queries.empty() ? "" : queries.front()));
+		Statistics::Sample sample("Redis", db_type, query);
+		std::vector<ResultSet> results;
+		std::shared_ptr<Shard> shard = Singleton<ShardManager>::GetInstance().Find(db_type);
+		if (nullptr != shard)
+		{
+			results = shard->Pipeline(queries);
+		}
+		else
+		{
+			std::shared_ptr<Connection> conn = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
+			sample.Acquire();
+			const std::vector<Reply> replies = conn->Pipeline(queries);
+			results.resize(replies.size());
+			for (size_t i = 0; i < replies.size(); i++)
+			{
+				replies[i].ToResultSet(results[i].impl_);
+				results[i].impl_->conn_ = conn;
+			}
+		}
+
+		size_t rows = 0;
+		bool error = false;
+		for (ResultSet& res : results)
+		{
+			rows += res->size();
+			error = error || false == res.error().empty();
+		}
+		sample.Finish(rows, error);
+		return results;
+	}
+
+	void AsyncExecute(int db_type, boost::asio::strand& strand, const AsyncConnection::RESULT_HANDLER& handler, const std::string& query)
+	{
+		AsyncExecute(db_type, strand, handler, AsyncConnection::Split(query));
+	}
+
+	void AsyncExecute(int db_type, boost::asio::strand& strand, const AsyncConnection::RESULT_HANDLER& handler, const std::vector<std::string>& args)
+	{
+		size_t node = 0;
+		std::shared_ptr<Shard> shard = Singleton<ShardManager>::GetInstance().Find(db_type);
+		if (nullptr != shard)
+		{
+			node = shard->GetNode(args);
+		}
+		Singleton<AsyncConnectionManager>::GetInstance().GetConnection(db_type, node)->Execute(args, strand, handler);
+	}
+
+	void Subscribe(int db_type, const std::string& channel, boost::asio::strand& strand, const AsyncConnection::MESSAGE_HANDLER& handler)
+	{
+		Singleton<AsyncConnectionManager>::GetInstance().GetSubscriber(db_type)->Subscribe(channel, strand, handler);
+	}
+
+	void PSubscribe(int db_type, const std::string& pattern, boost::asio::strand& strand, const AsyncConnection::PMESSAGE_HANDLER& handler)
+	{
+		Singleton<AsyncConnectionManager>::GetInstance().GetSubscriber(db_type)->PSubscribe(pattern, strand, handler);
+	}
+
+	void Unsubscribe(int db_type, const std::string& channel)
+	{
+		Singleton<AsyncConnectionManager>::GetInstance().GetSubscriber(db_type)->Unsubscribe(channel);
+	}
+
+	void PUnsubscribe(int db_type, const std::string& pattern)
+	{
+		Singleton<AsyncConnectionManager>::GetInstance().GetSubscriber(db_type)->PUnsubscribe(pattern);
+	}
 } } }
@@ -3,16 +3,39 @@
 
 #include "Connection.h"
 #include "Transaction.h"
+#include "AsyncConnection.h"
+#include "Shard.h"
 
 namespace Gamnet { namespace Database { namespace Redis {
 		void ReadXml(const char* xml_path);
 		bool Connect(int db_type, const char* host, int port);
+		// keys are distributed to 'nodes' by consistent hashing
+		bool Connect(int db_type, const std::vector<Connection::ConnectionInfo>& nodes);
 		ResultSet Execute(int db_type, const std::string& query);
 		template <class... ARGS>
 		ResultSet Execute(int db_type, ARGS... args)
 		{
 			return Execute(db_type, Format(args...));
 		}
+		// send all queries in one round trip per node. results are in the same order as 'queries'
+		std::vector<ResultSet> Pipeline(int db_type, const std::vector<std::string>& queries);
+
+		// non-blocking version. 'handler' will be called in 'strand'.
+		// sharded db_type sends it to the node of its key, and keys of multi-key command should be on one node
+		void AsyncExecute(int db_type, boost::asio::strand& strand, const AsyncConnection::RESULT_HANDLER& handler, const std::string& query);
+		// each element is one argument as it is. use this for values that may have spaces, quotes or CR/LF
+		void AsyncExecute(int db_type, boost::asio::strand& strand, const AsyncConnection::RESULT_HANDLER& handler, const std::vector<std::string>& args);
+		template <class... ARGS>
+		void AsyncExecute(int db_type, boost::asio::strand& strand, const AsyncConnection::RESULT_HANDLER& handler, ARGS... args)
+		{
+			AsyncExecute(db_type, strand, handler, Format(args...));
+		}
+
+		// pub/sub runs on a dedicated connection per db_type, on the first node of sharded one
+		void Subscribe(int db_type, const std::string& channel, boost::asio::strand& strand, const AsyncConnection::MESSAGE_HANDLER& handler);
+		void PSubscribe(int db_type, const std::string& pattern, boost::asio::strand& strand, const AsyncConnection::PMESSAGE_HANDLER& handler);
+		void Unsubscribe(int db_type, const std::string& channel);
+		void PUnsubscribe(int db_type, const std::string& pattern);
 }}}
 
 #endif /* DATABASE_H_ */
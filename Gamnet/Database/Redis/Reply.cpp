@@ -0,0 +1,103 @@
+#include "Reply.h"
+#include "../../Library/Exception.h"
+
+namespace Gamnet { namespace Database {	namespace Redis {
+
+	void Reply::ToResultSet(const std::shared_ptr<ResultSetImpl>& impl) const
+	{
+		switch (type)
+		{
+		case TYPE_STATUS:
+		case TYPE_INTEGER:
+		case TYPE_STRING:
+			impl->push_back(str);
+			break;
+		case TYPE_ERROR:
+			impl->error = "-" + str;
+			break;
+		case TYPE_ARRAY:
+			for (const Reply& element : elements)
+			{
+				element.ToResultSet(impl);
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	size_t Reply::Parse(const char* data, size_t size, Reply& reply)
+	{
+		const char* crlf = nullptr;
+		for (size_t i = 1; i < size; i++)
+		{
+			if ('\r' == data[i - 1] && '\n' == data[i])
+			{
+				crlf = data + i - 1;
+				break;
+			}
+		}
+		if (nullptr == crlf)
+		{
+			return 0;
+		}
+
+		const std::string line(data + 1, crlf);
+		size_t consumed = (crlf - data) + 2;
+		switch (data[0])
+		{
+		case '+':
+			reply.type = Reply::TYPE_STATUS;
+			reply.str = line;
+			return consumed;
+		case '-':
+			reply.type = Reply::TYPE_ERROR;
+			reply.str = line;
+			return consumed;
+		case ':':
+			reply.type = Reply::TYPE_INTEGER;
+			reply.str = line;
+			return consumed;
+		case '$':
+			{
+				long length = atol(line.c_str());
+				if (0 > length)
+				{
+					reply.type = Reply::TYPE_NIL;
+					return consumed;
+				}
+				if (size < consumed + length + 2)
+				{
+					return 0;
+				}
+				reply.type = Reply::TYPE_STRING;
+				reply.str.assign(data + consumed, length);
+				return consumed + length + 2;
+			}
+		case '*':
+			{
+				long count = atol(line.c_str());
+				if (0 > count)
+				{
+					reply.type = Reply::TYPE_NIL;
+					return consumed;
+				}
+				reply.type = Reply::TYPE_ARRAY;
+				reply.elements.resize(count);
+				for (long i = 0; i < count; i++)
+				{
+					size_t elementSize = Parse(data + consumed, size - consumed, reply.elements[i]);
+					if (0 == elementSize)
+					{
+						return 0;
+					}
+					consumed += elementSize;
+				}
+				return consumed;
+			}
+		default:
+			break;
+		}
+		throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "[Redis] invalid reply(", line, ")");
+	}
+} } }
@@ -0,0 +1,35 @@
+#ifndef _GAMNET_DATABASE_REDIS_REPLY_H_
+#define _GAMNET_DATABASE_REDIS_REPLY_H_
+
+#include <string>
+#include <vector>
+#include "ResultSet.h"
+
+namespace Gamnet { namespace Database {	namespace Redis {
+	/*!
+	 * \brief RESP reply tree
+	 */
+	struct Reply
+	{
+		enum TYPE {
+			TYPE_STATUS,
+			TYPE_ERROR,
+			TYPE_INTEGER,
+			TYPE_STRING,
+			TYPE_ARRAY,
+			TYPE_NIL
+		};
+		TYPE type;
+		std::string str;
+		std::vector<Reply> elements;
+
+		Reply() : type(TYPE_NIL) {}
+
+		// flatten reply into 'impl'. error reply is stored in 'impl->error'
+		void ToResultSet(const std::shared_ptr<ResultSetImpl>& impl) const;
+
+		// return consumed bytes, or 0 if 'data' does not contain a complete reply yet
+		static size_t Parse(const char* data, size_t size, Reply& reply);
+	};
+} } }
+#endif
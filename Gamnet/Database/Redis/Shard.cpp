@@ -0,0 +1,453 @@
+#include "Shard.h"
+#include "../../Library/Exception.h"
+#include "../../Log/Log.h"
+#include <cctype>
+#include <algorithm>
+#include <future>
+
+namespace Gamnet { namespace Database {	namespace Redis {
+
+	struct Shard::Command
+	{
+		enum MERGE {
+			MERGE_NONE,		// single part. reply is returned as it is
+			MERGE_ARRAY,	// MGET. elements are placed back to original key position
+			MERGE_SUM,		// DEL, UNLINK, EXISTS, TOUCH. integer replies are summed
+			MERGE_STATUS	// MSET. 'OK' if all parts succeed
+		};
+
+		struct Part
+		{
+			size_t node;
+			std::string query;
+			std::vector<size_t> positions;
+		};
+
+		MERGE merge;
+		size_t key_count;
+		std::vector<Part> parts;
+	};
+
+	struct Token
+	{
+		std::string raw;
+		std::string value;
+	};
+
+	// split inline command. quoted argument keeps its quotes in 'raw' for rebuilding sub command
+	static std::vector<Token> Tokenize(const std::string& query)
+	{
+		std::vector<Token> tokens;
+		size_t i = 0;
+		while (i < query.size())
+		{
+			if (0 != std::isspace((unsigned char)query[i]))
+			{
+				i++;
+				continue;
+			}
+
+			Token token;
+			size_t begin = i;
+			if ('"' == query[i] || '\'' == query[i])
+			{
+				const char quote = query[i++];
+				while (i < query.size() && quote != query[i])
+				{
+					if ('\\' == query[i] && i + 1 < query.size())
+					{
+						i++;
+					}
+					token.value += query[i++];
+				}
+				i++;
+			}
+			else
+			{
+				while (i < query.size() && 0 == std::isspace((unsigned char)query[i]))
+				{
+					token.value += query[i++];
+				}
+			}
+			token.raw = query.substr(begin, i - begin);
+			tokens.push_back(token);
+		}
+		return tokens;
+	}
+
+	uint32_t ShardRing::Hash(const std::string& key)
+	{
+		// FNV-1a followed by murmur3 finalizer for better avalanche on short keys
+		uint32_t hash = 2166136261u;
+		for (unsigned char c : key)
+		{
+			hash ^= c;
+			hash *= 16777619u;
+		}
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bu;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	std::string ShardRing::HashTag(const std::string& key)
+	{
+		size_t begin = key.find('{');
+		if (std::string::npos == begin)
+		{
+			return key;
+		}
+		size_t end = key.find('}', begin + 1);
+		if (std::string::npos == end || begin + 1 == end)
+		{
+			return key;
+		}
+		return key.substr(begin + 1, end - begin - 1);
+	}
+
+	void ShardRing::AddNode(size_t node, const std::string& name)
+	{
+		for (int i = 0; i < VIRTUAL_NODE_COUNT; i++)
+		{
+			ring_[Hash(name + "-" + std::to_string(i))] = node;
+		}
+	}
+
+	size_t ShardRing::GetNode(const std::string& key) const
+	{
+		if (true == ring_.empty())
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::NotInitializedError, "[Redis] empty shard ring");
+		}
+		auto itr = ring_.lower_bound(Hash(HashTag(key)));
+		if (ring_.end() == itr)
+		{
+			itr = ring_.begin();
+		}
+		return itr->second;
+	}
+
+	bool Shard::Connect(const std::vector<Connection::ConnectionInfo>& nodes)
+	{
+		if (true == nodes.empty())
+		{
+			LOG(GAMNET_ERR, "[Redis] no shard node");
+			return false;
+		}
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			if (false == connectionPool_.Connect((int)i, nodes[i]))
+			{
+				LOG(GAMNET_ERR, "[Redis] shard node connect fail(host:", nodes[i].host, ", port:", nodes[i].port, ")");
+				return false;
+			}
+			ring_.AddNode(i, Format(nodes[i].host, ":", nodes[i].port));
+		}
+		nodes_ = nodes;
+		if (1 < nodes.size())
+		{
+			// the calling thread takes one node by itself
+			threadPool_ = std::make_shared<ThreadPool>((int)std::min(nodes.size() - 1, (size_t)SCATTER_THREAD_COUNT));
+		}
+		return true;
+	}
+
+	size_t Shard::GetNode(const std::string& key) const
+	{
+		return ring_.GetNode(key);
+	}
+
+	size_t Shard::GetNode(const std::vector<std::string>& args) const
+	{
+		if (true == args.empty())
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "[Redis] empty command");
+		}
+
+		std::string name = args[0];
+		std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+		if ("PUBLISH" == name)
+		{
+			return 0;
+		}
+
+		// keys are args[first], args[first + step], ... before args[last]
+		size_t first = 1;
+		size_t step = 0;
+		size_t last = args.size();
+		if ("MGET" == name || "DEL" == name || "UNLINK" == name || "EXISTS" == name || "TOUCH" == name)
+		{
+			step = 1;
+		}
+		else if ("MSET" == name)
+		{
+			step = 2;
+		}
+		else if ("EVAL" == name || "EVALSHA" == name)
+		{
+			// EVAL script numkeys key [key ...]
+			first = 3;
+			step = 1;
+			last = std::min(args.size(), first + (size_t)std::max(0, 2 < args.size() ? atoi(args[2].c_str()) : 0));
+		}
+
+		if (0 == step)
+		{
+			return first < args.size() ? ring_.GetNode(args[first]) : 0;
+		}
+		size_t node = 0;
+		for (size_t i = first; i < last; i += step)
+		{
+			const size_t key_node = ring_.GetNode(args[i]);
+			if (first != i && node != key_node)
+			{
+				throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "[Redis] keys of async command are on different nodes. keep them in one hash tag(command:", name, ")");
+			}
+			node = key_node;
+		}
+		return node;
+	}
+
+	std::shared_ptr<Connection> Shard::GetConnection(size_t node)
+	{
+		return connectionPool_.GetConnection((int)node);
+	}
+
+	void Shard::Plan(const std::string& query, Command& command) const
+	{
+		const std::vector<Token> tokens = Tokenize(query);
+		if (true == tokens.empty())
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "[Redis] empty query");
+		}
+
+		std::string name = tokens[0].value;
+		std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+		command.merge = Command::MERGE_NONE;
+		command.key_count = 0;
+		command.parts.clear();
+
+		size_t step = 0;
+		if ("MGET" == name)
+		{
+			command.merge = Command::MERGE_ARRAY;
+			step = 1;
+		}
+		else if ("DEL" == name || "UNLINK" == name || "EXISTS" == name || "TOUCH" == name)
+		{
+			command.merge = Command::MERGE_SUM;
+			step = 1;
+		}
+		else if ("MSET" == name)
+		{
+			command.merge = Command::MERGE_STATUS;
+			step = 2;
+		}
+
+		if (0 == step)
+		{
+			// EVAL script numkeys key [key ...]
+			size_t key = 1;
+			if ("EVAL" == name || "EVALSHA" == name)
+			{
+				key = (3 < tokens.size() && 0 < atoi(tokens[2].value.c_str())) ? 3 : tokens.size();
+			}
+			Command::Part part;
+			part.node = key < tokens.size() ? GetNode(tokens[key].value) : 0;
+			part.query = query;
+			command.parts.push_back(part);
+			return;
+		}
+
+		std::map<size_t, size_t> mapPart; // node -> index of 'command.parts'
+		for (size_t i = 1; i + step - 1 < tokens.size(); i += step)
+		{
+			const size_t node = GetNode(tokens[i].value);
+			auto itr = mapPart.find(node);
+			if (mapPart.end() == itr)
+			{
+				Command::Part part;
+				part.node = node;
+				part.query = tokens[0].raw;
+				command.parts.push_back(part);
+				itr = mapPart.insert(std::make_pair(node, command.parts.size() - 1)).first;
+			}
+			Command::Part& part = command.parts[itr->second];
+			for (size_t j = 0; j < step; j++)
+			{
+				part.query += " " + tokens[i + j].raw;
+			}
+			part.positions.push_back(command.key_count++);
+		}
+
+		if (true == command.parts.empty())
+		{
+			Command::Part part;
+			part.node = 0;
+			part.query = query;
+			command.parts.push_back(part);
+			command.merge = Command::MERGE_NONE;
+		}
+	}
+
+	Reply Shard::Merge(const Command& command, const std::vector<Reply>& replies) const
+	{
+		for (const Reply& reply : replies)
+		{
+			if (Reply::TYPE_ERROR == reply.type)
+			{
+				return reply;
+			}
+		}
+
+		if (Command::MERGE_NONE == command.merge || 1 == replies.size())
+		{
+			return replies[0];
+		}
+
+		Reply merged;
+		switch (command.merge)
+		{
+		case Command::MERGE_ARRAY:
+			merged.type = Reply::TYPE_ARRAY;
+			merged.elements.resize(command.key_count);
+			for (size_t i = 0; i < replies.size(); i++)
+			{
+				const std::vector<size_t>& positions = command.parts[i].positions;
+				for (size_t j = 0; j < positions.size() && j < replies[i].elements.size(); j++)
+				{
+					merged.elements[positions[j]] = replies[i].elements[j];
+				}
+			}
+			break;
+		case Command::MERGE_SUM:
+			{
+				long long sum = 0;
+				for (const Reply& reply : replies)
+				{
+					sum += atoll(reply.str.c_str());
+				}
+				merged.type = Reply::TYPE_INTEGER;
+				merged.str = std::to_string(sum);
+			}
+			break;
+		case Command::MERGE_STATUS:
+			merged.type = Reply::TYPE_STATUS;
+			merged.str = "OK";
+			break;
+		default:
+			break;
+		}
+		return merged;
+	}
+
+	std::vector<Reply> Shard::RoundTrip(size_t node, const std::vector<std::string>& queries)
+	{
+		try {
+			return GetConnection(node)->Pipeline(queries);
+		}
+		catch (const std::exception& e)
+		{
+			// connection closed its socket, so it goes back to the pool without replies of this round trip
+			LOG(GAMNET_ERR, "[Redis] shard node fail(host:", nodes_[node].host, ", port:", nodes_[node].port, ", reason:", e.what(), ")");
+		}
+		return std::vector<Reply>();
+	}
+
+	ResultSet Shard::Execute(const std::string& query)
+	{
+		return Pipeline(std::vector<std::string>(1, query))[0];
+	}
+
+	std::vector<ResultSet> Shard::Pipeline(const std::vector<std::string>& queries)
+	{
+		std::vector<Command> commands(queries.size());
+		std::map<size_t, std::vector<std::string>> mapNodeQueries;
+		for (size_t i = 0; i < queries.size(); i++)
+		{
+			Plan(queries[i], commands[i]);
+			for (const Command::Part& part : commands[i].parts)
+			{
+				mapNodeQueries[part.node].push_back(part.query);
+			}
+		}
+
+		// one round trip per node, all nodes at once. replies are consumed in the order they were queued
+		std::map<size_t, std::vector<Reply>> mapNodeReplies;
+		std::vector<std::pair<size_t, std::future<std::vector<Reply>>>> futures;
+		for (auto itr = mapNodeQueries.begin(); mapNodeQueries.end() != itr && nullptr != threadPool_; itr++)
+		{
+			if (mapNodeQueries.begin() == itr)
+			{
+				continue;
+			}
+			std::shared_ptr<std::promise<std::vector<Reply>>> promise = std::make_shared<std::promise<std::vector<Reply>>>();
+			futures.push_back(std::make_pair(itr->first, promise->get_future()));
+			const size_t node = itr->first;
+			const std::vector<std::string>* nodeQueries = &itr->second; // alive until the future is taken below
+			threadPool_->PostTask([this, promise, node, nodeQueries]() {
+				promise->set_value(RoundTrip(node, *nodeQueries));
+			});
+		}
+		if (false == mapNodeQueries.empty())
+		{
+			mapNodeReplies[mapNodeQueries.begin()->first] = RoundTrip(mapNodeQueries.begin()->first, mapNodeQueries.begin()->second);
+		}
+		for (auto& future : futures)
+		{
+			mapNodeReplies[future.first] = future.second.get();
+		}
+
+		std::map<size_t, size_t> mapNodeOffset;
+		std::vector<ResultSet> results(queries.size());
+		for (size_t i = 0; i < commands.size(); i++)
+		{
+			std::vector<Reply> replies;
+			for (const Command::Part& part : commands[i].parts)
+			{
+				const std::vector<Reply>& nodeReplies = mapNodeReplies[part.node];
+				const size_t offset = mapNodeOffset[part.node]++;
+				if (nodeReplies.size() <= offset)
+				{
+					Reply error;
+					error.type = Reply::TYPE_ERROR;
+					error.str = Format("ERR no reply from shard node(host:", nodes_[part.node].host, ", port:", nodes_[part.node].port, ")");
+					replies.push_back(error);
+					continue;
+				}
+				replies.push_back(nodeReplies[offset]);
+			}
+			Merge(commands[i], replies).ToResultSet(results[i].impl_);
+		}
+		return results;
+	}
+
+	bool ShardManager::Connect(int db_type, const std::vector<Connection::ConnectionInfo>& nodes)
+	{
+		if (mapShard_.end() != mapShard_.find(db_type))
+		{
+			LOG(GAMNET_ERR, "duplicate connection info(db_type:", db_type, ")");
+			return false;
+		}
+		std::shared_ptr<Shard> shard = std::make_shared<Shard>();
+		if (false == shard->Connect(nodes))
+		{
+			return false;
+		}
+		mapShard_.insert(std::make_pair(db_type, shard));
+		return true;
+	}
+
+	std::shared_ptr<Shard> ShardManager::Find(int db_type) const
+	{
+		auto itr = mapShard_.find(db_type);
+		if (mapShard_.end() == itr)
+		{
+			return nullptr;
+		}
+		return itr->second;
+	}
+} } }
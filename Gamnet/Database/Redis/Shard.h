@@ -0,0 +1,76 @@
+#ifndef _GAMNET_DATABASE_REDIS_SHARD_H_
+#define _GAMNET_DATABASE_REDIS_SHARD_H_
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Connection.h"
+#include "../ConnectionPool.h"
+#include "../../Library/ThreadPool.h"
+
+namespace Gamnet { namespace Database {	namespace Redis {
+	/*!
+	 * \brief consistent hash ring of redis nodes
+	 *
+	 *		each node is placed on the ring 'VIRTUAL_NODE_COUNT' times, so adding a node moves about 1/N of keys.
+	 *		if a key contains '{...}', only the substring inside the braces is hashed like redis cluster hash tag.
+	 */
+	class ShardRing {
+		std::map<uint32_t, size_t> ring_;
+	public :
+		enum {
+			VIRTUAL_NODE_COUNT = 160
+		};
+
+		void AddNode(size_t node, const std::string& name);
+		size_t GetNode(const std::string& key) const;
+
+		static uint32_t Hash(const std::string& key);
+		static std::string HashTag(const std::string& key);
+	};
+
+	/*!
+	 * \brief one sharded db_type
+	 *
+	 *		single key commands go to the node owning the key. MGET, MSET, DEL, UNLINK, EXISTS and TOUCH are split per node
+	 *		and merged back in key order. commands without key are sent to the first node.
+	 *		MULTI/EXEC and keys of other multi-key commands are not checked, so keep them in one hash tag.
+	 *		round trips to different nodes run in parallel. a node that fails gives error reply to its part only.
+	 */
+	class Shard {
+		struct Command;
+
+		ShardRing ring_;
+		std::vector<Connection::ConnectionInfo> nodes_;
+		ConnectionPool<Connection> connectionPool_;
+		std::shared_ptr<ThreadPool> threadPool_;
+
+		void Plan(const std::string& query, Command& command) const;
+		// empty if the node fails
+		std::vector<Reply> RoundTrip(size_t node, const std::vector<std::string>& queries);
+		Reply Merge(const Command& command, const std::vector<Reply>& replies) const;
+	public :
+		enum {
+			SCATTER_THREAD_COUNT = 8
+		};
+
+		bool Connect(const std::vector<Connection::ConnectionInfo>& nodes);
+		size_t GetNode(const std::string& key) const;
+		// node of async command. it is not split, so keys of multi-key command should be on one node. PUBLISH goes to the first node with the subscribers
+		size_t GetNode(const std::vector<std::string>& args) const;
+		std::shared_ptr<Connection> GetConnection(size_t node);
+
+		ResultSet Execute(const std::string& query);
+		std::vector<ResultSet> Pipeline(const std::vector<std::string>& queries);
+	};
+
+	class ShardManager {
+		std::map<int, std::shared_ptr<Shard>> mapShard_;
+	public :
+		bool Connect(int db_type, const std::vector<Connection::ConnectionInfo>& nodes);
+		// return nullptr if 'db_type' is not sharded
+		std::shared_ptr<Shard> Find(int db_type) const;
+	};
+} } }
+#endif
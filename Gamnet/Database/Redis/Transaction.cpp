@@ -5,7 +5,7 @@
 
 namespace Gamnet { namespace Database { namespace Redis {
 
-Transaction::Transaction(int db_type) : commit(false)
+Transaction::Transaction(int db_type) : commit(false), db_type(db_type)
 {
 	connection = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
 	ResultSet res;
@@ -2,6 +2,7 @@
 #define GAMNET_DATABASE_REDIS_TRANSACTION_H_
 
 #include "Connection.h"
+#include "../Statistics.h"
 #include "../../Library/String.h"
 
 namespace Gamnet {
@@ -9,6 +10,7 @@ namespace Gamnet {
 		namespace Redis {
 			class Transaction {
 				bool commit;
+				int db_type;
 				std::shared_ptr<Connection> connection;
 			public:
 				Transaction(int db_type);
@@ -18,9 +20,11 @@ namespace Gamnet {
 				ResultSet Execute(ARGS... args)
 				{
 					const std::string query = Format(args...);
+					Statistics::Sample sample("Redis", db_type, query);
 					ResultSet res;
 					res.impl_ = connection->Execute(query);
 					res.impl_->conn_ = connection;
+					sample.Finish(res->size(), false == res.error().empty());
 					return res;
 				}
 				ResultSet Commit();
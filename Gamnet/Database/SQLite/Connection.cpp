@@ -54,7 +54,8 @@ namespace Gamnet { namespace Database { namespace SQLite {
 			}
 		}
 
-		std::vector<std::string> vecRow(columnCount);
+		resultSetImpl->vecRows_.emplace_back(columnCount);
+		std::vector<std::string>& vecRow = resultSetImpl->vecRows_.back();
 		for (int i = 0; i<columnCount; i++)
 		{
 			if (nullptr != rowDatas[i])
@@ -62,21 +63,33 @@ namespace Gamnet { namespace Database { namespace SQLite {
 				vecRow[i] = rowDatas[i];
 			}
 		}
-		resultSetImpl->vecRows_.push_back(vecRow);
 		resultSetImpl->rowCount_ = resultSetImpl->vecRows_.size();
 		return 0;
 	}
 
-	Connection::ConnectionInfo::ConnectionInfo() : db_(""), timeout_(100)
+	Connection::ConnectionInfo::ConnectionInfo() : db_(""), timeout_(100), wal_(false)
 	{
 	}
 
+	Connection::PreparedStatement::PreparedStatement() : stmt_(nullptr), busy_(false)
+	{
+	}
+
+	Connection::PreparedStatement::~PreparedStatement()
+	{
+		if (nullptr != stmt_)
+		{
+			sqlite3_finalize(stmt_);
+		}
+	}
+
 	Connection::Connection() : conn_(nullptr)
 	{
 	}
 
 	Connection::~Connection()
 	{
+		mapPreparedStatement_.clear();
 		if(nullptr != conn_)
 		{
 			sqlite3_close(conn_);
@@ -85,9 +98,28 @@ namespace Gamnet { namespace Database { namespace SQLite {
 
 	bool Connection::Connect(const ConnectionInfo& connInfo)
 	{
+		connInfo_ = connInfo;
+		if (true == connInfo_.wal_)
+		{
+			// private cache per connection. readers and a writer run concurrently on WAL instead of waiting for shared cache lock
+			if (SQLITE_OK != sqlite3_open_v2(connInfo_.db_.c_str(), &conn_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_PRIVATECACHE, nullptr))
+			{
+				LOG(GAMNET_ERR, "[SQLite] open db fail(file_name:", connInfo_.db_, ")");
+				return false;
+			}
+			sqlite3_busy_timeout(conn_, connInfo_.timeout_);
+			char* errorMessage = nullptr;
+			if (SQLITE_OK != sqlite3_exec(conn_, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", nullptr, nullptr, &errorMessage))
+			{
+				LOG(GAMNET_ERR, "[SQLite] set WAL mode fail(file_name:", connInfo_.db_, ", error_message:", (nullptr != errorMessage ? errorMessage : ""), ")");
+				sqlite3_free(errorMessage);
+				return false;
+			}
+			return true;
+		}
+
 		sqlite3_enable_shared_cache(1);
 		
-		connInfo_ = connInfo;
 		if(SQLITE_OK != sqlite3_open(connInfo_.db_.c_str(), &conn_))
 		{
 			LOG(GAMNET_ERR, "[SQLite] open db fail(file_name:", connInfo_.db_, ")");
@@ -97,6 +129,41 @@ namespace Gamnet { namespace Database { namespace SQLite {
 		return true;
 	}
 
+	std::shared_ptr<Connection::PreparedStatement> Connection::Prepare(const std::string& query)
+	{
+		auto itr = mapPreparedStatement_.find(query);
+		if (mapPreparedStatement_.end() != itr && false == itr->second->busy_)
+		{
+			itr->second->busy_ = true;
+			return itr->second;
+		}
+
+		std::shared_ptr<PreparedStatement> stmt = std::make_shared<PreparedStatement>();
+		int errorCode = sqlite3_prepare_v3(conn_, query.c_str(), (int)query.length(), SQLITE_PREPARE_PERSISTENT, &stmt->stmt_, nullptr);
+		while (SQLITE_LOCKED == errorCode && SQLITE_OK == WaitForUnlockNotify(this))
+		{
+			errorCode = sqlite3_prepare_v3(conn_, query.c_str(), (int)query.length(), SQLITE_PREPARE_PERSISTENT, &stmt->stmt_, nullptr);
+		}
+		if (SQLITE_OK != errorCode)
+		{
+			LOG(GAMNET_ERR, "error_code:", errorCode, ", error_message:", sqlite3_errmsg(conn_), ", query:", query);
+			throw GAMNET_EXCEPTION(ErrorCode::UndefinedError, sqlite3_errmsg(conn_));
+		}
+
+		const int columnCount = sqlite3_column_count(stmt->stmt_);
+		for (int i = 0; i < columnCount; i++)
+		{
+			stmt->mapColumnName_.insert(std::make_pair(sqlite3_column_name(stmt->stmt_, i), i));
+		}
+		stmt->busy_ = true;
+
+		if (mapPreparedStatement_.end() == itr)
+		{
+			mapPreparedStatement_.insert(std::make_pair(query, stmt));
+		}
+		return stmt;
+	}
+
 	std::shared_ptr<ResultSetImpl> Connection::Execute(const std::string& query)
 	{
 		std::shared_ptr<ResultSetImpl> impl = std::make_shared<ResultSetImpl>();
@@ -4,6 +4,7 @@
 #include "sqlite3.h"
 #include "ResultSet.h"
 #include <string>
+#include <map>
 #include <mutex>
 #include <condition_variable>
 
@@ -23,17 +24,31 @@ namespace Gamnet { namespace Database { namespace SQLite {
 			ConnectionInfo();
 			std::string db_;
 			int timeout_;
+			bool wal_;
+		};
+
+		struct PreparedStatement
+		{
+			PreparedStatement();
+			~PreparedStatement();
+
+			sqlite3_stmt* stmt_;
+			bool busy_;
+			std::map<std::string, int> mapColumnName_;
 		};
 
 		sqlite3* conn_;
 		ConnectionInfo connInfo_;
 		UnlockNotification un_;
+		std::map<std::string, std::shared_ptr<PreparedStatement>> mapPreparedStatement_;
 
 		Connection();
 		virtual ~Connection();
 
 		bool Connect(const ConnectionInfo& connInfo);
 		std::shared_ptr<ResultSetImpl> Execute(const std::string& query);
+		// return cached statement for 'query'. new statement is prepared if cached one is in use
+		std::shared_ptr<PreparedStatement> Prepare(const std::string& query);
 	};
 
 	void UnlockNotifyCallback(void** argv, int argc);
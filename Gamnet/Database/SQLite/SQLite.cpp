@@ -1,22 +1,51 @@
 #include "SQLite.h"
 #include "../ConnectionPool.h"
+#include "../Statistics.h"
 #include "../../Library/Singleton.h"
 #include "../../Library/Exception.h"
 
 namespace Gamnet { namespace Database { namespace SQLite {
-	bool Connect(int db_type, const char* db)
+	bool Connect(int db_type, const char* db, bool wal)
 	{
 		Connection::ConnectionInfo connInfo;
 		connInfo.db_ = db;
+		connInfo.wal_ = wal;
 		return Singleton<Database::ConnectionPool<Connection>>::GetInstance().Connect(db_type, connInfo);
 	}
 
-	ResultSet Execute(int db_type, const std::string& query)
+	std::shared_ptr<Connection> GetConnection(int db_type)
 	{
+		// WAL connection is leased to the calling thread until the thread exits
+		static thread_local std::map<int, std::shared_ptr<Connection>> mapThreadConnection;
+		auto itr = mapThreadConnection.find(db_type);
+		if (mapThreadConnection.end() != itr)
+		{
+			return itr->second;
+		}
+
 		std::shared_ptr<Connection> conn = Singleton<Database::ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
+		if (true == conn->connInfo_.wal_)
+		{
+			mapThreadConnection.insert(std::make_pair(db_type, conn));
+		}
+		return conn;
+	}
+
+	ResultSet Execute(int db_type, const std::string& query)
+	{
+		Statistics::Sample sample("SQLite", db_type, query);
+		std::shared_ptr<Connection> conn = GetConnection(db_type);
+		sample.Acquire();
 		ResultSet res;
 		res.impl_ = conn->Execute(query);
 		res.impl_->conn_ = conn;
+		sample.Finish(res.impl_->rowCount_);
 		return res;
 	}
+
+	Statement Prepare(int db_type, const std::string& query)
+	{
+		std::shared_ptr<Connection> conn = GetConnection(db_type);
+		return Statement(conn, conn->Prepare(query));
+	}
 }}}
\ No newline at end of file
@@ -3,15 +3,24 @@
 
 #include "Connection.h"
 #include "Transaction.h"
+#include "Statement.h"
 
 namespace Gamnet { namespace Database { namespace SQLite {
-	bool Connect(int db_type, const char* db);
+	/*!
+	 * \param wal if true, open a private connection per thread with WAL journaling instead of shared cache.
+	 *		readers do not block the writer and 'Prepare' reuses statements cached in the thread's connection.
+	 *		'Transaction' takes a pool connection of its own for its scope, never the thread's one. so 'Execute' and 'Prepare'
+	 *		made while it is open are not part of it, and wait for it like those of another thread.
+	 */
+	bool Connect(int db_type, const char* db, bool wal = false);
+	std::shared_ptr<Connection> GetConnection(int db_type);
 	ResultSet Execute(int db_type, const std::string& query);
 	template <class... ARGS>
 	ResultSet Execute(int db_type, ARGS... args)
 	{
 		return Execute(db_type, Format(args...));
 	}
+	Statement Prepare(int db_type, const std::string& query);
 }}}
 
 #endif /* DATABASE_H_ */
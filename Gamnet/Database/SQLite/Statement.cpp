@@ -0,0 +1,177 @@
+#include "Statement.h"
+#include "../../Library/Exception.h"
+#include "../../Log/Log.h"
+
+namespace Gamnet { namespace Database { namespace SQLite {
+
+	Statement::Statement(const std::shared_ptr<Connection>& conn, const std::shared_ptr<Connection::PreparedStatement>& stmt) : conn_(conn), stmt_(stmt)
+	{
+	}
+
+	Statement::Statement(Statement&& stmt) : conn_(std::move(stmt.conn_)), stmt_(std::move(stmt.stmt_))
+	{
+	}
+
+	Statement::~Statement()
+	{
+		if (nullptr == stmt_)
+		{
+			return;
+		}
+		sqlite3_reset(stmt_->stmt_);
+		sqlite3_clear_bindings(stmt_->stmt_);
+		stmt_->busy_ = false;
+	}
+
+	void Statement::Check(int errorCode) const
+	{
+		if (SQLITE_OK != errorCode)
+		{
+			LOG(GAMNET_ERR, "[SQLite] error_code:", errorCode, ", error_message:", sqlite3_errmsg(conn_->conn_), ", query:", sqlite3_sql(stmt_->stmt_));
+			throw GAMNET_EXCEPTION(ErrorCode::UndefinedError, sqlite3_errmsg(conn_->conn_));
+		}
+	}
+
+	Statement& Statement::BindInt64(int index, int64_t value)
+	{
+		Check(sqlite3_bind_int64(stmt_->stmt_, index, value));
+		return *this;
+	}
+
+	Statement& Statement::Bind(int index, double value)
+	{
+		Check(sqlite3_bind_double(stmt_->stmt_, index, value));
+		return *this;
+	}
+
+	Statement& Statement::Bind(int index, const std::string& value)
+	{
+		Check(sqlite3_bind_text(stmt_->stmt_, index, value.c_str(), (int)value.length(), SQLITE_TRANSIENT));
+		return *this;
+	}
+
+	Statement& Statement::Bind(int index, const char* value)
+	{
+		if (nullptr == value)
+		{
+			return BindNull(index);
+		}
+		Check(sqlite3_bind_text(stmt_->stmt_, index, value, -1, SQLITE_TRANSIENT));
+		return *this;
+	}
+
+	Statement& Statement::BindNull(int index)
+	{
+		Check(sqlite3_bind_null(stmt_->stmt_, index));
+		return *this;
+	}
+
+	bool Statement::Step()
+	{
+		int errorCode = sqlite3_step(stmt_->stmt_);
+		if (SQLITE_ROW == errorCode)
+		{
+			return true;
+		}
+		if (SQLITE_DONE == errorCode)
+		{
+			return false;
+		}
+		sqlite3_reset(stmt_->stmt_);
+		Check(errorCode);
+		return false;
+	}
+
+	int Statement::Execute()
+	{
+		while (true == Step());
+		sqlite3_reset(stmt_->stmt_);
+		return sqlite3_changes(conn_->conn_);
+	}
+
+	void Statement::Reset()
+	{
+		sqlite3_reset(stmt_->stmt_);
+		sqlite3_clear_bindings(stmt_->stmt_);
+	}
+
+	int Statement::GetColumnIndex(const std::string& name) const
+	{
+		auto itr = stmt_->mapColumnName_.find(name);
+		if (stmt_->mapColumnName_.end() == itr)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidKeyError, "Unknown column '", name, "' in 'field list'");
+		}
+		return itr->second;
+	}
+
+	bool Statement::IsNull(int column) const
+	{
+		return SQLITE_NULL == sqlite3_column_type(stmt_->stmt_, column);
+	}
+
+	int Statement::GetInt(int column) const
+	{
+		return sqlite3_column_int(stmt_->stmt_, column);
+	}
+
+	int64_t Statement::GetInt64(int column) const
+	{
+		return sqlite3_column_int64(stmt_->stmt_, column);
+	}
+
+	double Statement::GetDouble(int column) const
+	{
+		return sqlite3_column_double(stmt_->stmt_, column);
+	}
+
+	const char* Statement::GetText(int column) const
+	{
+		const char* text = (const char*)sqlite3_column_text(stmt_->stmt_, column);
+		if (nullptr == text)
+		{
+			return "";
+		}
+		return text;
+	}
+
+	std::string Statement::GetString(int column) const
+	{
+		return std::string(GetText(column), sqlite3_column_bytes(stmt_->stmt_, column));
+	}
+
+	bool Statement::IsNull(const std::string& name) const
+	{
+		return IsNull(GetColumnIndex(name));
+	}
+
+	int Statement::GetInt(const std::string& name) const
+	{
+		return GetInt(GetColumnIndex(name));
+	}
+
+	int64_t Statement::GetInt64(const std::string& name) const
+	{
+		return GetInt64(GetColumnIndex(name));
+	}
+
+	double Statement::GetDouble(const std::string& name) const
+	{
+		return GetDouble(GetColumnIndex(name));
+	}
+
+	const char* Statement::GetText(const std::string& name) const
+	{
+		return GetText(GetColumnIndex(name));
+	}
+
+	std::string Statement::GetString(const std::string& name) const
+	{
+		return GetString(GetColumnIndex(name));
+	}
+
+	int64_t Statement::GetLastInsertID() const
+	{
+		return sqlite3_last_insert_rowid(conn_->conn_);
+	}
+}}}
@@ -0,0 +1,92 @@
+#ifndef GAMNET_DATABASE_SQLITE_STATEMENT_H_
+#define GAMNET_DATABASE_SQLITE_STATEMENT_H_
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+#include "Connection.h"
+
+namespace Gamnet { namespace Database { namespace SQLite {
+	/*!
+	 * \brief cached prepared statement
+	 *
+	 *		statement is returned to the connection's cache when this object is destroyed.
+	 *		column values are read directly from sqlite without copying into std::string.
+	 *		pointer from 'GetText' is valid until next 'Step' call.
+	 * <pre>
+		SQLite::Statement stmt = SQLite::Prepare(db_type, "SELECT user_seq, user_name FROM user WHERE user_level > ?");
+		stmt.Bind(1, 10);
+		while(true == stmt.Step())
+		{
+			int64_t user_seq = stmt.GetInt64(0);
+			const char* user_name = stmt.GetText("user_name");
+		}
+	 * </pre>
+	 */
+	class Statement {
+		std::shared_ptr<Connection> conn_;
+		std::shared_ptr<Connection::PreparedStatement> stmt_;
+
+		void Check(int errorCode) const;
+		Statement& BindInt64(int index, int64_t value);
+		template <class T>
+		void BindFrom(int index, const T& value)
+		{
+			Bind(index, value);
+		}
+		template <class T, class... ARGS>
+		void BindFrom(int index, const T& value, const ARGS&... args)
+		{
+			Bind(index, value);
+			BindFrom(index + 1, args...);
+		}
+	public :
+		Statement(const std::shared_ptr<Connection>& conn, const std::shared_ptr<Connection::PreparedStatement>& stmt);
+		Statement(Statement&& stmt);
+		~Statement();
+
+		// 'index' starts from 1 like sqlite3_bind_*
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value, Statement&>::type Bind(int index, T value)
+		{
+			return BindInt64(index, (int64_t)value);
+		}
+		Statement& Bind(int index, double value);
+		Statement& Bind(int index, const std::string& value);
+		Statement& Bind(int index, const char* value);
+		Statement& BindNull(int index);
+		// bind all parameters from index 1
+		template <class... ARGS>
+		Statement& BindAll(const ARGS&... args)
+		{
+			BindFrom(1, args...);
+			return *this;
+		}
+
+		// return true while a row is available
+		bool Step();
+		// step until done and return affected row count. statement is reset for next execution
+		int Execute();
+		void Reset();
+
+		// 'column' starts from 0 like sqlite3_column_*
+		int GetColumnIndex(const std::string& name) const;
+		bool IsNull(int column) const;
+		int GetInt(int column) const;
+		int64_t GetInt64(int column) const;
+		double GetDouble(int column) const;
+		const char* GetText(int column) const;
+		std::string GetString(int column) const;
+
+		bool IsNull(const std::string& name) const;
+		int GetInt(const std::string& name) const;
+		int64_t GetInt64(const std::string& name) const;
+		double GetDouble(const std::string& name) const;
+		const char* GetText(const std::string& name) const;
+		std::string GetString(const std::string& name) const;
+
+		int64_t GetLastInsertID() const;
+	};
+}}}
+#endif
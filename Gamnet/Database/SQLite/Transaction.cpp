@@ -1,12 +1,14 @@
 #include "Transaction.h"
+#include "SQLite.h"
 #include "../ConnectionPool.h"
 #include "../../Library/Singleton.h"
 #include "../../Library/Exception.h"
 
 namespace Gamnet { namespace Database {	namespace SQLite {
 
-	Transaction::Transaction(int db_type) : commit(false)
+	Transaction::Transaction(int db_type) : commit(false), db_type(db_type)
 	{
+		// not the connection leased to the thread in WAL mode. queries outside of this transaction go there
 		connection = Singleton<ConnectionPool<Connection>>::GetInstance().GetConnection(db_type);
 		connection->Execute("begin exclusive transaction");
 	}
@@ -2,11 +2,13 @@
 #define GAMNET_DATABASE_SQLITE_TRANSACTION_H_
 
 #include "Connection.h"
+#include "../Statistics.h"
 #include "../../Library/String.h"
 
 namespace Gamnet { namespace Database { namespace SQLite {
 	class Transaction {
 		bool commit;
+		int db_type;
 		std::shared_ptr<Connection> connection;
 	public:
 		Transaction(int db_type);
@@ -16,9 +18,11 @@ namespace Gamnet { namespace Database { namespace SQLite {
 		ResultSet Execute(ARGS... args)
 		{
 			const std::string query = Format(args...);
+			Statistics::Sample sample("SQLite", db_type, query);
 			ResultSet res;
 			res.impl_ = connection->Execute(query);
 			res.impl_->conn_ = connection;
+			sample.Finish(res.impl_->rowCount_);
 			return res;
 		}
 		ResultSet Commit();
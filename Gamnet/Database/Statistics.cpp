@@ -0,0 +1,281 @@
+#include "Statistics.h"
+#include "../Library/Singleton.h"
+#include "../Log/Log.h"
+#include <cctype>
+
+namespace Gamnet { namespace Database {
+
+	static void UpdateMax(std::atomic<uint64_t>& max, uint64_t value)
+	{
+		uint64_t prev = max.load(std::memory_order_relaxed);
+		while (prev < value && false == max.compare_exchange_weak(prev, value, std::memory_order_relaxed));
+	}
+
+	static uint64_t Percentile(const std::atomic<uint64_t>* histogram, uint64_t total, double percentile)
+	{
+		if (0 == total)
+		{
+			return 0;
+		}
+		const uint64_t rank = (uint64_t)(total * percentile);
+		uint64_t count = 0;
+		for (int i = 0; i < Statistics::HISTOGRAM_SIZE; i++)
+		{
+			count += histogram[i].load(std::memory_order_relaxed);
+			if (count > rank)
+			{
+				return (uint64_t)1 << i;
+			}
+		}
+		return (uint64_t)1 << (Statistics::HISTOGRAM_SIZE - 1);
+	}
+
+	Statistics::Counter::Counter(const std::string& name, int db_type) :
+		name(name),
+		db_type(db_type),
+		query_count(0),
+		error_count(0),
+		row_count(0),
+		slow_count(0),
+		elapsed_time(0),
+		max_elapsed_time(0),
+		wait_time(0),
+		max_wait_time(0)
+	{
+		for (int i = 0; i < HISTOGRAM_SIZE; i++)
+		{
+			histogram[i] = 0;
+		}
+	}
+
+	Json::Value Statistics::Counter::State() const
+	{
+		const uint64_t queryCount = query_count;
+		Json::Value root;
+		root["name"] = name;
+		root["db_type"] = db_type;
+		root["query_count"] = (Json::UInt64)queryCount;
+		root["error_count"] = (Json::UInt64)error_count;
+		root["row_count"] = (Json::UInt64)row_count;
+		root["slow_count"] = (Json::UInt64)slow_count;
+
+		Json::Value latency;
+		latency["average_us"] = (Json::UInt64)(0 == queryCount ? 0 : elapsed_time / queryCount);
+		latency["p50_us"] = (Json::UInt64)Percentile(histogram, queryCount, 0.50);
+		latency["p99_us"] = (Json::UInt64)Percentile(histogram, queryCount, 0.99);
+		latency["max_us"] = (Json::UInt64)max_elapsed_time;
+		Json::Value buckets;
+		for (int i = 0; i < HISTOGRAM_SIZE; i++)
+		{
+			buckets.append((Json::UInt64)histogram[i]);
+		}
+		latency["histogram"] = buckets;
+		root["latency"] = latency;
+
+		Json::Value wait;
+		wait["average_us"] = (Json::UInt64)(0 == queryCount ? 0 : wait_time / queryCount);
+		wait["max_us"] = (Json::UInt64)max_wait_time;
+		root["pool_wait"] = wait;
+		return root;
+	}
+
+	Statistics::Sample::Sample(const char* name, int db_type, const std::string& query) :
+		counter_(Singleton<Statistics>::GetInstance().GetCounter(name, db_type)),
+		query_(query),
+		start_(std::chrono::steady_clock::now()),
+		acquire_(start_),
+		finish_(false)
+	{
+	}
+
+	Statistics::Sample::~Sample()
+	{
+		if (false == finish_)
+		{
+			Record(0, true);
+		}
+	}
+
+	void Statistics::Sample::Acquire()
+	{
+		acquire_ = std::chrono::steady_clock::now();
+	}
+
+	void Statistics::Sample::Finish(uint64_t rows, bool error)
+	{
+		finish_ = true;
+		Record(rows, error);
+	}
+
+	void Statistics::Sample::Record(uint64_t rows, bool error)
+	{
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		const uint64_t elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count();
+		const uint64_t wait = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(acquire_ - start_).count();
+
+		counter_->query_count.fetch_add(1, std::memory_order_relaxed);
+		counter_->row_count.fetch_add(rows, std::memory_order_relaxed);
+		counter_->elapsed_time.fetch_add(elapsed, std::memory_order_relaxed);
+		counter_->wait_time.fetch_add(wait, std::memory_order_relaxed);
+		UpdateMax(counter_->max_elapsed_time, elapsed);
+		UpdateMax(counter_->max_wait_time, wait);
+		if (true == error)
+		{
+			counter_->error_count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		int bucket = 0;
+		while (bucket < HISTOGRAM_SIZE - 1 && ((uint64_t)1 << bucket) <= elapsed)
+		{
+			bucket++;
+		}
+		counter_->histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+		const int threshold = Singleton<Statistics>::GetInstance().GetSlowQueryThreshold();
+		if (0 < threshold && (uint64_t)threshold * 1000 <= elapsed)
+		{
+			counter_->slow_count.fetch_add(1, std::memory_order_relaxed);
+			LOG(GAMNET_WRN, "[", counter_->name, "] slow query(db_type:", counter_->db_type, ", elapsed:", elapsed / 1000, "ms, wait:", wait / 1000, "ms, rows:", rows, ", query:", Fingerprint(query_), ")");
+		}
+	}
+
+	Statistics::Statistics() : slow_query_threshold_(1000)
+	{
+	}
+
+	std::shared_ptr<Statistics::Counter> Statistics::GetCounter(const std::string& name, int db_type)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		std::shared_ptr<Counter>& counter = mapCounter_[std::make_pair(name, db_type)];
+		if (nullptr == counter)
+		{
+			counter = std::make_shared<Counter>(name, db_type);
+		}
+		return counter;
+	}
+
+	std::shared_ptr<Statistics::Counter> Statistics::GetCounter(const char* name, int db_type)
+	{
+		// counters are never removed, so a cached one stays valid
+		thread_local std::map<std::pair<const char*, int>, std::shared_ptr<Counter>> cache;
+		std::shared_ptr<Counter>& counter = cache[std::make_pair(name, db_type)];
+		if (nullptr == counter)
+		{
+			counter = GetCounter(std::string(name), db_type);
+		}
+		return counter;
+	}
+
+	void Statistics::SetSlowQueryThreshold(int milliseconds)
+	{
+		slow_query_threshold_ = milliseconds;
+	}
+
+	int Statistics::GetSlowQueryThreshold() const
+	{
+		return slow_query_threshold_;
+	}
+
+	Json::Value Statistics::State()
+	{
+		Json::Value root;
+		root["slow_query_threshold_ms"] = GetSlowQueryThreshold();
+		Json::Value database;
+		std::lock_guard<std::mutex> lo(lock_);
+		for (auto& itr : mapCounter_)
+		{
+			database.append(itr.second->State());
+		}
+		root["database"] = database;
+		return root;
+	}
+
+	std::string Statistics::Fingerprint(const std::string& query)
+	{
+		std::string fingerprint;
+		fingerprint.reserve(query.size());
+		size_t i = 0;
+		while (i < query.size())
+		{
+			const char c = query[i];
+			if ('\'' == c || '"' == c)
+			{
+				i++;
+				while (i < query.size() && c != query[i])
+				{
+					if ('\\' == query[i])
+					{
+						i++;
+					}
+					i++;
+				}
+				i++;
+				fingerprint += '?';
+				continue;
+			}
+
+			if (0 != std::isdigit((unsigned char)c) && (true == fingerprint.empty() || (0 == std::isalnum((unsigned char)fingerprint.back()) && '_' != fingerprint.back())))
+			{
+				while (i < query.size() && (0 != std::isalnum((unsigned char)query[i]) || '.' == query[i]))
+				{
+					i++;
+				}
+				fingerprint += '?';
+				continue;
+			}
+
+			if (0 != std::isspace((unsigned char)c))
+			{
+				while (i < query.size() && 0 != std::isspace((unsigned char)query[i]))
+				{
+					i++;
+				}
+				if (false == fingerprint.empty())
+				{
+					fingerprint += ' ';
+				}
+				continue;
+			}
+
+			fingerprint += c;
+			i++;
+		}
+
+		// IN (?, ?, ?) -> IN (?+)
+		for (size_t pos = fingerprint.find('?'); std::string::npos != pos; pos = fingerprint.find('?', pos + 1))
+		{
+			size_t end = pos + 1;
+			while (true)
+			{
+				size_t next = end;
+				if (next < fingerprint.size() && ' ' == fingerprint[next])
+				{
+					next++;
+				}
+				if (next >= fingerprint.size() || ',' != fingerprint[next])
+				{
+					break;
+				}
+				next++;
+				if (next < fingerprint.size() && ' ' == fingerprint[next])
+				{
+					next++;
+				}
+				if (next >= fingerprint.size() || '?' != fingerprint[next])
+				{
+					break;
+				}
+				end = next + 1;
+			}
+			if (pos + 1 != end)
+			{
+				fingerprint.replace(pos, end - pos, "?+");
+			}
+		}
+		while (false == fingerprint.empty() && ' ' == fingerprint.back())
+		{
+			fingerprint.pop_back();
+		}
+		return fingerprint;
+	}
+}}
@@ -0,0 +1,83 @@
+#ifndef _GAMNET_DATABASE_STATISTICS_H_
+#define _GAMNET_DATABASE_STATISTICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "../Library/Json/json.h"
+
+namespace Gamnet { namespace Database {
+	/*!
+	 * \brief query latency, error and row counters per backend and db_type
+	 *
+	 *		latency is collected in power of two microsecond buckets. bucket 'i' counts queries shorter than 2^i us.
+	 *		queries slower than slow query threshold are logged with their fingerprint, literals replaced by '?'.
+	 */
+	class Statistics {
+	public :
+		enum {
+			HISTOGRAM_SIZE = 25
+		};
+
+		struct Counter
+		{
+			Counter(const std::string& name, int db_type);
+
+			const std::string name;
+			const int db_type;
+			std::atomic<uint64_t> query_count;
+			std::atomic<uint64_t> error_count;
+			std::atomic<uint64_t> row_count;
+			std::atomic<uint64_t> slow_count;
+			std::atomic<uint64_t> elapsed_time;
+			std::atomic<uint64_t> max_elapsed_time;
+			std::atomic<uint64_t> wait_time;
+			std::atomic<uint64_t> max_wait_time;
+			std::atomic<uint64_t> histogram[HISTOGRAM_SIZE];
+
+			Json::Value State() const;
+		};
+
+		/*!
+		 * \brief measure one query from before acquiring connection to receiving result
+		 *
+		 *		if 'Finish' is not called before destruction (exception thrown), the query is counted as error.
+		 */
+		class Sample {
+			std::shared_ptr<Counter> counter_;
+			const std::string& query_;
+			std::chrono::steady_clock::time_point start_;
+			std::chrono::steady_clock::time_point acquire_;
+			bool finish_;
+
+			void Record(uint64_t rows, bool error);
+		public :
+			Sample(const char* name, int db_type, const std::string& query);
+			~Sample();
+
+			// call after connection is taken from pool
+			void Acquire();
+			void Finish(uint64_t rows, bool error = false);
+		};
+	private :
+		std::mutex lock_;
+		std::map<std::pair<std::string, int>, std::shared_ptr<Counter>> mapCounter_;
+		std::atomic<int> slow_query_threshold_;
+	public :
+		Statistics();
+
+		std::shared_ptr<Counter> GetCounter(const std::string& name, int db_type);
+		// 'name' should be a literal. looked up in a per-thread cache, so only the first query of a thread takes the lock
+		std::shared_ptr<Counter> GetCounter(const char* name, int db_type);
+		// milliseconds. 0 disables slow query log
+		void SetSlowQueryThreshold(int milliseconds);
+		int GetSlowQueryThreshold() const;
+		Json::Value State();
+
+		static std::string Fingerprint(const std::string& query);
+	};
+}}
+#endif
@@ -15,6 +15,12 @@ void Run(int thread_count)
 	}
 
 	io_service_.run();
+	for(auto& thread : ioThreads)
+	{
+		thread.join();
+	}
+	// io_service is stopped. save changes of sessions which are still alive
+	Singleton<Database::MySQL::WriteBack>::GetInstance().FlushAll();
 }
 
 }
@@ -10,6 +10,7 @@
 #include "Library/Base64.h"
 #include "Library/Buffer.h"
 #include "Library/Exception.h"
+#include "Library/Journal.h"
 #include "Library/MD5.h"
 #include "Library/MultiLock.h"
 #include "Library/Pool.h"
@@ -30,11 +30,13 @@ public :
 		DuplicateConnectionError	= 80,
 		CreateDirectoryFailError	= 90,
 		CreateInstanceFailError		= 91,
+		FileIOError					= 92,
 		BufferOverflowError			= 100,
 		BufferUnderflowError		= 101,
 		MessageSeqOmittedError		= 110,
 		BadLexicalCastError			= 120,
 		IdleTimeoutError			= 130,
+		ResponseTimeoutError		= 131,
 		UndefinedError				= 999
 	};
 };
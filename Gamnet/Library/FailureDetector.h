@@ -0,0 +1,129 @@
+#ifndef __GAMNET_LIB_FAILUREDETECTOR_H_
+#define __GAMNET_LIB_FAILUREDETECTOR_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+namespace Gamnet
+{
+/*!
+ * \brief phi accrual failure detector
+ *
+ * 		keeps intervals of recent heartbeats and tells how unlikely the silence since the last one is.
+ * 		phi 1 means 10% chance the peer is still alive, phi 2 1%, phi 3 0.1% and so on. owner picks threshold,
+ * 		so the same detector reacts fast on a steady link and tolerates a jittery one.
+ * 	<pre>
+		Gamnet::FailureDetector detector;
+		detector.HeartBeat(Timer::Now(), 1000); // on every heartbeat
+		if(8.0 < detector.Phi(Timer::Now())) { ... } // on timer
+ * 	</pre>
+ */
+class FailureDetector
+{
+public :
+	enum {
+		WINDOW_SIZE = 100 // intervals kept
+	};
+private :
+	std::mutex lock_;
+	uint64_t intervals_[WINDOW_SIZE];
+	size_t count_;
+	size_t cursor_;
+	double sum_;
+	double squared_sum_;
+	double min_stddev_;
+	uint64_t last_;
+
+	void Add(uint64_t interval)
+	{
+		if(WINDOW_SIZE == count_)
+		{
+			const double old = (double)intervals_[cursor_];
+			sum_ -= old;
+			squared_sum_ -= old * old;
+		}
+		else
+		{
+			count_++;
+		}
+		intervals_[cursor_] = interval;
+		cursor_ = (cursor_ + 1) % WINDOW_SIZE;
+		sum_ += (double)interval;
+		squared_sum_ += (double)interval * interval;
+	}
+public :
+	FailureDetector() : count_(0), cursor_(0), sum_(0), squared_sum_(0), min_stddev_(0), last_(0)
+	{
+	}
+
+	void Reset()
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		count_ = 0;
+		cursor_ = 0;
+		sum_ = 0;
+		squared_sum_ = 0;
+		min_stddev_ = 0;
+		last_ = 0;
+	}
+
+	/*!
+		\param now ms(1/1000 sec)
+		\param expected_interval ms. seeds the window on first heartbeat and quarter of it is the least deviation.
+			0 learns it from the first interval
+	*/
+	void HeartBeat(uint64_t now, uint64_t expected_interval)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		if(0 == last_)
+		{
+			last_ = now;
+			if(0 < expected_interval)
+			{
+				// two samples around the expected interval, until real ones fill the window
+				min_stddev_ = (double)expected_interval / 4;
+				Add(expected_interval - expected_interval / 4);
+				Add(expected_interval + expected_interval / 4);
+			}
+			return;
+		}
+		if(now > last_)
+		{
+			if(0 == count_)
+			{
+				min_stddev_ = (double)(now - last_) / 4;
+			}
+			Add(now - last_);
+		}
+		last_ = now;
+	}
+
+	/*!
+		\return 0 before first heartbeat
+	*/
+	double Phi(uint64_t now)
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		if(0 == last_ || 0 == count_ || now <= last_)
+		{
+			return 0.0;
+		}
+		const double elapsed = (double)(now - last_);
+		const double mean = sum_ / count_;
+		const double stddev = std::max(std::sqrt(std::max(squared_sum_ / count_ - mean * mean, 0.0)), std::max(min_stddev_, 1.0));
+		// logistic approximation of normal distribution
+		const double y = (elapsed - mean) / stddev;
+		const double e = std::exp(-y * (1.5976 + 0.070566 * y * y));
+		if(elapsed > mean)
+		{
+			return -std::log10(std::max(e / (1.0 + e), std::numeric_limits<double>::min()));
+		}
+		return -std::log10(1.0 - 1.0 / (1.0 + e));
+	}
+};
+
+}
+#endif
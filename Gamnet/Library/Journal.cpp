@@ -0,0 +1,497 @@
+#include "Journal.h"
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+#include <cstring>
+#include <fstream>
+#include "Exception.h"
+#include "../Log/Log.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Gamnet
+{
+
+static const char* SEGMENT_PREFIX = "journal_";
+static const char* SEGMENT_SUFFIX = ".log";
+static const char* SPARE_SEGMENT = "spare.tmp";
+
+// fsync of a file or a directory. created, renamed or resized entries survive power failure only after this
+static void Sync(const std::string& path)
+{
+#ifndef _WIN32
+	int fd = open(path.c_str(), O_RDONLY);
+	if (0 > fd)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::FileIOError, "can not open for sync(path:", path, ", errno:", errno, ")");
+	}
+	const int ret = fsync(fd);
+	close(fd);
+	if (0 != ret)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::FileIOError, "sync fail(path:", path, ", errno:", errno, ")");
+	}
+#endif
+}
+
+Journal::Journal() :
+	segment_size_(DEFAULT_SEGMENT_SIZE),
+	commit_window_(DEFAULT_COMMIT_WINDOW),
+	running_(false),
+	next_lsn_(1),
+	sync_directory_(false),
+	stop_drain_(false),
+	checkpoint_lsn_(0),
+	applied_lsn_(0)
+{
+}
+
+Journal::~Journal()
+{
+	Close();
+}
+
+uint32_t Journal::Checksum(uint64_t lsn, const char* data, size_t size)
+{
+	boost::crc_32_type crc;
+	crc.process_bytes(&lsn, sizeof(uint64_t));
+	crc.process_bytes(data, size);
+	return crc.checksum();
+}
+
+bool Journal::Init(const std::string& path, const APPLIER& applier, size_t segment_size, int commit_window)
+{
+	if (true == running_)
+	{
+		LOG(GAMNET_ERR, "journal is already initialized(path:", path_, ")");
+		return false;
+	}
+
+	path_ = path;
+	applier_ = applier;
+	stop_drain_ = false;
+	drain_queue_.clear();
+	segments_.clear();
+	segment_size_ = segment_size;
+	commit_window_ = commit_window;
+
+	try {
+		boost::filesystem::create_directories(path_);
+		boost::filesystem::remove(path_ + "/" + SPARE_SEGMENT);
+
+		std::ifstream checkpoint((path_ + "/checkpoint").c_str());
+		if (true == checkpoint.is_open())
+		{
+			checkpoint >> checkpoint_lsn_;
+		}
+		applied_lsn_ = checkpoint_lsn_;
+
+		for (boost::filesystem::directory_iterator itr(path_); itr != boost::filesystem::directory_iterator(); itr++)
+		{
+			const std::string name = itr->path().filename().string();
+			if (0 != name.find(SEGMENT_PREFIX) || name.size() <= strlen(SEGMENT_PREFIX) + strlen(SEGMENT_SUFFIX))
+			{
+				continue;
+			}
+			const uint64_t first_lsn = std::stoull(name.substr(strlen(SEGMENT_PREFIX), name.size() - strlen(SEGMENT_PREFIX) - strlen(SEGMENT_SUFFIX)));
+			segments_[first_lsn] = itr->path().string();
+		}
+
+		uint64_t last_lsn = checkpoint_lsn_;
+		for (auto& itr : segments_)
+		{
+			last_lsn = std::max(last_lsn, Replay(itr.second, itr.first));
+		}
+		next_lsn_ = last_lsn + 1;
+		LOG(INF, "[Journal] replay(path:", path_, ", segment_count:", segments_.size(), ", checkpoint:", checkpoint_lsn_, ", last_lsn:", last_lsn, ", replay_count:", drain_queue_.size(), ")");
+
+		// always append to a new segment. tail of the last one may be torn by crash
+		current_ = CreateSegment(next_lsn_);
+		Sync(path_);
+		sync_directory_ = false;
+	}
+	catch (const std::exception& e)
+	{
+		LOG(GAMNET_ERR, "journal init fail(path:", path_, ", error:", e.what(), ")");
+		return false;
+	}
+
+	running_ = true;
+	flusher_ = std::thread(std::bind(&Journal::Flush, this));
+	drainer_ = std::thread(std::bind(&Journal::Drain, this));
+	return true;
+}
+
+uint64_t Journal::Replay(const std::string& path, uint64_t first_lsn)
+{
+	if (0 == boost::filesystem::file_size(path))
+	{
+		return first_lsn - 1;
+	}
+
+	boost::interprocess::file_mapping mapping(path.c_str(), boost::interprocess::read_only);
+	boost::interprocess::mapped_region region(mapping, boost::interprocess::read_only);
+	const char* data = static_cast<const char*>(region.get_address());
+	const size_t size = region.get_size();
+
+	uint64_t lsn = first_lsn;
+	size_t pos = 0;
+	while (pos + HEADER_SIZE <= size)
+	{
+		uint32_t length = 0;
+		uint32_t crc = 0;
+		uint64_t record_lsn = 0;
+		std::memcpy(&length, data + pos, sizeof(uint32_t));
+		std::memcpy(&crc, data + pos + 4, sizeof(uint32_t));
+		std::memcpy(&record_lsn, data + pos + 8, sizeof(uint64_t));
+		// unwritten area is zero filled, so lsn mismatch is the end of segment
+		if (lsn != record_lsn || size - pos - HEADER_SIZE < length)
+		{
+			break;
+		}
+		if (crc != Checksum(record_lsn, data + pos + HEADER_SIZE, length))
+		{
+			LOG(GAMNET_WRN, "[Journal] torn record(path:", path, ", lsn:", record_lsn, ")");
+			break;
+		}
+		if (checkpoint_lsn_ < record_lsn)
+		{
+			drain_queue_.push_back(std::make_pair(record_lsn, std::string(data + pos + HEADER_SIZE, length)));
+		}
+		pos += HEADER_SIZE + length;
+		lsn++;
+	}
+	return lsn - 1;
+}
+
+std::string Journal::GetSegmentPath(uint64_t first_lsn) const
+{
+	char name[64] = { 0 };
+	snprintf(name, sizeof(name), "%s%020llu%s", SEGMENT_PREFIX, (unsigned long long)first_lsn, SEGMENT_SUFFIX);
+	return path_ + "/" + name;
+}
+
+std::shared_ptr<Journal::Segment> Journal::MapSegment(const std::string& path)
+{
+	boost::filesystem::remove(path);
+	std::ofstream(path.c_str(), std::ios::binary | std::ios::trunc).close();
+	boost::filesystem::resize_file(path, segment_size_);
+	Sync(path);
+
+	std::shared_ptr<Segment> segment = std::make_shared<Segment>();
+	segment->first_lsn = 0;
+	segment->path = path;
+	segment->mapping = boost::interprocess::file_mapping(path.c_str(), boost::interprocess::read_write);
+	segment->region = boost::interprocess::mapped_region(segment->mapping, boost::interprocess::read_write);
+	segment->write_pos = 0;
+	segment->sync_pos = 0;
+	return segment;
+}
+
+std::shared_ptr<Journal::Segment> Journal::CreateSegment(uint64_t first_lsn)
+{
+	// a segment with same name has no valid record. valid record would have moved 'next_lsn_'
+	const std::string path = GetSegmentPath(first_lsn);
+	std::shared_ptr<Segment> segment = MapSegment(path);
+	segment->first_lsn = first_lsn;
+	segments_[first_lsn] = path;
+	return segment;
+}
+
+std::shared_ptr<Journal::Segment> Journal::NextSegment(uint64_t first_lsn)
+{
+	// flusher syncs the directory before it acknowledges records of the new segment
+	sync_directory_ = true;
+	std::shared_ptr<Segment> spare = spare_;
+	spare_ = nullptr;
+	if (nullptr != spare)
+	{
+		const std::string path = GetSegmentPath(first_lsn);
+		boost::system::error_code ec;
+		boost::filesystem::rename(spare->path, path, ec);
+		if (!ec)
+		{
+			spare->first_lsn = first_lsn;
+			spare->path = path;
+			segments_[first_lsn] = path;
+			return spare;
+		}
+		LOG(GAMNET_WRN, "[Journal] can not rename spare segment(path:", spare->path, ", error:", ec.message(), ")");
+	}
+	// spare is not ready yet. allocate here
+	return CreateSegment(first_lsn);
+}
+
+uint64_t Journal::Append(const std::string& record, boost::asio::strand& strand, const COMMIT_HANDLER& handler)
+{
+	const size_t size = HEADER_SIZE + record.size();
+	if (segment_size_ < size)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "too large journal record(size:", record.size(), ", segment_size:", segment_size_, ")");
+	}
+
+	std::lock_guard<std::mutex> lo(lock_);
+	if (false == running_)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::NotInitializedError, "journal is not initialized");
+	}
+	if (segment_size_ - current_->write_pos < size)
+	{
+		sealed_.push_back(current_);
+		current_ = NextSegment(next_lsn_);
+	}
+
+	const uint64_t lsn = next_lsn_++;
+	const uint32_t length = (uint32_t)record.size();
+	const uint32_t crc = Checksum(lsn, record.data(), record.size());
+	char* data = static_cast<char*>(current_->region.get_address()) + current_->write_pos;
+	std::memcpy(data, &length, sizeof(uint32_t));
+	std::memcpy(data + 4, &crc, sizeof(uint32_t));
+	std::memcpy(data + 8, &lsn, sizeof(uint64_t));
+	std::memcpy(data + HEADER_SIZE, record.data(), record.size());
+	current_->write_pos += size;
+
+	Waiter waiter = { lsn, record, strand, handler };
+	waiters_.push_back(waiter);
+	if (1 == waiters_.size())
+	{
+		cond_.notify_one();
+	}
+	return lsn;
+}
+
+void Journal::Flush()
+{
+	std::unique_lock<std::mutex> lo(lock_);
+	while (true)
+	{
+		if (nullptr == spare_ && true == running_)
+		{
+			// resize and mmap of a segment take long. done here, out of 'lock_'
+			lo.unlock();
+			std::shared_ptr<Segment> spare;
+			try {
+				spare = MapSegment(path_ + "/" + SPARE_SEGMENT);
+			}
+			catch (const std::exception& e)
+			{
+				LOG(GAMNET_ERR, "[Journal] can not allocate spare segment(path:", path_, ", error:", e.what(), ")");
+			}
+			lo.lock();
+			spare_ = spare;
+		}
+		cond_.wait(lo, [this]() { return false == running_ || false == waiters_.empty(); });
+		if (true == waiters_.empty())
+		{
+			break;
+		}
+		// group commit. records appended in the window share one sync
+		cond_.wait_for(lo, std::chrono::milliseconds(commit_window_), [this]() { return false == running_; });
+
+		std::vector<Waiter> waiters;
+		waiters.swap(waiters_);
+		std::vector<std::shared_ptr<Segment>> segments;
+		segments.swap(sealed_);
+		segments.push_back(current_);
+		const size_t write_pos = current_->write_pos;
+		const bool sync_directory = sync_directory_;
+		sync_directory_ = false;
+		lo.unlock();
+
+		int errorCode = ErrorCode::Success;
+		for (const std::shared_ptr<Segment>& segment : segments)
+		{
+			const size_t end = (segment == segments.back() ? write_pos : segment->write_pos);
+			if (segment->sync_pos >= end)
+			{
+				continue;
+			}
+			// msync needs page aligned address
+			const size_t begin = segment->sync_pos - segment->sync_pos % boost::interprocess::mapped_region::get_page_size();
+			if (false == segment->region.flush(begin, end - begin, false))
+			{
+				LOG(GAMNET_ERR, "[Journal] sync fail(path:", segment->path, ", begin:", segment->sync_pos, ", end:", end, ")");
+				errorCode = ErrorCode::FileIOError;
+				continue;
+			}
+			segment->sync_pos = end;
+		}
+		if (true == sync_directory)
+		{
+			try {
+				Sync(path_);
+			}
+			catch (const std::exception& e)
+			{
+				LOG(GAMNET_ERR, "[Journal] directory sync fail(path:", path_, ", error:", e.what(), ")");
+				errorCode = ErrorCode::FileIOError;
+				std::lock_guard<std::mutex> relock(lock_);
+				sync_directory_ = true;
+			}
+		}
+
+		if (ErrorCode::Success == errorCode)
+		{
+			std::lock_guard<std::mutex> drain_lo(drain_lock_);
+			for (Waiter& waiter : waiters)
+			{
+				drain_queue_.push_back(std::make_pair(waiter.lsn, std::move(waiter.record)));
+			}
+			drain_cond_.notify_one();
+		}
+
+		for (Waiter& waiter : waiters)
+		{
+			COMMIT_HANDLER handler = waiter.handler;
+			waiter.strand.post([handler, errorCode]() {
+				try {
+					handler(errorCode);
+				}
+				catch (const Exception& e)
+				{
+					LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+				}
+			});
+		}
+		lo.lock();
+	}
+}
+
+void Journal::Drain()
+{
+	while (true)
+	{
+		std::pair<uint64_t, std::string> record;
+		{
+			std::unique_lock<std::mutex> lo(drain_lock_);
+			drain_cond_.wait(lo, [this]() { return true == stop_drain_ || false == drain_queue_.empty(); });
+			if (true == drain_queue_.empty())
+			{
+				break;
+			}
+			record = drain_queue_.front();
+		}
+
+		while (true)
+		{
+			bool applied = false;
+			try {
+				applied = applier_(record.first, record.second);
+			}
+			catch (const Exception& e)
+			{
+				LOG(GAMNET_ERR, "[Journal] apply fail(lsn:", record.first, ", error:", e.what(), ")");
+			}
+			if (true == applied)
+			{
+				break;
+			}
+			if (false == running_)
+			{
+				// not applied records are replayed on next 'Init'
+				Checkpoint();
+				return;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_INTERVAL));
+		}
+
+		bool idle = false;
+		{
+			std::lock_guard<std::mutex> lo(drain_lock_);
+			drain_queue_.pop_front();
+			idle = drain_queue_.empty();
+		}
+		applied_lsn_ = record.first;
+		if (CHECKPOINT_INTERVAL <= applied_lsn_ - checkpoint_lsn_ || true == idle)
+		{
+			Checkpoint();
+		}
+	}
+	Checkpoint();
+}
+
+void Journal::Checkpoint()
+{
+	const uint64_t applied_lsn = applied_lsn_;
+	if (applied_lsn == checkpoint_lsn_)
+	{
+		return;
+	}
+
+	try {
+		const std::string path = path_ + "/checkpoint";
+		{
+			std::ofstream checkpoint((path + ".tmp").c_str(), std::ios::trunc);
+			checkpoint << applied_lsn;
+		}
+		// content before rename, and rename itself before segments are removed
+		Sync(path + ".tmp");
+		boost::filesystem::rename(path + ".tmp", path);
+		Sync(path_);
+		checkpoint_lsn_ = applied_lsn;
+
+		// segment is removable when all records of it are applied. records of a segment end before the first lsn of next one
+		std::vector<std::string> removes;
+		{
+			std::lock_guard<std::mutex> lo(lock_);
+			for (auto itr = segments_.begin(); itr != segments_.end();)
+			{
+				auto next = std::next(itr);
+				if (segments_.end() == next || next->first > applied_lsn + 1)
+				{
+					break;
+				}
+				removes.push_back(itr->second);
+				itr = segments_.erase(itr);
+			}
+		}
+		for (const std::string& remove : removes)
+		{
+			boost::filesystem::remove(remove);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		LOG(GAMNET_ERR, "[Journal] checkpoint fail(path:", path_, ", lsn:", applied_lsn, ", error:", e.what(), ")");
+	}
+}
+
+void Journal::Close()
+{
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		if (false == running_)
+		{
+			return;
+		}
+		running_ = false;
+		cond_.notify_one();
+	}
+	flusher_.join();
+	{
+		// drainer stops after flusher, so records synced while closing are applied
+		std::lock_guard<std::mutex> lo(drain_lock_);
+		stop_drain_ = true;
+		drain_cond_.notify_one();
+	}
+	drainer_.join();
+
+	std::lock_guard<std::mutex> lo(lock_);
+	current_ = nullptr;
+	sealed_.clear();
+	if (nullptr != spare_)
+	{
+		const std::string spare = spare_->path;
+		spare_ = nullptr;
+		boost::system::error_code ec;
+		boost::filesystem::remove(spare, ec);
+	}
+}
+
+uint64_t Journal::GetAppliedLSN() const
+{
+	return applied_lsn_;
+}
+
+}
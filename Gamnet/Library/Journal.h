@@ -0,0 +1,125 @@
+#ifndef __GAMNET_LIB_JOURNAL_H_
+#define __GAMNET_LIB_JOURNAL_H_
+
+#include <boost/asio.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Gamnet
+{
+/*!
+ * \brief append-only write-ahead journal with group commit
+ *
+ * 		records are copied to memory mapped segment files and synced to disk once per commit window for all records
+ * 		appended in the window. 'handler' of 'Append' is called in the given strand after the record is durable.
+ * 		durable records are passed to 'applier' in order on a separate thread. records not applied yet
+ * 		are replayed to 'applier' on next 'Init'. applier can see a record again after crash, so it should be idempotent.
+ * 		next segment is allocated and mapped ahead by the flusher thread, so 'Append' only renames it when a segment is full.
+ * 		directory is synced after segment creation and checkpoint rename, so neither is lost by power failure.
+ * 		<pre>
+	Gamnet::Singleton<Gamnet::Journal>::GetInstance().Init("./journal", [](uint64_t lsn, const std::string& record) {
+		Gamnet::Database::MySQL::Execute(db_type, record);
+		return true;
+	});
+
+	Gamnet::Singleton<Gamnet::Journal>::GetInstance().Append(query, session->strand, [session](int error_code) {
+		// record is on disk. send answer to client
+	});
+ * 		</pre>
+ */
+class Journal
+{
+public :
+	typedef std::function<void(int error_code)> COMMIT_HANDLER;
+	// return false to retry the record later
+	typedef std::function<bool(uint64_t lsn, const std::string& record)> APPLIER;
+
+	enum {
+		DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024,
+		DEFAULT_COMMIT_WINDOW = 2, // milliseconds
+		HEADER_SIZE = 16, // uint32 length, uint32 crc, uint64 lsn
+		CHECKPOINT_INTERVAL = 1000, // applied records between checkpoints
+		RETRY_INTERVAL = 1000 // milliseconds
+	};
+private :
+	struct Segment
+	{
+		uint64_t first_lsn;
+		std::string path;
+		boost::interprocess::file_mapping mapping;
+		boost::interprocess::mapped_region region;
+		size_t write_pos;
+		size_t sync_pos;
+	};
+
+	struct Waiter
+	{
+		uint64_t lsn;
+		std::string record;
+		boost::asio::strand strand;
+		COMMIT_HANDLER handler;
+	};
+
+	std::string path_;
+	size_t segment_size_;
+	int commit_window_;
+	APPLIER applier_;
+	std::atomic<bool> running_;
+
+	std::mutex lock_;
+	std::condition_variable cond_;
+	std::shared_ptr<Segment> current_;
+	std::vector<std::shared_ptr<Segment>> sealed_;
+	std::vector<Waiter> waiters_;
+	std::map<uint64_t, std::string> segments_;
+	uint64_t next_lsn_;
+	std::shared_ptr<Segment> spare_; // allocated ahead with temporary name
+	bool sync_directory_; // new segment is not synced to directory yet
+
+	std::mutex drain_lock_;
+	std::condition_variable drain_cond_;
+	std::deque<std::pair<uint64_t, std::string>> drain_queue_;
+	bool stop_drain_;
+	uint64_t checkpoint_lsn_;
+	std::atomic<uint64_t> applied_lsn_;
+
+	std::thread flusher_;
+	std::thread drainer_;
+
+	std::string GetSegmentPath(uint64_t first_lsn) const;
+	std::shared_ptr<Segment> MapSegment(const std::string& path);
+	std::shared_ptr<Segment> CreateSegment(uint64_t first_lsn);
+	// under 'lock_'. takes 'spare_' if it is ready, or creates one
+	std::shared_ptr<Segment> NextSegment(uint64_t first_lsn);
+	uint64_t Replay(const std::string& path, uint64_t first_lsn);
+	void Flush();
+	void Drain();
+	void Checkpoint();
+	static uint32_t Checksum(uint64_t lsn, const char* data, size_t size);
+public :
+	Journal();
+	~Journal();
+
+	bool Init(const std::string& path, const APPLIER& applier, size_t segment_size = DEFAULT_SEGMENT_SIZE, int commit_window = DEFAULT_COMMIT_WINDOW);
+	// sync and apply all appended records and stop threads
+	void Close();
+
+	/*!
+	 * \return lsn(log sequence number) of the record
+	 */
+	uint64_t Append(const std::string& record, boost::asio::strand& strand, const COMMIT_HANDLER& handler);
+	uint64_t GetAppliedLSN() const;
+};
+
+}
+#endif
@@ -13,35 +13,65 @@ namespace Gamnet {
 	{
 	}
 
-	static thread_local MT19937Wrapper mt;
+	Xoshiro256::Xoshiro256(uint64_t seed)
+	{
+		// splitmix64 spreads one seed to 256 bits of state
+		for (int i = 0; i < 4; i++)
+		{
+			uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			state_[i] = z ^ (z >> 31);
+		}
+	}
+
+	static uint64_t Seed()
+	{
+		std::random_device rd;
+		return ((uint64_t)rd() << 32) | rd();
+	}
+
+	Xoshiro256& Random::Engine()
+	{
+		static thread_local Xoshiro256 engine(Seed());
+		return engine;
+	}
 
 	int32_t Random::Range(int32_t min, int32_t max)
 	{
-		std::uniform_int_distribution<int32_t> dist(min, max);
-		return (int32_t)dist(mt.engine);
+		if (max < min)
+		{
+			std::swap(min, max);
+		}
+		const uint64_t range = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+		if (UINT32_MAX < range)
+		{
+			return (int32_t)(uint32_t)Engine()();
+		}
+		return (int32_t)((int64_t)min + Engine().Below((uint32_t)range));
 	}
 	/*
 	uint32_t Random::Range(uint32_t min, uint32_t max)
 	{
 		std::uniform_int_distribution<uint32_t> dist(min, max);
-		return (uint32_t)dist(mt.engine);
+		return (uint32_t)dist(Engine());
 	}
 	*/
 	int64_t Random::Range(int64_t min, int64_t max)
 	{
 		std::uniform_int_distribution<int64_t> dist(min, max);
-		return (int64_t)dist(mt.engine64);
+		return (int64_t)dist(Engine());
 	}
 	/*
 	uint64_t Random::Range(uint64_t min, uint64_t max)
 	{
 		std::uniform_int_distribution<uint64_t> dist(min, max);
-		return (uint64_t)dist(mt.engine64);
+		return (uint64_t)dist(Engine());
 	}
 	*/
 	double Random::Range(double min, double max)
 	{
-		std::uniform_real_distribution<double> dist(min, max);
-		return (double)dist(mt.engine);
+		// 53 random bits to [0, 1)
+		return min + (double)(Engine()() >> 11) * (1.0 / 9007199254740992.0) * (max - min);
 	}
 }
\ No newline at end of file
@@ -1,20 +1,77 @@
 #ifndef GAMNET_RANDOM_H
 #define GAMNET_RANDOM_H
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <random>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
 namespace Gamnet {
+	/*!
+	 * \deprecated Random uses thread local Xoshiro256. kept for code which has its own mt19937 engines
+	 */
 	class MT19937Wrapper {
 	public :
 		MT19937Wrapper();
 		~MT19937Wrapper();
 
-		std::mt19937     engine;
+		std::mt19937     engine;
 		std::mt19937_64  engine64;
 	};
 
+	/*!
+	 * \brief xoshiro256** generator. satisfies UniformRandomBitGenerator, so it works with std distributions
+	 *
+	 *		32 bytes of state and a few shifts per number, much smaller and faster than std::mt19937_64
+	 */
+	class Xoshiro256 {
+		uint64_t state_[4];
+
+		static uint64_t Rotl(uint64_t x, int k)
+		{
+			return (x << k) | (x >> (64 - k));
+		}
+	public :
+		typedef uint64_t result_type;
+
+		explicit Xoshiro256(uint64_t seed);
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return UINT64_MAX; }
+
+		result_type operator () ()
+		{
+			const uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+			const uint64_t t = state_[1] << 17;
+			state_[2] ^= state_[0];
+			state_[3] ^= state_[1];
+			state_[1] ^= state_[2];
+			state_[0] ^= state_[3];
+			state_[2] ^= t;
+			state_[3] = Rotl(state_[3], 45);
+			return result;
+		}
+
+		// unbiased number from 0(include) to range(exclude). range should not be 0
+		uint32_t Below(uint32_t range)
+		{
+			// multiply and shift instead of modulo. rejects only the low part which makes bias
+			uint64_t m = (uint64_t)(uint32_t)((*this)() >> 32) * range;
+			if ((uint32_t)m < range)
+			{
+				const uint32_t threshold = (uint32_t)(0 - range) % range;
+				while ((uint32_t)m < threshold)
+				{
+					m = (uint64_t)(uint32_t)((*this)() >> 32) * range;
+				}
+			}
+			return (uint32_t)(m >> 32);
+		}
+	};
+
 	class Random
 	{
 	public:
@@ -24,6 +81,9 @@ namespace Gamnet {
 		static int64_t Range(int64_t min, int64_t max);
 		//static uint64_t Range(uint64_t min, uint64_t max);
 		static double Range(double min, double max);
+
+		// generator of the calling thread. seeded by std::random_device
+		static Xoshiro256& Engine();
 	};
 
 	template <class T>
@@ -72,14 +132,149 @@ namespace Gamnet {
 			}
 
 			uint32_t r = Random::Range(0, totalWeight_ - 1);
-			for (const auto& itr : valWeight_)
+			auto itr = std::upper_bound(valWeight_.begin(), valWeight_.end(), r, [](uint32_t r, const std::pair<uint32_t, T>& weight) {
+				return r < weight.first;
+			});
+			if (valWeight_.end() == itr)
+			{
+				return valWeight_.back().second;
+			}
+			return itr->second;
+		}
+	};
+
+	/*!
+	 * \brief weighted random with alias table(Vose). O(1) per sample regardless of entry count
+	 *
+	 *		call 'Build' once after all 'SetWeight'. 'Random' is const and safe to call from many threads after build.
+	 * <pre>
+		Gamnet::AliasRandom<int> gacha;
+		for (auto& item : items) { gacha.SetWeight(item.item_id, item.weight); }
+		gacha.Build();
+		int item_id = gacha.Random();
+		std::vector<int> ten = gacha.Random(10);
+	 * </pre>
+	 */
+	template <class T>
+	class AliasRandom
+	{
+		struct Column
+		{
+			uint32_t threshold; // keep the column if low 32 bits of random number are less than this
+			uint32_t alias;
+		};
+		uint64_t totalWeight_;
+		std::vector<uint64_t> weights_;
+		std::vector<T> values_;
+		std::vector<Column> columns_;
+
+		const T& Sample(Xoshiro256& engine) const
+		{
+			// high 32 bits pick the column(bias is under count / 2^32), low 32 bits pick the value or its alias
+			const uint64_t r = engine();
+			const uint32_t index = (uint32_t)(((r >> 32) * columns_.size()) >> 32);
+			const Column& column = columns_[index];
+			return values_[(uint32_t)r < column.threshold ? index : column.alias];
+		}
+	public :
+		AliasRandom() : totalWeight_(0) {}
+
+		void SetWeight(const T& value, uint64_t weight)
+		{
+			if (0 == weight)
+			{
+				return;
+			}
+			if (UINT64_MAX - totalWeight_ < weight)
+			{
+				throw std::overflow_error("total weight was over limit");
+			}
+			if (UINT32_MAX <= values_.size())
+			{
+				throw std::overflow_error("too many weight info");
+			}
+			totalWeight_ += weight;
+			weights_.push_back(weight);
+			values_.push_back(value);
+			columns_.clear();
+		}
+
+		void Build()
+		{
+			const size_t count = weights_.size();
+			std::vector<double> probability(count);
+			std::vector<uint32_t> small;
+			std::vector<uint32_t> large;
+			for (size_t i = 0; i < count; i++)
 			{
-				if (r < itr.first)
+				probability[i] = (double)weights_[i] * count / (double)totalWeight_;
+				(1.0 > probability[i] ? small : large).push_back((uint32_t)i);
+			}
+
+			std::vector<Column> columns(count);
+			while (false == small.empty() && false == large.empty())
+			{
+				const uint32_t less = small.back();
+				const uint32_t more = large.back();
+				small.pop_back();
+				columns[less].threshold = (uint32_t)(probability[less] * 4294967296.0);
+				columns[less].alias = more;
+				probability[more] -= 1.0 - probability[less];
+				if (1.0 > probability[more])
 				{
-					return itr.second;
+					large.pop_back();
+					small.push_back(more);
 				}
 			}
-			return valWeight_.back().second;
+			// left columns are full. rounding error can leave some in 'small' too
+			for (uint32_t i : large)
+			{
+				columns[i].threshold = UINT32_MAX;
+				columns[i].alias = i;
+			}
+			for (uint32_t i : small)
+			{
+				columns[i].threshold = UINT32_MAX;
+				columns[i].alias = i;
+			}
+			columns_.swap(columns);
+		}
+
+		const T& Random() const
+		{
+			if (true == columns_.empty())
+			{
+				throw std::underflow_error("no weight info or not built");
+			}
+			return Sample(Random::Engine());
+		}
+
+		// 'count' samples with replacement
+		std::vector<T> Random(size_t count) const
+		{
+			std::vector<T> result;
+			result.reserve(count);
+			Random(count, std::back_inserter(result));
+			return result;
+		}
+
+		template <class OUTPUT_ITERATOR>
+		void Random(size_t count, OUTPUT_ITERATOR out) const
+		{
+			if (true == columns_.empty())
+			{
+				throw std::underflow_error("no weight info or not built");
+			}
+			Xoshiro256& engine = Random::Engine();
+			for (size_t i = 0; i < count; i++)
+			{
+				*out++ = Sample(engine);
+			}
+		}
+
+		uint64_t GetTotalWeight() const
+		{
+			return totalWeight_;
 		}
 	};
 }
@@ -0,0 +1,133 @@
+#ifndef __GAMNET_LIB_RINGBUFFER_H_
+#define __GAMNET_LIB_RINGBUFFER_H_
+
+#include <atomic>
+#include <vector>
+
+namespace Gamnet
+{
+/*!
+ * \brief lock-free single producer, single consumer queue
+ *
+ * 		one thread calls 'Push' and another thread calls 'Pop'. size is rounded up to power of 2.
+ * 		'Reserve'/'Commit' and 'Front'/'Pop()' access the slot in place, so large items are not moved.
+ */
+template <class T>
+class RingBuffer
+{
+	enum { CACHE_LINE = 64 };
+
+	std::vector<T> items_;
+	size_t mask_;
+	// producer and consumer indexes on separate cache lines. each side caches the other index and reloads it
+	// only when the queue looks full or empty, so the line of the other side is not read on every call
+	char pad0_[CACHE_LINE];
+	std::atomic<size_t> head_; // next to pop
+	size_t tail_cache_;
+	char pad1_[CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+	std::atomic<size_t> tail_; // next to push
+	size_t head_cache_;
+	char pad2_[CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+	static size_t RoundUp(size_t size)
+	{
+		size_t capacity = 1;
+		while(capacity < size)
+		{
+			capacity <<= 1;
+		}
+		return capacity;
+	}
+	bool HasRoom(size_t tail)
+	{
+		if(tail - head_cache_ < items_.size())
+		{
+			return true;
+		}
+		head_cache_ = head_.load(std::memory_order_acquire);
+		return tail - head_cache_ < items_.size();
+	}
+	bool HasItem(size_t head)
+	{
+		if(head != tail_cache_)
+		{
+			return true;
+		}
+		tail_cache_ = tail_.load(std::memory_order_acquire);
+		return head != tail_cache_;
+	}
+public :
+	explicit RingBuffer(size_t size) : items_(RoundUp(size)), mask_(RoundUp(size) - 1), head_(0), tail_cache_(0), tail_(0), head_cache_(0)
+	{
+	}
+
+	// 'item' is moved only when pushed
+	bool Push(T& item)
+	{
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+		if(false == HasRoom(tail))
+		{
+			return false;
+		}
+		items_[tail & mask_] = std::move(item);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& item)
+	{
+		const size_t head = head_.load(std::memory_order_relaxed);
+		if(false == HasItem(head))
+		{
+			return false;
+		}
+		item = std::move(items_[head & mask_]);
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// slot to fill in place. nullptr when full. the slot is not visible to consumer until 'Commit'
+	T* Reserve()
+	{
+		const size_t tail = tail_.load(std::memory_order_relaxed);
+		if(false == HasRoom(tail))
+		{
+			return nullptr;
+		}
+		return &items_[tail & mask_];
+	}
+
+	void Commit()
+	{
+		tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// oldest item in place. nullptr when empty. the slot is reused after 'Pop()'
+	T* Front()
+	{
+		const size_t head = head_.load(std::memory_order_relaxed);
+		if(false == HasItem(head))
+		{
+			return nullptr;
+		}
+		return &items_[head & mask_];
+	}
+
+	void Pop()
+	{
+		head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	bool Empty() const
+	{
+		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+	}
+
+	size_t Capacity() const
+	{
+		return items_.size();
+	}
+};
+
+}
+#endif
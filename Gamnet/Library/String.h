@@ -8,8 +8,11 @@
 #ifndef __GAMNET_LIB_STRING_H_
 #define __GAMNET_LIB_STRING_H_
 
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <sstream>
+#include <type_traits>
 
 namespace Gamnet {
 
@@ -34,12 +37,305 @@ std::string Concat(ARGS&&... args)
 	return stream.str();
 }
 */
+
+inline void FormatWrite(std::string& out, const char* data, size_t size)
+{
+	out.append(data, size);
+}
+
+template <class OUT>
+void FormatWrite(OUT& out, const char* data, size_t size)
+{
+	out.Append(data, size);
+}
+
+/*!
+ * \brief appends one argument to 'out' with the same text as 'operator <<' of std::ostream, without stream and locale
+ *
+ *		numbers and strings have fast paths. other types fall back to their 'operator <<'.
+ *		'out' is std::string or any type with 'Append(const char*, size_t)' like Buffer.
+ */
+template <class T, class Enable = void>
+struct FormatArg
+{
+	template <class OUT>
+	static void Append(OUT& out, const T& value)
+	{
+		std::ostringstream stream;
+		stream << value;
+		const std::string str = stream.str();
+		FormatWrite(out, str.data(), str.size());
+	}
+};
+
+template <>
+struct FormatArg<std::string>
+{
+	template <class OUT>
+	static void Append(OUT& out, const std::string& value)
+	{
+		FormatWrite(out, value.data(), value.size());
+	}
+};
+
+template <>
+struct FormatArg<const char*>
+{
+	template <class OUT>
+	static void Append(OUT& out, const char* value)
+	{
+		if(nullptr != value)
+		{
+			FormatWrite(out, value, ::strlen(value));
+		}
+	}
+};
+
+template <>
+struct FormatArg<char*> : public FormatArg<const char*>
+{
+};
+
+template <size_t N>
+struct FormatArg<char[N]>
+{
+	template <class OUT>
+	static void Append(OUT& out, const char (&value)[N])
+	{
+		const char* nul = (const char*)::memchr(value, '\0', N);
+		FormatWrite(out, value, (nullptr == nul ? N : nul - value));
+	}
+};
+
+// char types print as character and bool as 0 or 1, like std::ostream
+template <class T>
+struct FormatArg<T, typename std::enable_if<std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value>::type>
+{
+	template <class OUT>
+	static void Append(OUT& out, T value)
+	{
+		FormatWrite(out, (const char*)&value, 1);
+	}
+};
+
+template <>
+struct FormatArg<bool>
+{
+	template <class OUT>
+	static void Append(OUT& out, bool value)
+	{
+		FormatWrite(out, (true == value ? "1" : "0"), 1);
+	}
+};
+
+template <class T>
+struct FormatArg<T, typename std::enable_if<std::is_integral<T>::value && 1 < sizeof(T) && false == std::is_same<T, bool>::value>::type>
+{
+	template <class OUT>
+	static void Append(OUT& out, T value)
+	{
+		static const char digits[] =
+			"0001020304050607080910111213141516171819"
+			"2021222324252627282930313233343536373839"
+			"4041424344454647484950515253545556575859"
+			"6061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899";
+		typedef typename std::make_unsigned<T>::type U;
+		const bool negative = (true == std::is_signed<T>::value && (U)value >> (sizeof(T) * 8 - 1));
+		U number = (true == negative ? (U)0 - (U)value : (U)value);
+		char buf[24];
+		char* pos = buf + sizeof(buf);
+		while(100 <= number)
+		{
+			const unsigned i = (unsigned)(number % 100) * 2;
+			number /= 100;
+			*--pos = digits[i + 1];
+			*--pos = digits[i];
+		}
+		if(10 <= number)
+		{
+			const unsigned i = (unsigned)number * 2;
+			*--pos = digits[i + 1];
+			*--pos = digits[i];
+		}
+		else
+		{
+			*--pos = (char)('0' + number);
+		}
+		if(true == negative)
+		{
+			*--pos = '-';
+		}
+		FormatWrite(out, pos, buf + sizeof(buf) - pos);
+	}
+};
+
+// default precision of std::ostream is '%g'
+template <class T>
+struct FormatArg<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+	template <class OUT>
+	static void Append(OUT& out, T value)
+	{
+		char buf[64];
+		const int size = (std::is_same<T, long double>::value ? snprintf(buf, sizeof(buf), "%Lg", (long double)value) : snprintf(buf, sizeof(buf), "%g", (double)value));
+		FormatWrite(out, buf, (0 < size ? size : 0));
+	}
+};
+
+// writes to fixed size memory and truncates the rest
+struct FormatSpan
+{
+	char* pos;
+	char* const end;
+
+	void Append(const char* data, size_t size)
+	{
+		if((size_t)(end - pos) < size)
+		{
+			size = end - pos;
+		}
+		::memcpy(pos, data, size);
+		pos += size;
+	}
+};
+
+template <class OUT>
+void FormatTo(OUT& out)
+{
+}
+
+/*!
+ * \brief appends args to 'out' without temporary string
+ * <pre>
+	Gamnet::FormatTo(query, "SELECT * FROM USER WHERE USER_SEQ=", user_seq);
+	Gamnet::FormatTo(*packet, "{\"user_seq\":", user_seq, "}"); // Buffer. throws when it overflows
+ * </pre>
+ */
+template <class OUT, class T, class... ARGS>
+typename std::enable_if<false == std::is_array<OUT>::value>::type FormatTo(OUT& out, const T& t, const ARGS&... args)
+{
+	FormatArg<T>::Append(out, t);
+	FormatTo(out, args...);
+}
+
+/*!
+ * \brief formats to fixed size char array. output is truncated to N - 1 and always null terminated
+ * \return length of formatted string
+ */
+template <size_t N, class... ARGS>
+size_t FormatTo(char (&buffer)[N], const ARGS&... args)
+{
+	FormatSpan span = { buffer, buffer + N - 1 };
+	FormatTo(span, args...);
+	*span.pos = '\0';
+	return span.pos - buffer;
+}
+
 template <class... ARGS>
 std::string Format(ARGS&&... args)
 {
-	std::stringstream stream;
-	Concat(stream, args...);
-	return stream.str();
+	std::string out;
+	FormatTo(out, args...);
+	return out;
+}
+
+/*!
+ * \brief string of 'FormatTemp'
+ *
+ *		holds the buffer of the calling thread while alive, so 'FormatTemp' called meanwhile(nested, or another argument
+ *		of the same call) formats to its own string instead of overwriting this one. keep the object, not a reference to its string
+ */
+class FormatTempString
+{
+	struct Lease
+	{
+		std::string buffer;
+		bool leased;
+	};
+	static Lease& ThreadLease()
+	{
+		static thread_local Lease lease = { std::string(), false };
+		return lease;
+	}
+
+	Lease* lease_; // nullptr when 'own_' is used
+	std::string own_;
+public :
+	FormatTempString() : lease_(&ThreadLease())
+	{
+		if(true == lease_->leased)
+		{
+			lease_ = nullptr;
+			return;
+		}
+		lease_->leased = true;
+		lease_->buffer.clear();
+	}
+	FormatTempString(FormatTempString&& other) : lease_(other.lease_), own_(std::move(other.own_))
+	{
+		other.lease_ = nullptr;
+	}
+	FormatTempString(const FormatTempString&) = delete;
+	FormatTempString& operator = (const FormatTempString&) = delete;
+	~FormatTempString()
+	{
+		if(nullptr != lease_)
+		{
+			lease_->leased = false;
+		}
+	}
+
+	std::string& str()
+	{
+		return (nullptr == lease_ ? own_ : lease_->buffer);
+	}
+	const std::string& str() const
+	{
+		return (nullptr == lease_ ? own_ : lease_->buffer);
+	}
+	operator const std::string& () const
+	{
+		return str();
+	}
+	const char* c_str() const
+	{
+		return str().c_str();
+	}
+	size_t size() const
+	{
+		return str().size();
+	}
+};
+
+template <>
+struct FormatArg<FormatTempString>
+{
+	template <class OUT>
+	static void Append(OUT& out, const FormatTempString& value)
+	{
+		FormatWrite(out, value.str().data(), value.str().size());
+	}
+};
+
+inline std::ostream& operator << (std::ostream& stream, const FormatTempString& value)
+{
+	return stream << value.str();
+}
+
+/*!
+ * \brief formats to the buffer of the calling thread. no allocation after the buffer grew once
+ * <pre>
+	Gamnet::FormatTempString query = Gamnet::FormatTemp("SELECT * FROM USER WHERE USER_SEQ=", user_seq);
+	mysql_real_query(conn, query.c_str(), query.size());
+ * </pre>
+ */
+template <class... ARGS>
+FormatTempString FormatTemp(const ARGS&... args)
+{
+	FormatTempString out;
+	FormatTo(out.str(), args...);
+	return out;
 }
 };
 
@@ -0,0 +1,119 @@
+#ifndef __GAMNET_LIB_TIMINGWHEEL_H_
+#define __GAMNET_LIB_TIMINGWHEEL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Gamnet
+{
+/*!
+ * \brief hashed timing wheel. O(1) add and expire for many short timeouts
+ *
+ * 		ticks are read from steady clock. 'Advance' expires every tick passed since its last call, so it is called by
+ * 		a 'Timer' of the same interval, and a late timer doesn't push timeouts back. entries can't be removed.
+ * 		owner checks on expire whether the entry is still valid, like a sequence number already answered.
+ * 		timeout longer than one round stays in its bucket until the round of its tick comes.
+ * 	<pre>
+		Gamnet::TimingWheel<uint32_t> wheel(1024, 10);
+		wheel.Add(5000, msg_seq);
+		timer.SetTimer(10, [&wheel]() {
+			wheel.Advance([](uint32_t msg_seq) { ... });
+		});
+ * 	</pre>
+ */
+template <class T>
+class TimingWheel
+{
+	struct Entry
+	{
+		uint64_t tick;
+		T value;
+	};
+
+	std::mutex lock_;
+	std::vector<std::vector<Entry>> buckets_;
+	std::vector<Entry> expired_;
+	const uint64_t interval_;
+	const std::chrono::steady_clock::time_point start_;
+	uint64_t tick_; // last expired tick
+
+	uint64_t Now() const
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_).count() / interval_;
+	}
+public :
+	/*!
+		\param bucket_count ticks of one round
+		\param interval ms(1/1000 sec) of one tick
+	*/
+	TimingWheel(size_t bucket_count, uint64_t interval) : buckets_(bucket_count), interval_(interval), start_(std::chrono::steady_clock::now()), tick_(0)
+	{
+	}
+
+	/*!
+		\param timeout ms(1/1000 sec). rounded up to tick
+	*/
+	void Add(uint64_t timeout, const T& value)
+	{
+		uint64_t ticks = (timeout + interval_ - 1) / interval_;
+		if(0 == ticks)
+		{
+			ticks = 1;
+		}
+		std::lock_guard<std::mutex> lo(lock_);
+		// clock is read under lock, so the entry is never behind a tick already expired
+		const Entry entry = { std::max(Now(), tick_) + ticks, value };
+		buckets_[entry.tick % buckets_.size()].push_back(entry);
+	}
+
+	/*!
+		\param expire called with the value of each entry expired until now, outside of lock
+	*/
+	template <class FUNCTOR>
+	void Advance(FUNCTOR expire)
+	{
+		std::vector<Entry> expired;
+		{
+			std::lock_guard<std::mutex> lo(lock_);
+			const uint64_t now = Now();
+			// one round visits every bucket, so a long stall doesn't walk each tick
+			const uint64_t count = std::min<uint64_t>(now - std::min(now, tick_), buckets_.size());
+			tick_ = std::max(now, tick_);
+			// keeps capacity of both vectors, so steady state doesn't allocate
+			expired.swap(expired_);
+			for(uint64_t t=0; t<count; t++)
+			{
+				std::vector<Entry>& bucket = buckets_[(tick_ - t) % buckets_.size()];
+				for(size_t i=0; i<bucket.size();)
+				{
+					if(tick_ < bucket[i].tick)
+					{
+						i++;
+						continue;
+					}
+					expired.push_back(bucket[i]);
+					bucket[i] = bucket.back();
+					bucket.pop_back();
+				}
+			}
+		}
+		for(const Entry& entry : expired)
+		{
+			expire(entry.value);
+		}
+		expired.clear();
+		std::lock_guard<std::mutex> lo(lock_);
+		expired_.swap(expired);
+	}
+
+	uint64_t Interval() const
+	{
+		return interval_;
+	}
+};
+
+}
+#endif
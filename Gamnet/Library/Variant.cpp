@@ -1,124 +1,370 @@
-#include "Variant.h"
-
-namespace Gamnet {
-Variant::Variant()
-{
-}
-
-Variant::Variant(const std::string& val) : value(val)
+#include "Variant.h"
+#include "Exception.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace Gamnet {
+
+static std::string ToString(double value)
+{
+	// shortest of 15 or 17 digits which reads back to the same value
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.15g", value);
+	if (value != strtod(buf, NULL))
+	{
+		snprintf(buf, sizeof(buf), "%.17g", value);
+	}
+	return buf;
+}
+
+VariantCastError::VariantCastError(const std::type_info& target, const std::string& detail) : boost::bad_lexical_cast(typeid(std::string), target), detail_(detail)
+{
+}
+
+VariantCastError::~VariantCastError() throw()
+{
+}
+
+const char* VariantCastError::what() const throw()
+{
+	return detail_.c_str();
+}
+
+int VariantCastError::error_code() const throw()
+{
+	return ErrorCode::BadLexicalCastError;
+}
+
+Variant::Variant() : type_(TYPE_STRING), number_type_(TYPE_STRING)
+{
+	number_.u = 0;
+}
+
+Variant::Variant(const std::string& val) : type_(TYPE_STRING), number_type_(TYPE_STRING), value(val)
+{
+	Parse();
+}
+
+Variant::Variant(const char* data, size_t size, TYPE type) : type_(TYPE_STRING), number_type_(TYPE_STRING)
+{
+	if ((TYPE_INT == type || TYPE_UINT == type) && true == ParseInteger(data, size))
+	{
+		type_ = number_type_;
+		return;
+	}
+	value.assign(data, size);
+	Parse();
+}
+
+Variant::Variant(const Variant& val) : type_(val.type_), number_type_(val.number_type_), number_(val.number_), value(val.value)
+{
+}
+
+bool Variant::ParseInteger(const char* data, size_t size)
+{
+	number_type_ = TYPE_STRING;
+	number_.u = 0;
+	size_t pos = 0;
+	bool negative = false;
+	if (0 < size && ('-' == data[0] || '+' == data[0]))
+	{
+		negative = ('-' == data[0]);
+		pos = 1;
+	}
+	if (size == pos)
+	{
+		return false;
+	}
+
+	uint64_t number = 0;
+	for (; pos < size; pos++)
+	{
+		const unsigned digit = (unsigned)(unsigned char)data[pos] - '0';
+		if (9 < digit || number > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+		{
+			break;
+		}
+		number = number * 10 + digit;
+	}
+	if (size == pos)
+	{
+		if (false == negative)
+		{
+			number_type_ = (number <= (uint64_t)std::numeric_limits<int64_t>::max() ? TYPE_INT : TYPE_UINT);
+			number_.u = number;
+			return true;
+		}
+		if (number <= (uint64_t)std::numeric_limits<int64_t>::max() + 1)
+		{
+			number_type_ = TYPE_INT;
+			number_.i = (int64_t)(0 - number);
+			return true;
+		}
+	}
+	return false;
+}
+
+void Variant::Parse()
+{
+	const char* data = value.c_str();
+	const size_t size = value.size();
+	if (true == ParseInteger(data, size))
+	{
+		return;
+	}
+	// strtod also takes hex, "inf", "nan" and leading spaces. only [+-]digits[.digits][e[+-]digits] is a number
+	size_t pos = (0 < size && ('-' == data[0] || '+' == data[0]) ? 1 : 0);
+	size_t digits = 0;
+	for (; pos < size && 0 != isdigit((unsigned char)data[pos]); pos++, digits++);
+	if (pos < size && '.' == data[pos])
+	{
+		for (pos++; pos < size && 0 != isdigit((unsigned char)data[pos]); pos++, digits++);
+	}
+	if (0 == digits)
+	{
+		return;
+	}
+	if (pos < size && ('e' == data[pos] || 'E' == data[pos]))
+	{
+		pos++;
+		if (pos < size && ('-' == data[pos] || '+' == data[pos]))
+		{
+			pos++;
+		}
+		const size_t exponent = pos;
+		for (; pos < size && 0 != isdigit((unsigned char)data[pos]); pos++);
+		if (exponent == pos)
+		{
+			return;
+		}
+	}
+	if (size != pos)
+	{
+		return;
+	}
+	char* end = NULL;
+	const double d = strtod(data, &end);
+	if (end == data + size)
+	{
+		number_type_ = TYPE_DOUBLE;
+		number_.d = d;
+	}
+}
+
+int64_t Variant::ToInt(int64_t min, int64_t max) const
 {
+	switch (TYPE_STRING == type_ ? number_type_ : type_)
+	{
+	case TYPE_INT :
+		if (min <= number_.i && number_.i <= max)
+		{
+			return number_.i;
+		}
+		break;
+	case TYPE_UINT :
+		if (number_.u <= (uint64_t)max)
+		{
+			return (int64_t)number_.u;
+		}
+		break;
+	case TYPE_DOUBLE :
+		// "1.5" or "1e3" is not an integer, but assigned double with no fraction is
+		if (TYPE_DOUBLE == type_ && number_.d == std::floor(number_.d) && (double)min <= number_.d && number_.d <= (double)max)
+		{
+			return (int64_t)number_.d;
+		}
+		break;
+	case TYPE_BOOL :
+		return (true == number_.b ? 1 : 0);
+	default :
+		break;
+	}
+	throw VariantCastError(typeid(int64_t), Format("can't convert to integer(value:", (std::string)*this, ", min:", min, ", max:", max, ")"));
 }
 
-Variant::Variant(const Variant& val) : value(val.value)
+uint64_t Variant::ToUInt(uint64_t max) const
 {
+	switch (TYPE_STRING == type_ ? number_type_ : type_)
+	{
+	case TYPE_INT :
+		if (0 <= number_.i && (uint64_t)number_.i <= max)
+		{
+			return (uint64_t)number_.i;
+		}
+		break;
+	case TYPE_UINT :
+		if (number_.u <= max)
+		{
+			return number_.u;
+		}
+		break;
+	case TYPE_DOUBLE :
+		if (TYPE_DOUBLE == type_ && number_.d == std::floor(number_.d) && 0 <= number_.d && number_.d <= (double)max)
+		{
+			return (uint64_t)number_.d;
+		}
+		break;
+	case TYPE_BOOL :
+		return (true == number_.b ? 1 : 0);
+	default :
+		break;
+	}
+	throw VariantCastError(typeid(uint64_t), Format("can't convert to unsigned integer(value:", (std::string)*this, ", max:", max, ")"));
+}
+
+Variant::TYPE Variant::Type() const
+{
+	return type_;
 }
 
 Variant::operator double() const
 {
-	return boost::lexical_cast<double>(value);
+	switch (TYPE_STRING == type_ ? number_type_ : type_)
+	{
+	case TYPE_INT :
+		return (double)number_.i;
+	case TYPE_UINT :
+		return (double)number_.u;
+	case TYPE_DOUBLE :
+		return number_.d;
+	case TYPE_BOOL :
+		return (true == number_.b ? 1.0 : 0.0);
+	default :
+		break;
+	}
+	throw VariantCastError(typeid(double), Format("can't convert to double(value:", value, ")"));
 }
 
-Variant::operator float() const 
-{ 
-	return boost::lexical_cast<float>(value); 
+Variant::operator float() const
+{
+	return (float)(double)*this;
 }
 
-Variant::operator uint16_t() const 
-{ 
-	return boost::lexical_cast<uint16_t>(value); 
+Variant::operator uint16_t() const
+{
+	return (uint16_t)ToUInt(std::numeric_limits<uint16_t>::max());
 }
 
-Variant::operator uint32_t()	const 
-{ 
-	return boost::lexical_cast<uint32_t>(value); 
+Variant::operator uint32_t()	const
+{
+	return (uint32_t)ToUInt(std::numeric_limits<uint32_t>::max());
 }
 
-Variant::operator uint64_t()	const 
-{ 
-	return boost::lexical_cast<uint64_t>(value); 
+Variant::operator uint64_t()	const
+{
+	return ToUInt(std::numeric_limits<uint64_t>::max());
 }
 
-Variant::operator int16_t() const 
+Variant::operator int16_t() const
 {
-	return boost::lexical_cast<int16_t>(value); 
+	return (int16_t)ToInt(std::numeric_limits<int16_t>::min(), std::numeric_limits<int16_t>::max());
 }
 
-Variant::operator int32_t() const 
+Variant::operator int32_t() const
 {
-	return boost::lexical_cast<int32_t>(value); 
+	return (int32_t)ToInt(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
 }
 
-Variant::operator int64_t() const 
-{ 
-	return boost::lexical_cast<int64_t>(value); 
+Variant::operator int64_t() const
+{
+	return ToInt(std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
 }
 
 Variant::operator bool() const
-{ 
-	return boost::lexical_cast<bool>(value); 
+{
+	if (TYPE_BOOL == type_)
+	{
+		return number_.b;
+	}
+	return 0 != ToUInt(1);
 }
-Variant::operator std::string()
-{
-	return value;
+Variant::operator std::string()
+{
+	return static_cast<const Variant&>(*this);
+}
+Variant::operator std::string() const
+{
+	switch (type_)
+	{
+	case TYPE_INT :
+		return Format(number_.i);
+	case TYPE_UINT :
+		return Format(number_.u);
+	case TYPE_DOUBLE :
+		return ToString(number_.d);
+	case TYPE_BOOL :
+		return (true == number_.b ? "1" : "0");
+	default :
+		break;
+	}
+	return value;
 }
-Variant::operator std::string() const
-{
-	return value;
-}
 const Variant& Variant::operator = (const Variant& rhs)
 {
+	type_ = rhs.type_;
+	number_type_ = rhs.number_type_;
+	number_ = rhs.number_;
 	value = rhs.value;
 	return *this;
 }
 const Variant& Variant::operator = (const std::string& rhs)
 {
+	type_ = TYPE_STRING;
 	value = rhs;
+	Parse();
 	return *this;
 }
 const Variant& Variant::operator = (bool rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
+	type_ = TYPE_BOOL;
+	number_.b = rhs;
+	value.clear();
 	return *this;
 }
 const Variant& Variant::operator = (double rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
+	type_ = TYPE_DOUBLE;
+	number_.d = rhs;
+	value.clear();
 	return *this;
 }
 const Variant& Variant::operator = (float rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
-	return *this;
+	return *this = (double)rhs;
 }
 const Variant& Variant::operator = (uint16_t rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
-	return *this;
+	return *this = (uint64_t)rhs;
 }
 const Variant& Variant::operator = (uint32_t rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
-	return *this;
+	return *this = (uint64_t)rhs;
 }
 const Variant& Variant::operator = (uint64_t rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
+	type_ = TYPE_UINT;
+	number_.u = rhs;
+	value.clear();
 	return *this;
 }
 const Variant& Variant::operator = (int16_t rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
-	return *this;
+	return *this = (int64_t)rhs;
 }
 const Variant& Variant::operator = (int32_t rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
-	return *this;
+	return *this = (int64_t)rhs;
 }
 const Variant& Variant::operator = (int64_t rhs)
 {
-	value = boost::lexical_cast<std::string>(rhs);
+	type_ = TYPE_INT;
+	number_.i = rhs;
+	value.clear();
 	return *this;
 }
 
-}
\ No newline at end of file
+}
@@ -1,21 +1,70 @@
-#ifndef GAMNET_LIB_VARIANT_H
-#define GAMNET_LIB_VARIANT_H
-
+#ifndef GAMNET_LIB_VARIANT_H
+#define GAMNET_LIB_VARIANT_H
+
+#include <boost/lexical_cast/bad_lexical_cast.hpp>
+#include <cstdint>
 #include <string>
-#include <boost/lexical_cast.hpp>
+#include <typeinfo>
 
 namespace Gamnet {
+	/*!
+	 * \brief thrown when Variant can't be read as the requested type
+	 *
+	 *		Variant was converted by boost::lexical_cast before, so this derives boost::bad_lexical_cast and
+	 *		'catch (const boost::bad_lexical_cast&)' of old code still works. not a Gamnet::Exception
+	 */
+	class VariantCastError : public boost::bad_lexical_cast
+	{
+		std::string detail_;
+	public :
+		VariantCastError(const std::type_info& target, const std::string& detail);
+		virtual ~VariantCastError() throw();
+		virtual const char* what() const throw();
+		/// \return ErrorCode::BadLexicalCastError
+		int error_code() const throw();
+	};
+	/*!
+	 * \brief string or number value of http parameter, redis result and database column
+	 *
+	 *		numbers are kept in native type. string is parsed once when it is set, so numeric read is a range check
+	 *		and doesn't allocate. reading a number from a string which is not a number throws VariantCastError.
+	 */
 	class Variant {
+	public :
+		enum TYPE {
+			TYPE_STRING,
+			TYPE_INT, // int64_t
+			TYPE_UINT, // uint64_t
+			TYPE_DOUBLE,
+			TYPE_BOOL
+		};
 	private:
+		TYPE type_;
+		TYPE number_type_; // number parsed from string when 'type_' is TYPE_STRING. TYPE_STRING if not a number
+		union {
+			int64_t i;
+			uint64_t u;
+			double d;
+			bool b;
+		} number_;
 		std::string value;
+
+		bool ParseInteger(const char* data, size_t size);
+		void Parse();
+		int64_t ToInt(int64_t min, int64_t max) const;
+		uint64_t ToUInt(uint64_t max) const;
 	public:
 		Variant();
 		Variant(const std::string& val);
+		/// \param type TYPE_INT or TYPE_UINT for a column known to be integer. only the number is stored when 'data' is an integer
+		Variant(const char* data, size_t size, TYPE type = TYPE_STRING);
 		Variant(const Variant& val);
 
+		TYPE Type() const;
+
 		operator bool() const;
 
-		operator std::string();
+		operator std::string();
 		operator std::string() const;
 		operator double() const;
 		operator float() const;
@@ -42,5 +91,5 @@ namespace Gamnet {
 	};
 
 } /* namespace Gamnet */
-
-#endif
+
+#endif
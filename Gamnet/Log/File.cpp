@@ -4,7 +4,18 @@
 
 namespace Gamnet { namespace Log {
 
-File::File() : filesize_(0)
+static size_t FileSize(const std::string& filename)
+{
+	boost::system::error_code ec;
+	const boost::uintmax_t size = boost::filesystem::file_size(filename, ec);
+	if(ec)
+	{
+		return 0;
+	}
+	return (size_t)size;
+}
+
+File::File() : extension_(".txt"), mode_(std::fstream::out | std::fstream::app), filesize_(0), written_(0)
 {
 	::memset(&today_, 0, sizeof(tm));
 }
@@ -26,20 +37,13 @@ std::ofstream& File::open(const tm& now)
 		snprintf(datebuf, 10, "%04d%02d%02d", now.tm_year+1900, now.tm_mon+1, now.tm_mday);
 #endif
 		today_ = now;
-		filename_ = logPath_ + "/" + prefix_ + "_" + std::string(datebuf) + ".txt";
-		ofstream_.open(filename_.c_str(), std::fstream::out | std::fstream::app);
+		filename_ = logPath_ + "/" + prefix_ + "_" + std::string(datebuf) + extension_;
+		ofstream_.open(filename_.c_str(), mode_);
+		written_ = FileSize(filename_);
+		writeHeader();
 	}
 
-	int filesize = 0;
-	try
-	{
-		filesize = boost::filesystem::file_size(filename_.c_str());
-	}
-	catch(boost::filesystem::filesystem_error& /* e */)
-	{
-		filesize = std::numeric_limits<int>::max();
-	}
-	if(filesize_ < filesize)
+	if((size_t)filesize_ < written_)
 	{
 		ofstream_.close();
 		char datebuf[20] = {0};
@@ -49,11 +53,28 @@ std::ofstream& File::open(const tm& now)
 		snprintf(datebuf, 20, "%04d%02d%02d_%02d%02d%02d", now.tm_year+1900, now.tm_mon+1, now.tm_mday, now.tm_hour, now.tm_min, now.tm_sec);
 #endif
 		today_ = now;
-		filename_ = logPath_ + "/" + prefix_ + "_" + std::string(datebuf) + ".txt";
-		ofstream_.open(filename_.c_str(), std::fstream::out | std::fstream::app);
+		filename_ = logPath_ + "/" + prefix_ + "_" + std::string(datebuf) + extension_;
+		ofstream_.open(filename_.c_str(), mode_);
+		written_ = FileSize(filename_);
+		writeHeader();
 	}
 
 	return ofstream_;
 }
 
+void File::writeHeader()
+{
+	if(0 == written_ && false == header_.empty())
+	{
+		ofstream_.write(header_.data(), header_.size());
+		written_ += header_.size();
+	}
+}
+
+void File::write(const tm& now, const char* data, size_t length)
+{
+	open(now).write(data, length);
+	written_ += length;
+}
+
 }} /* Logger */
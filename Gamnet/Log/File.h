@@ -17,13 +17,20 @@ struct File
 	File();
 	~File();
 	std::ofstream& open(const tm& now);
+	// write to the file of 'now'. size is counted here, so rotation doesn't stat the file
+	void write(const tm& now, const char* data, size_t length);
+	void writeHeader();
 
 	std::ofstream ofstream_;
 	std::string prefix_;
 	std::string	filename_;
 	std::string logPath_;
+	std::string extension_; // ".txt"
+	std::string header_; // written at the start of each new file
+	std::ios_base::openmode mode_;
 	tm	today_;
 	int filesize_;
+	size_t written_;
 };
 
 }} /* Logger */
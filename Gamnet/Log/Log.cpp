@@ -5,7 +5,7 @@
  *      Author: kukuta
  */
 
-#include "Logger.h"
+#include "Log.h"
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/exception/diagnostic_information.hpp>
@@ -26,6 +26,13 @@ void ReadXml(const char* xml_path)
 	std::string prefix = ptree_.get<std::string>("server.log.<xmlattr>.prefix");
 	int max_size = ptree_.get<int>("server.log.<xmlattr>.max_file_size");
 	Init(path.c_str(), prefix.c_str(), max_size);
+	if("yes" == ptree_.get<std::string>("server.log.<xmlattr>.async", "no"))
+	{
+		const size_t queue_size = ptree_.get<size_t>("server.log.<xmlattr>.queue_size", 8192);
+		const std::string policy = ptree_.get<std::string>("server.log.<xmlattr>.full_policy", "drop");
+		const bool binary = ("yes" == ptree_.get<std::string>("server.log.<xmlattr>.binary", "no"));
+		Logger::GetInstance().SetAsync(queue_size, "block" == policy ? Logger::FULL_POLICY_BLOCK : Logger::FULL_POLICY_DROP, binary);
+	}
 	auto log = ptree_.get_child("server.log");
 	for(auto elmt : log)
 	{
@@ -74,6 +81,18 @@ void SetLevelProperty(Logger::LOG_LEVEL_TYPE level, int flag)
 	Logger::GetInstance().SetLevelProperty(level, flag);
 }
 
+void SetAsync(size_t queue_size, Logger::FULL_POLICY policy, bool binary)
+{
+	Logger::GetInstance().SetAsync(queue_size, policy, binary);
+}
+
+Json::Value State()
+{
+	Json::Value root;
+	root["throttle"] = Throttle::StateAll();
+	return root;
+}
+
 }}
 
 
@@ -2,18 +2,26 @@
 #define GAMNET_LOG_LOG_H_
 
 #include "Logger.h"
+#include "Throttle.h"
 
 namespace Gamnet { namespace Log {
 	/// \brief Initialize function for Logger lib
 	/// \param log_dir the directory that log file will be created(relative directory path would be recommened)
 	void Init(const char* log_dir = "log", const char* prefix = "log", int max_file_size = 5);
+	/// \brief <log path="log" prefix="log" max_file_size="5" async="yes" queue_size="8192" full_policy="drop|block" binary="no">. async attributes are optional
 	void ReadXml(const char* xml_path);
 	void SetLevelProperty(Logger::LOG_LEVEL_TYPE level, int flag);
+	/// \brief write log on background thread. caller only queues the line
+	/// \param queue_size max lines queued per thread. 'policy' decides what to do when the queue is full
+	/// \param binary log file gets raw records('.bin') and 'logdec' prints them. console stays text
+	void SetAsync(size_t queue_size = 8192, Logger::FULL_POLICY policy = Logger::FULL_POLICY_DROP, bool binary = false);
 	template <typename... Args>
 	void Write(Logger::LOG_LEVEL_TYPE level, const Args&... args)
 	{
 		Logger::GetInstance().Write(level, args...);
 	}
+	/// \brief logged and suppressed line count of each 'LOG_EVERY' and 'LOG_RATE' call site
+	Json::Value State();
 }}
 
 
@@ -23,7 +31,29 @@ namespace Gamnet { namespace Log {
 #define GAMNET_WRN Gamnet::Log::Logger::LOG_LEVEL_WRN, "WRN [", __FILE__, ":", __func__, "@" , __LINE__, "] "
 #define GAMNET_ERR Gamnet::Log::Logger::LOG_LEVEL_ERR, "ERR [", __FILE__, ":", __func__, "@" , __LINE__, "] "
 
+/*!
+ * throttled log for paths which can log for every packet. ' (suppressed:n)' is appended to the line when lines were dropped
+ * <pre>
+	LOG_EVERY(10, 1000, GAMNET_WRN, "discard message(msg_id:", msg_id, ")"); // first 10 lines, then 1 in 1000
+	LOG_RATE(5, 20, GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ")"); // 5 lines per second, burst of 20
+ * </pre>
+ */
+#define GAMNET_LOG_EVERY(first, every, ...) \
+	do { \
+		static Gamnet::Log::Sampler __gamnet_throttle__(__FILE__, __LINE__, first, every); \
+		Gamnet::Log::Throttle::Suppressed __gamnet_suppressed__; \
+		if(true == __gamnet_throttle__.Pass(__gamnet_suppressed__)) { GAMNET_LOG(__VA_ARGS__, __gamnet_suppressed__); } \
+	} while(false)
+#define GAMNET_LOG_RATE(per_second, burst, ...) \
+	do { \
+		static Gamnet::Log::RateLimiter __gamnet_throttle__(__FILE__, __LINE__, per_second, burst); \
+		Gamnet::Log::Throttle::Suppressed __gamnet_suppressed__; \
+		if(true == __gamnet_throttle__.Pass(__gamnet_suppressed__)) { GAMNET_LOG(__VA_ARGS__, __gamnet_suppressed__); } \
+	} while(false)
+
 #define LOG GAMNET_LOG
+#define LOG_EVERY GAMNET_LOG_EVERY
+#define LOG_RATE GAMNET_LOG_RATE
 #define DEV GAMNET_DEV
 #define INF GAMNET_INF
 #define WRN GAMNET_WRN
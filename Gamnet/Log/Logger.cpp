@@ -8,6 +8,7 @@
 #include "File.h"
 #include "Logger.h"
 #include <boost/filesystem.hpp>
+#include <cstring>
 #include "../Library/Exception.h"
 namespace Gamnet { namespace Log {
 
@@ -51,4 +52,265 @@ void Logger::SetLevelProperty(LOG_LEVEL_TYPE level, int flag)
 	Property_[level] = flag;
 }
 
+void Logger::SetAsync(size_t queue_size, FULL_POLICY policy, bool binary)
+{
+	if(false == IsInit_)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::NotInitializedError, "set async log exception, log is not initialized yet");
+	}
+	if(true == running_)
+	{
+		return;
+	}
+	queue_size_ = queue_size;
+	full_policy_ = policy;
+	binary_ = binary;
+	if(true == binary)
+	{
+		// reopens as '.bin' on next write
+		std::lock_guard<std::mutex> lo(mutex_);
+		file_.ofstream_.close();
+		::memset(&file_.today_, 0, sizeof(tm));
+		file_.extension_ = ".bin";
+		file_.mode_ |= std::fstream::binary;
+		file_.header_.assign(RECORD_FILE_MAGIC, sizeof(RECORD_FILE_MAGIC));
+	}
+	running_ = true;
+	writer_ = std::thread(std::bind(&Logger::Run, this));
+	async_ = true;
+}
+
+void Logger::Stop()
+{
+	// 'Write' already past the check of 'async_' still commits. it sees 'running_' false and writes the line by itself
+	async_ = false;
+	if(false == running_.exchange(false))
+	{
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lo(sleep_lock_);
+		sleep_cond_.notify_one();
+	}
+	writer_.join();
+}
+
+Logger::Queue& Logger::GetQueue()
+{
+	static thread_local std::shared_ptr<Queue> queue;
+	if(nullptr == queue)
+	{
+		queue = std::make_shared<Queue>(queue_size_);
+		std::lock_guard<std::mutex> lo(queue_lock_);
+		queues_.push_back(queue);
+	}
+	return *queue;
+}
+
+Logger::Line* Logger::Reserve(Queue& queue)
+{
+	Line* line = nullptr;
+	while(nullptr == (line = queue.Reserve()))
+	{
+		if(FULL_POLICY_DROP == full_policy_ || false == running_)
+		{
+			dropped_++;
+			return nullptr;
+		}
+		std::this_thread::yield();
+	}
+	return line;
+}
+
+void Logger::Push(LOG_LEVEL_TYPE level, const std::string& text)
+{
+	Queue& queue = GetQueue();
+	Line* line = Reserve(queue);
+	if(nullptr == line)
+	{
+		return;
+	}
+	EncodeRecord(line->data, text);
+	line->level = level;
+	line->time = time(NULL);
+	queue.Commit();
+	Wakeup();
+}
+
+void Logger::Wakeup()
+{
+	// pairs with 'sleeping_' store and queue check of writer thread. one of the two sees the other
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(true == sleeping_.load(std::memory_order_relaxed) && true == sleeping_.exchange(false))
+	{
+		std::lock_guard<std::mutex> lo(sleep_lock_);
+		sleep_cond_.notify_one();
+	}
+	if(false == running_)
+	{
+		std::lock_guard<std::mutex> lo(write_lock_);
+		WriteQueued();
+	}
+}
+
+bool Logger::IsEmpty()
+{
+	std::lock_guard<std::mutex> lo(queue_lock_);
+	for(const std::shared_ptr<Queue>& queue : queues_)
+	{
+		if(false == queue->Empty())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t Logger::WriteQueued()
+{
+	std::string out;
+	std::string err;
+	std::string file;
+	time_t cached = 0;
+	tm when;
+	::memset(&when, 0, sizeof(tm));
+	char timebuf[22] = { 0 };
+
+	// time string is formatted once per second, not per line
+	auto setTime = [&](time_t now) {
+		if(cached == now)
+		{
+			return;
+		}
+		// lines of previous time go to the file of previous time(day changes or rotation)
+		if(false == file.empty())
+		{
+			file_.write(when, file.data(), file.size());
+			file.clear();
+		}
+		cached = now;
+#ifdef _WIN32
+		localtime_s(&when, &now);
+		_snprintf_s(timebuf, 22, 21, "[%04d-%02d-%02d %02d:%02d:%02d]", when.tm_year + 1900, when.tm_mon + 1, when.tm_mday, when.tm_hour, when.tm_min, when.tm_sec);
+#else
+		localtime_r(&now, &when);
+		snprintf(timebuf, 22, "[%04d-%02d-%02d %02d:%02d:%02d]", when.tm_year + 1900, when.tm_mon + 1, when.tm_mday, when.tm_hour, when.tm_min, when.tm_sec);
+#endif
+	};
+	std::string text;
+	auto append = [&](LOG_LEVEL_TYPE level, time_t now, const std::string& data) {
+		const bool binary = (true == binary_ && 0 != (Property_[level]&LOG_FILE));
+		if(true == binary)
+		{
+			const uint32_t size = (uint32_t)data.size();
+			const int64_t time = (int64_t)now;
+			file.append((const char*)&size, sizeof(uint32_t)).append((const char*)&time, sizeof(int64_t)).append(data);
+		}
+		if(0 == (Property_[level]&LOG_STDERR) && (true == binary || 0 == (Property_[level]&LOG_FILE)))
+		{
+			return;
+		}
+		text.clear();
+		if(false == DecodeRecord(data.data(), data.size(), text))
+		{
+			text.append(" (broken record)");
+		}
+		if(Property_[level]&LOG_STDERR)
+		{
+			std::string& console = (LOG_LEVEL_ERR == level ? err : out);
+			console.append(timebuf).append(" ").append(text).append("\n");
+		}
+		if(false == binary && 0 != (Property_[level]&LOG_FILE))
+		{
+			file.append(timebuf).append(" ").append(text).append("\n");
+		}
+	};
+
+	std::vector<std::shared_ptr<Queue>> queues;
+	{
+		std::lock_guard<std::mutex> lo(queue_lock_);
+		for(auto itr = queues_.begin(); itr != queues_.end();)
+		{
+			// only this list owns the queue after its thread exits
+			if(1 == itr->use_count() && true == (*itr)->Empty())
+			{
+				itr = queues_.erase(itr);
+				continue;
+			}
+			itr++;
+		}
+		queues = queues_;
+	}
+
+	size_t count = 0;
+	for(const std::shared_ptr<Queue>& queue : queues)
+	{
+		while(Line* line = queue->Front())
+		{
+			count++;
+			setTime(line->time);
+			append(line->level, line->time, line->data);
+			queue->Pop();
+		}
+	}
+
+	const uint64_t dropped = dropped_.exchange(0);
+	if(0 < dropped)
+	{
+		const time_t now = time(NULL);
+		std::string data;
+		EncodeRecord(data, "WRN log queue is full(dropped_count:", dropped, ")");
+		setTime(now);
+		append(LOG_LEVEL_WRN, now, data);
+	}
+
+	if(false == out.empty())
+	{
+		std::cout.write(out.data(), out.size());
+		std::cout.flush();
+	}
+	if(false == err.empty())
+	{
+		std::cerr.write(err.data(), err.size());
+		std::cerr.flush();
+	}
+	if(false == file.empty())
+	{
+		file_.write(when, file.data(), file.size());
+		file_.ofstream_.flush();
+	}
+	return count;
+}
+
+void Logger::Run()
+{
+	while(true)
+	{
+		const bool running = running_;
+		size_t count = 0;
+		{
+			std::lock_guard<std::mutex> lo(write_lock_);
+			count = WriteQueued();
+		}
+		if(0 < count)
+		{
+			continue;
+		}
+		if(false == running)
+		{
+			break;
+		}
+
+		// sleeps until 'Wakeup'. 'sleeping_' is set before the last look at the queues, so no line is left behind
+		std::unique_lock<std::mutex> lo(sleep_lock_);
+		sleeping_ = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(true == IsEmpty())
+		{
+			sleep_cond_.wait_for(lo, std::chrono::milliseconds(IDLE_TIMEOUT), [this]() { return false == sleeping_ || false == running_; });
+		}
+		sleeping_ = false;
+	}
+}
+
 }}
@@ -1,13 +1,19 @@
 #ifndef GAMNET_LOG_LOGGER_H_
 #define GAMNET_LOG_LOGGER_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <sstream>
 #include <iostream>
 #include <mutex>
+#include <thread>
+#include <vector>
 #include "../Library/String.h"
 #include "../Library/Exception.h"
+#include "../Library/RingBuffer.h"
 #include "File.h"
+#include "Record.h"
 
 namespace Gamnet { namespace Log {
 
@@ -29,14 +35,82 @@ public :
 		LOG_FILE   =	0x00000010, /**< print to file */
 		LOG_SYSLOG = 	0x00000100	/**< print to sytem file */
 	};
+
+	/// \brief what async 'Write' does when the queue of the thread is full
+	enum FULL_POLICY
+	{
+		FULL_POLICY_DROP,	/**< discard the line and report the count later */
+		FULL_POLICY_BLOCK	/**< wait until the writer thread makes room */
+	};
 private :
+	enum {
+		IDLE_TIMEOUT = 100 // ms. sleeping writer thread reports dropped lines on this interval
+	};
+	struct Line
+	{
+		LOG_LEVEL_TYPE level;
+		time_t time;
+		std::string data; // encoded by 'EncodeRecord'. printed on writer thread, or by 'logdec' in binary mode
+	};
+	typedef RingBuffer<Line> Queue;
+
 	int  Property_[LOG_LEVEL_MAX];
 	bool IsInit_;
 	File file_;
 	std::mutex mutex_;
+
+	// async mode. each thread pushes to its own queue and one writer thread drains all of them
+	std::atomic<bool> async_;
+	size_t queue_size_;
+	FULL_POLICY full_policy_;
+	std::mutex queue_lock_;
+	std::vector<std::shared_ptr<Queue>> queues_;
+	std::atomic<bool> running_;
+	std::atomic<uint64_t> dropped_;
+	std::thread writer_;
+	std::mutex write_lock_; // consumer side of queues. writer thread, or 'Write' racing with 'Stop'
+	std::mutex sleep_lock_;
+	std::condition_variable sleep_cond_;
+	std::atomic<bool> sleeping_;
+	bool binary_; // file gets raw records
+
+	Queue& GetQueue();
+	// waits or drops by full policy. nullptr when dropped
+	Line* Reserve(Queue& queue);
+	void Push(LOG_LEVEL_TYPE level, const std::string& text);
+	// after a line is committed. wakes writer thread, or writes the line here if writer thread is stopped
+	void Wakeup();
+	bool IsEmpty();
+	// formats and writes all committed lines. under 'write_lock_'
+	size_t WriteQueued();
+	void Run();
+
+	template <typename... Args>
+	void PushRecord(LOG_LEVEL_TYPE level, std::true_type, const Args&... args)
+	{
+		Queue& queue = GetQueue();
+		Line* line = queue.Reserve();
+		if(nullptr == line && nullptr == (line = Reserve(queue)))
+		{
+			return;
+		}
+		EncodeRecord(line->data, args...);
+		line->level = level;
+		line->time = time(NULL);
+		queue.Commit();
+		Wakeup();
+	}
+	template <typename... Args>
+	void PushRecord(LOG_LEVEL_TYPE level, std::false_type, const Args&... args)
+	{
+		Push(level, Format(args...));
+	}
 public :
-	Logger() : IsInit_(false){};
-	virtual ~Logger(){};
+	Logger() : IsInit_(false), async_(false), queue_size_(0), full_policy_(FULL_POLICY_DROP), running_(false), dropped_(0), sleeping_(false), binary_(false) {};
+	virtual ~Logger()
+	{
+		Stop();
+	};
 
 	static Logger& GetInstance()
 	{
@@ -57,6 +131,13 @@ public :
 			throw GAMNET_EXCEPTION(ErrorCode::NotInitializedError, "write log exception, log is not initialized yet");
 		}
 
+		if(true == async_)
+		{
+			// formatting is deferred to writer thread when every argument is a number or string
+			PushRecord(level, std::integral_constant<bool, Record<Args...>::encodable>(), args...);
+			return;
+		}
+
 		std::string s = Format(args...);
 		time_t logtime_;
 		struct tm when;
@@ -84,8 +165,9 @@ public :
 		}
 		if(Property_[level]&LOG_FILE)
 		{
-			std::ofstream& ofstream_ = file_.open(when);
-			ofstream_ << timebuf << " " << s.c_str() << std::endl;
+			const std::string line = std::string(timebuf) + " " + s + "\n";
+			file_.write(when, line.c_str(), line.length());
+			file_.ofstream_.flush();
 		}
 	}
 
@@ -94,6 +176,12 @@ public :
 	/// \return  return if true or false
 	void Init(const char* logPath, const char* prefix, int max_file_size);
 	void SetLevelProperty(LOG_LEVEL_TYPE level, int flag);
+	/// \brief switch to async mode. 'Write' only copies arguments to the queue and a writer thread formats and writes in batch
+	/// \param queue_size max lines queued per thread
+	/// \param binary write raw records to '.bin' file instead of text. 'logdec' prints them
+	void SetAsync(size_t queue_size, FULL_POLICY policy, bool binary = false);
+	/// \brief write all queued lines and stop the writer thread
+	void Stop();
 };
 
 }}
@@ -0,0 +1,265 @@
+#ifndef GAMNET_LOG_RECORD_H_
+#define GAMNET_LOG_RECORD_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include "../Library/String.h"
+
+namespace Gamnet { namespace Log {
+
+/*!
+ * \brief log arguments copied as raw bytes on the caller thread and printed on the writer thread or by 'logdec'
+ *
+ * 		each argument is one byte type tag and its value. numbers are widened to 64 bit and strings are length + bytes,
+ * 		so a record is printed without knowing its call site. printing uses 'FormatArg', so the line is identical to 'Format'.
+ * 		other types are not encodable and the line is formatted eagerly, then encoded as one string.
+ * 		literals and __FILE__ are copied like runtime strings. 'LOG' is a function, not a macro, so it has no call site to
+ * 		register a static descriptor of them. 'bench_log_record' prints what the copy costs.
+ */
+enum RECORD_TYPE
+{
+	RECORD_TYPE_BOOL = 1,
+	RECORD_TYPE_CHAR,
+	RECORD_TYPE_INT64,
+	RECORD_TYPE_UINT64,
+	RECORD_TYPE_DOUBLE,
+	RECORD_TYPE_LONG_DOUBLE,
+	RECORD_TYPE_STRING
+};
+
+/*!
+ * \brief binary log file is 'RECORD_FILE_MAGIC' and frames of (uint32 record size, int64 time, record)
+ */
+static const char RECORD_FILE_MAGIC[8] = { 'G', 'M', 'L', 'O', 'G', '0', '0', '1' };
+
+// stored type and tag of a number. float prints as double, and integers print the same after widening
+template <class T, class Enable = void>
+struct RecordNumber
+{
+	typedef typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type type;
+	enum { tag = (std::is_signed<T>::value ? RECORD_TYPE_INT64 : RECORD_TYPE_UINT64) };
+};
+template <>
+struct RecordNumber<bool> { typedef bool type; enum { tag = RECORD_TYPE_BOOL }; };
+template <class T>
+struct RecordNumber<T, typename std::enable_if<std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value>::type>
+{
+	typedef char type;
+	enum { tag = RECORD_TYPE_CHAR };
+};
+template <>
+struct RecordNumber<float> { typedef double type; enum { tag = RECORD_TYPE_DOUBLE }; };
+template <>
+struct RecordNumber<double> { typedef double type; enum { tag = RECORD_TYPE_DOUBLE }; };
+template <>
+struct RecordNumber<long double> { typedef long double type; enum { tag = RECORD_TYPE_LONG_DOUBLE }; };
+
+template <class T, class Enable = void>
+struct RecordArg
+{
+	enum { encodable = false };
+};
+
+template <class T>
+struct RecordArg<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+	typedef typename RecordNumber<T>::type type;
+	enum { encodable = true };
+	static size_t Size(const T&)
+	{
+		return 1 + sizeof(type);
+	}
+	static void Encode(char*& pos, const T& value)
+	{
+		const type number = (type)value;
+		*pos++ = (char)RecordNumber<T>::tag;
+		::memcpy(pos, &number, sizeof(type));
+		pos += sizeof(type);
+	}
+};
+
+struct RecordString
+{
+	enum { encodable = true };
+	static size_t Size(size_t length)
+	{
+		return 1 + sizeof(uint32_t) + length;
+	}
+	static void Encode(char*& pos, const char* value, size_t length)
+	{
+		const uint32_t size = (uint32_t)length;
+		*pos++ = (char)RECORD_TYPE_STRING;
+		::memcpy(pos, &size, sizeof(uint32_t));
+		::memcpy(pos + sizeof(uint32_t), value, length);
+		pos += sizeof(uint32_t) + length;
+	}
+};
+
+template <>
+struct RecordArg<std::string> : public RecordString
+{
+	static size_t Size(const std::string& value)
+	{
+		return RecordString::Size(value.length());
+	}
+	static void Encode(char*& pos, const std::string& value)
+	{
+		RecordString::Encode(pos, value.data(), value.length());
+	}
+};
+
+template <>
+struct RecordArg<const char*> : public RecordString
+{
+	static size_t Size(const char* value)
+	{
+		return RecordString::Size(nullptr == value ? 0 : ::strlen(value));
+	}
+	static void Encode(char*& pos, const char* value)
+	{
+		RecordString::Encode(pos, value, (nullptr == value ? 0 : ::strlen(value)));
+	}
+};
+
+template <>
+struct RecordArg<char*> : public RecordArg<const char*>
+{
+};
+
+// string literal, __FILE__, __func__ or char buffer
+template <size_t N>
+struct RecordArg<char[N]> : public RecordString
+{
+	static size_t Length(const char (&value)[N])
+	{
+		const char* nul = (const char*)::memchr(value, '\0', N);
+		return (nullptr == nul ? N : nul - value);
+	}
+	static size_t Size(const char (&value)[N])
+	{
+		return RecordString::Size(Length(value));
+	}
+	static void Encode(char*& pos, const char (&value)[N])
+	{
+		RecordString::Encode(pos, value, Length(value));
+	}
+};
+
+template <class... ARGS>
+struct Record;
+
+template <>
+struct Record<>
+{
+	enum { encodable = true };
+	static size_t Size()
+	{
+		return 0;
+	}
+	static void Encode(char*&)
+	{
+	}
+};
+
+template <class T, class... ARGS>
+struct Record<T, ARGS...>
+{
+	enum { encodable = RecordArg<T>::encodable && Record<ARGS...>::encodable };
+	static size_t Size(const T& value, const ARGS&... args)
+	{
+		return RecordArg<T>::Size(value) + Record<ARGS...>::Size(args...);
+	}
+	static void Encode(char*& pos, const T& value, const ARGS&... args)
+	{
+		RecordArg<T>::Encode(pos, value);
+		Record<ARGS...>::Encode(pos, args...);
+	}
+};
+
+// 'data' keeps its capacity, so a reused slot does not allocate
+template <class... ARGS>
+void EncodeRecord(std::string& data, const ARGS&... args)
+{
+	data.resize(Record<ARGS...>::Size(args...));
+	char* pos = &data[0];
+	Record<ARGS...>::Encode(pos, args...);
+}
+
+template <class T>
+bool DecodeNumber(const char*& pos, const char* end, std::string& out)
+{
+	if((size_t)(end - pos) < sizeof(T))
+	{
+		return false;
+	}
+	T value;
+	::memcpy(&value, pos, sizeof(T));
+	pos += sizeof(T);
+	FormatArg<T>::Append(out, value);
+	return true;
+}
+
+/*!
+ * \brief appends text of the record to 'out'
+ * \return false if the record is broken. text decoded so far is appended
+ */
+inline bool DecodeRecord(const char* data, size_t size, std::string& out)
+{
+	const char* pos = data;
+	const char* end = data + size;
+	while(pos < end)
+	{
+		bool decoded = false;
+		switch(*pos++)
+		{
+		case RECORD_TYPE_BOOL :
+			decoded = DecodeNumber<bool>(pos, end, out);
+			break;
+		case RECORD_TYPE_CHAR :
+			decoded = DecodeNumber<char>(pos, end, out);
+			break;
+		case RECORD_TYPE_INT64 :
+			decoded = DecodeNumber<int64_t>(pos, end, out);
+			break;
+		case RECORD_TYPE_UINT64 :
+			decoded = DecodeNumber<uint64_t>(pos, end, out);
+			break;
+		case RECORD_TYPE_DOUBLE :
+			decoded = DecodeNumber<double>(pos, end, out);
+			break;
+		case RECORD_TYPE_LONG_DOUBLE :
+			decoded = DecodeNumber<long double>(pos, end, out);
+			break;
+		case RECORD_TYPE_STRING :
+		{
+			uint32_t length = 0;
+			if((size_t)(end - pos) < sizeof(uint32_t))
+			{
+				break;
+			}
+			::memcpy(&length, pos, sizeof(uint32_t));
+			pos += sizeof(uint32_t);
+			if((size_t)(end - pos) < length)
+			{
+				break;
+			}
+			out.append(pos, length);
+			pos += length;
+			decoded = true;
+			break;
+		}
+		default :
+			break;
+		}
+		if(false == decoded)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+}}
+#endif
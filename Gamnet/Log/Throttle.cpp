@@ -0,0 +1,84 @@
+#include "Throttle.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace Gamnet { namespace Log {
+
+struct Sites
+{
+	std::mutex lock;
+	std::vector<const Throttle*> throttles;
+
+	static Sites& GetInstance()
+	{
+		static Sites self;
+		return self;
+	}
+};
+
+Throttle::Throttle(const char* file, int line) : file_(file), line_(line), logged_(0), suppressed_(0), pending_(0)
+{
+	Sites& sites = Sites::GetInstance();
+	std::lock_guard<std::mutex> lo(sites.lock);
+	sites.throttles.push_back(this);
+}
+
+Throttle::~Throttle()
+{
+	Sites& sites = Sites::GetInstance();
+	std::lock_guard<std::mutex> lo(sites.lock);
+	sites.throttles.erase(std::remove(sites.throttles.begin(), sites.throttles.end(), this), sites.throttles.end());
+}
+
+Json::Value Throttle::State() const
+{
+	Json::Value root;
+	root["file"] = file_;
+	root["line"] = line_;
+	root["logged_count"] = (Json::UInt64)logged_;
+	root["suppressed_count"] = (Json::UInt64)suppressed_;
+	return root;
+}
+
+Json::Value Throttle::StateAll()
+{
+	Json::Value root(Json::arrayValue);
+	Sites& sites = Sites::GetInstance();
+	std::lock_guard<std::mutex> lo(sites.lock);
+	for(const Throttle* throttle : sites.throttles)
+	{
+		root.append(throttle->State());
+	}
+	return root;
+}
+
+Sampler::Sampler(const char* file, int line, uint64_t first, uint64_t every) : Throttle(file, line), first_(first), every_(0 == every ? 1 : every), count_(0)
+{
+}
+
+RateLimiter::RateLimiter(const char* file, int line, double per_second, uint64_t burst) :
+	Throttle(file, line),
+	interval_(0 < per_second ? (int64_t)(1000000000.0 / per_second) : std::numeric_limits<int64_t>::max() / 4),
+	burst_((int64_t)std::min((double)interval_ * (0 == burst ? 1 : burst), (double)(std::numeric_limits<int64_t>::max() / 2))),
+	next_(0)
+{
+}
+
+int64_t RateLimiter::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::ostream& operator << (std::ostream& stream, const Throttle::Suppressed& suppressed)
+{
+	if(0 < suppressed.count)
+	{
+		stream << " (suppressed:" << suppressed.count << ")";
+	}
+	return stream;
+}
+
+}}
@@ -0,0 +1,121 @@
+#ifndef GAMNET_LOG_THROTTLE_H_
+#define GAMNET_LOG_THROTTLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include "../Library/Json/json.h"
+#include "Record.h"
+
+namespace Gamnet { namespace Log {
+
+/*!
+ * \brief per call site limit for log lines of hot error paths
+ *
+ * 		one static instance is created for each 'LOG_EVERY' or 'LOG_RATE' call site. lines over the limit are only counted,
+ * 		and the next logged line of the site shows how many were suppressed since the previous one.
+ * 		counters of all sites are reported by 'Log::State'.
+ */
+class Throttle
+{
+public :
+	// last argument of a throttled line. prints " (suppressed:n)" when n > 0
+	struct Suppressed
+	{
+		uint64_t count;
+	};
+private :
+	const char* file_;
+	const int line_;
+	std::atomic<uint64_t> logged_;
+	std::atomic<uint64_t> suppressed_;
+	std::atomic<uint64_t> pending_;
+protected :
+	Throttle(const char* file, int line);
+	bool Pass(bool pass, Suppressed& suppressed)
+	{
+		if(false == pass)
+		{
+			suppressed_.fetch_add(1, std::memory_order_relaxed);
+			pending_.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		logged_.fetch_add(1, std::memory_order_relaxed);
+		suppressed.count = pending_.exchange(0, std::memory_order_relaxed);
+		return true;
+	}
+public :
+	~Throttle();
+
+	Json::Value State() const;
+	static Json::Value StateAll();
+};
+
+/// \brief logs first 'first' lines, then 1 in 'every' lines
+class Sampler : public Throttle
+{
+	const uint64_t first_;
+	const uint64_t every_;
+	std::atomic<uint64_t> count_;
+public :
+	Sampler(const char* file, int line, uint64_t first, uint64_t every);
+	bool Pass(Suppressed& suppressed)
+	{
+		const uint64_t count = count_.fetch_add(1, std::memory_order_relaxed);
+		return Throttle::Pass(count < first_ || 0 == (count - first_ + 1) % every_, suppressed);
+	}
+};
+
+/// \brief token bucket. logs 'per_second' lines per second on average and up to 'burst' lines at once
+class RateLimiter : public Throttle
+{
+	const int64_t interval_; // nanoseconds per token
+	const int64_t burst_; // nanoseconds of 'burst' tokens
+	std::atomic<int64_t> next_; // time when bucket is full again
+	static int64_t Now();
+public :
+	RateLimiter(const char* file, int line, double per_second, uint64_t burst);
+	bool Pass(Suppressed& suppressed)
+	{
+		// generic cell rate algorithm: one atomic timestamp instead of token count + refill time
+		const int64_t now = Now();
+		int64_t next = next_.load(std::memory_order_relaxed);
+		while(true)
+		{
+			const int64_t start = (next < now ? now : next);
+			if(start - now > burst_ - interval_)
+			{
+				return Throttle::Pass(false, suppressed);
+			}
+			if(true == next_.compare_exchange_weak(next, start + interval_, std::memory_order_relaxed))
+			{
+				return Throttle::Pass(true, suppressed);
+			}
+		}
+	}
+};
+
+std::ostream& operator << (std::ostream& stream, const Throttle::Suppressed& suppressed);
+
+// same text as 'operator <<'. nothing when no line was suppressed
+template <>
+struct RecordArg<Throttle::Suppressed>
+{
+	enum { encodable = true };
+	static size_t Size(const Throttle::Suppressed& value)
+	{
+		return (0 == value.count ? 0 : RecordString::Size(sizeof(" (suppressed:") - 1) + RecordArg<uint64_t>::Size(value.count) + RecordString::Size(1));
+	}
+	static void Encode(char*& pos, const Throttle::Suppressed& value)
+	{
+		if(0 < value.count)
+		{
+			RecordString::Encode(pos, " (suppressed:", sizeof(" (suppressed:") - 1);
+			RecordArg<uint64_t>::Encode(pos, value.count);
+			RecordString::Encode(pos, ")", 1);
+		}
+	}
+};
+
+}}
+#endif
@@ -14,7 +14,7 @@ void Dispatcher::OnRecvMsg(const std::shared_ptr<Network::Link>& link, const std
 	auto itr = mapHandlerFunction_.find(uri);
 	if(itr == mapHandlerFunction_.end())
 	{
-		LOG(ERR, "[link_key:", link->link_key,"] can't find handler function(uri:", uri, ")");
+		LOG_RATE(10, 100, ERR, "[link_key:", link->link_key,"] can't find handler function(uri:", uri, ")");
 		Response res;
 		res.error_code = 404;
 		res.context = "404 Not found";
@@ -26,7 +26,7 @@ void Dispatcher::OnRecvMsg(const std::shared_ptr<Network::Link>& link, const std
 	std::shared_ptr<Network::IHandler> handler = handler_function.factory_->GetHandler(&session->handler_container, 0);
 	if(NULL == handler)
 	{
-		LOG(ERR, "[link_key:", link->link_key,"] can't find handler function(uri:", uri, ")");
+		LOG_RATE(10, 100, ERR, "[link_key:", link->link_key,"] can't find handler function(uri:", uri, ")");
 		Response res;
 		res.error_code = 404;
 		res.context = "404 Not found";
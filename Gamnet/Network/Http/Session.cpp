@@ -19,10 +19,8 @@ Session::~Session() {
 void Session::Send(const Response& res)
 {
 	std::string response;
-	response += Format("HTTP/1.1 ", res.error_code, " ", GetErrorStr(res.error_code), "\r\n");
-	response += Format("\r\n");
-	response += res.context;
-	response += Format("\r\n\r\n");
+	response.reserve(64 + res.context.length());
+	FormatTo(response, "HTTP/1.1 ", res.error_code, " ", GetErrorStr(res.error_code), "\r\n\r\n", res.context, "\r\n\r\n");
 	AsyncSend(response.c_str(), response.length());
 }
 
@@ -1,5 +1,6 @@
 #include "Link.h"
 #include "LinkManager.h"
+#include <algorithm>
 
 namespace Gamnet { namespace Network {
 
@@ -50,6 +51,16 @@ void Link::Connect(const char* host, int port, int timeout)
 	boost::asio::ip::tcp::resolver resolver_(io_service_);
 	boost::asio::ip::tcp::endpoint endpoint_(*resolver_.resolve({host, Format(port).c_str()}));
 
+	// armed before connect. connect completed on other thread may cancel it before this
+	if(0 < timeout)
+	{
+		timer.AutoReset(false);
+		timer.SetTimer(timeout*1000, strand.wrap([this]() {
+			Log::Write(GAMNET_WRN, "[", link_manager->name, ", link_key:", link_key, "] connect timeout(ip:", remote_address.to_string(), ")");
+			Close(ErrorCode::ConnectTimeoutError);
+		}));
+	}
+
 	auto self = shared_from_this();
 	assert(self);
 	socket.async_connect(endpoint_, strand.wrap([self](const boost::system::error_code& ec) {
@@ -87,15 +98,6 @@ void Link::Connect(const char* host, int port, int timeout)
 			}
 		}
 	}));
-
-	if(0 < timeout)
-	{
-		timer.AutoReset(false);
-		timer.SetTimer(timeout*1000, strand.wrap([this]() {
-			Log::Write(GAMNET_WRN, "[", link_manager->name, ", link_key:", link_key, "] connect timeout(ip:", remote_address.to_string(), ")");
-			Close(ErrorCode::ConnectTimeoutError);
-		}));
-	}
 }
 
 void Link::AsyncRead()
@@ -162,25 +164,45 @@ void Link::AsyncSend(const std::shared_ptr<Buffer>& buffer)
 	})(buffer);
 }
 
+void Link::AsyncSend(const std::vector<std::shared_ptr<Buffer>>& buffers)
+{
+	auto self(shared_from_this());
+	strand.post([self, buffers]() {
+		bool needFlush = self->send_buffers.empty();
+		self->send_buffers.insert(self->send_buffers.end(), buffers.begin(), buffers.end());
+		if(true == needFlush)
+		{
+			self->FlushSend();
+		}
+	});
+}
+
 void Link::FlushSend()
 {
 	if(false == send_buffers.empty())
 	{
 		auto self(shared_from_this());
-		const std::shared_ptr<Buffer> buffer = send_buffers.front();
-		boost::asio::async_write(socket, boost::asio::buffer(buffer->ReadPtr(), buffer->Size()),
-			strand.wrap([self](const boost::system::error_code& ec, std::size_t transferredBytes) {
+		// buffers queued while previous write was in flight go out together as one gather write
+		const size_t count = std::min(send_buffers.size(), (size_t)MAX_GATHER_COUNT);
+		std::vector<boost::asio::const_buffer> gather;
+		gather.reserve(count);
+		for(size_t i=0; i<count; i++)
+		{
+			const std::shared_ptr<Buffer>& buffer = send_buffers[i];
+			gather.push_back(boost::asio::buffer(buffer->ReadPtr(), buffer->Size()));
+		}
+		boost::asio::async_write(socket, gather,
+			strand.wrap([self, count](const boost::system::error_code& ec, std::size_t transferredBytes) {
 				if (0 != ec)
 				{
 					self->Close(ErrorCode::Success); // no error, just closed socket
 					return;
 				}
 
-				if (true == self->send_buffers.empty())
+				for(size_t i=0; i<count && false == self->send_buffers.empty(); i++)
 				{
-					return;
+					self->send_buffers.pop_front();
 				}
-				self->send_buffers.pop_front();
 				self->FlushSend();
 			}
 		));
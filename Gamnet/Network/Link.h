@@ -11,6 +11,9 @@ class LinkManager;
 class Link : public std::enable_shared_from_this<Link> 
 {
 public :
+	enum {
+		MAX_GATHER_COUNT = 64 // buffers written by one async_write
+	};
 	static std::atomic<uint32_t> link_key_generator;
 private :
 	std::shared_ptr<Buffer> 			read_buffer;
@@ -46,6 +49,9 @@ public :
 	void Connect(const char* host, int port, int timeout);
 	void AsyncSend(const char* buf, int len);
 	void AsyncSend(const std::shared_ptr<Buffer>& buffer);
+	// queues all buffers at once, so they go out together in one write. always posted, so calls from inside and
+	// outside of the strand reach the queue in call order
+	void AsyncSend(const std::vector<std::shared_ptr<Buffer>>& buffers);
 	int  SyncSend(const char* buf, int len);
 	int  SyncSend(const std::shared_ptr<Buffer>& buffer);
 	void Close(int reason);
@@ -0,0 +1,258 @@
+#include "CallManager.h"
+#include "RouterCaster.h"
+#include "../../Log/Log.h"
+
+namespace Gamnet { namespace Network { namespace Router {
+
+CallManager::Statistics::Statistics(const std::string& name) : name(name), in_flight(0), call_count(0), error_count(0), timeout_count(0)
+{
+	for(int i=0; i<LATENCY_BUCKET_COUNT; i++)
+	{
+		latency[i] = 0;
+	}
+}
+
+void CallManager::Statistics::OnComplete(int error_code, uint64_t elapsed)
+{
+	in_flight.fetch_sub(1, std::memory_order_relaxed);
+	if(ErrorCode::ResponseTimeoutError == error_code)
+	{
+		timeout_count.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	if(ErrorCode::Success != error_code)
+	{
+		error_count.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	int bucket = 0;
+	for(uint64_t ms = elapsed / 1000; 0 < ms && bucket < LATENCY_BUCKET_COUNT - 1; ms >>= 1)
+	{
+		bucket++;
+	}
+	latency[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+Json::Value CallManager::Statistics::State() const
+{
+	Json::Value root;
+	root["name"] = name;
+	root["in_flight"] = (Json::Int64)in_flight.load(std::memory_order_relaxed);
+	root["call_count"] = (Json::UInt64)call_count.load(std::memory_order_relaxed);
+	root["error_count"] = (Json::UInt64)error_count.load(std::memory_order_relaxed);
+	root["timeout_count"] = (Json::UInt64)timeout_count.load(std::memory_order_relaxed);
+	Json::Value histogram;
+	for(int i=0; i<LATENCY_BUCKET_COUNT - 1; i++)
+	{
+		histogram[Format("under_", 1 << i, "ms")] = (Json::UInt64)latency[i].load(std::memory_order_relaxed);
+	}
+	histogram[Format("over_", 1 << (LATENCY_BUCKET_COUNT - 2), "ms")] = (Json::UInt64)latency[LATENCY_BUCKET_COUNT - 1].load(std::memory_order_relaxed);
+	root["latency"] = histogram;
+	return root;
+}
+
+CallManager::Slot::Slot() : state(EMPTY), msg_id(0), id(0), service_hash(0), generation(0), closed(0), start_time(0)
+{
+}
+
+std::atomic<CallManager*> CallManager::instance_(nullptr);
+
+CallManager::CallManager() : slots_(new Slot[SLOT_COUNT]), next_slot_(0), wheel_(WHEEL_SIZE, TICK_INTERVAL)
+{
+	timer_.AutoReset(true);
+	timer_.SetTimer(TICK_INTERVAL, [this]() {
+		wheel_.Advance([this](uint32_t msg_seq) {
+			Complete(msg_seq, ErrorCode::ResponseTimeoutError, nullptr);
+		});
+	});
+	instance_.store(this, std::memory_order_release);
+}
+
+CallManager::~CallManager()
+{
+	instance_.store(nullptr, std::memory_order_release);
+	timer_.Cancel();
+}
+
+CallManager* CallManager::Find()
+{
+	return instance_.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<CallManager::Statistics> CallManager::GetStatistics(const Address& addr)
+{
+	const std::string name = (ROUTER_CAST_TYPE::UNI_CAST == addr.cast_type ? Format(addr.service_name, ":", addr.id) : addr.service_name);
+	std::lock_guard<std::mutex> lo(lock_);
+	std::shared_ptr<Statistics>& statistics = statistics_[name];
+	if(nullptr == statistics)
+	{
+		statistics = std::make_shared<Statistics>(name);
+	}
+	return statistics;
+}
+
+uint32_t CallManager::Register(const Address& addr, const std::shared_ptr<Session>& peer, uint32_t msg_id, int timeout, const Callback& callback)
+{
+	// slots are taken in turn, so the next one is free unless a call is pending over a whole round
+	const uint32_t start = next_slot_.fetch_add(1, std::memory_order_relaxed);
+	uint32_t index = SLOT_COUNT;
+	for(uint32_t i=0; i<SLOT_COUNT; i++)
+	{
+		uint64_t state = EMPTY;
+		if(true == slots_[(start + i) % SLOT_COUNT].state.compare_exchange_strong(state, LOCKED, std::memory_order_acquire))
+		{
+			index = (start + i) % SLOT_COUNT;
+			break;
+		}
+	}
+	if(SLOT_COUNT == index)
+	{
+		return 0;
+	}
+	Slot& slot = slots_[index];
+	slot.generation = (slot.generation + 1) % (CALL_SEQ >> SLOT_BITS);
+	const uint32_t msg_seq = CALL_SEQ | (slot.generation << SLOT_BITS) | index;
+	slot.msg_id.store(msg_id, std::memory_order_relaxed);
+	slot.id.store((nullptr != peer ? peer->address.id : 0), std::memory_order_relaxed);
+	slot.service_hash.store(std::hash<std::string>()(addr.service_name), std::memory_order_relaxed);
+	slot.start_time = Timer::Now<std::chrono::microseconds>();
+	slot.callback = callback;
+	slot.statistics = GetStatistics(addr);
+	slot.statistics->in_flight.fetch_add(1, std::memory_order_relaxed);
+	slot.statistics->call_count.fetch_add(1, std::memory_order_relaxed);
+	slot.peer = peer;
+	if(nullptr != peer)
+	{
+		peer->outstanding.fetch_add(1, std::memory_order_relaxed);
+	}
+	slot.state.store(PENDING | msg_seq, std::memory_order_release);
+
+	// answer may come before this. then the entry just finds the slot released
+	wheel_.Add(0 < timeout ? timeout : 0, msg_seq);
+	return msg_seq;
+}
+
+bool CallManager::Complete(uint32_t msg_seq, int error_code, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	Slot& slot = slots_[msg_seq % SLOT_COUNT];
+	uint64_t state = PENDING | msg_seq;
+	if(false == slot.state.compare_exchange_strong(state, LOCKED, std::memory_order_acquire))
+	{
+		return false;
+	}
+	Callback callback;
+	callback.swap(slot.callback);
+	std::shared_ptr<Statistics> statistics;
+	statistics.swap(slot.statistics);
+	std::shared_ptr<Session> peer;
+	peer.swap(slot.peer);
+	const uint64_t elapsed = Timer::Now<std::chrono::microseconds>() - slot.start_time;
+	slot.closed.store(msg_seq, std::memory_order_relaxed);
+	slot.state.store(EMPTY, std::memory_order_release);
+
+	statistics->OnComplete(error_code, elapsed);
+	if(nullptr != peer)
+	{
+		peer->outstanding.fetch_sub(1, std::memory_order_relaxed);
+	}
+	if(ErrorCode::ResponseTimeoutError == error_code)
+	{
+		LOG_RATE(10, 100, GAMNET_WRN, "[Router] call timeout(destination:", statistics->name, ", msg_seq:", msg_seq, ")");
+	}
+	try {
+		callback(error_code, packet);
+	}
+	catch (const std::exception& e)
+	{
+		LOG(GAMNET_ERR, "unhandled exception occurred(reason:", e.what(), ")");
+	}
+	return true;
+}
+
+void CallManager::Call(const Address& addr, const std::shared_ptr<Network::Tcp::Packet>& envelope, uint32_t msg_id, int timeout, const Callback& callback)
+{
+	RouterCaster& caster = Singleton<RouterCaster>::GetInstance();
+	// server is selected before send, so the answer is matched to it and any-cast policy sees the call as outstanding
+	std::shared_ptr<Session> peer;
+	if(ROUTER_CAST_TYPE::MULTI_CAST != addr.cast_type)
+	{
+		peer = caster.Select(addr);
+		if(nullptr == peer)
+		{
+			callback(ErrorCode::SendMsgFailError, nullptr);
+			return;
+		}
+	}
+	const uint32_t msg_seq = Register(addr, peer, msg_id, timeout, callback);
+	if(0 == msg_seq)
+	{
+		LOG_RATE(10, 100, GAMNET_ERR, "[Router] too many calls in flight(slot_count:", (int)SLOT_COUNT, ")");
+		callback(ErrorCode::BufferOverflowError, nullptr);
+		return;
+	}
+	if(nullptr != peer)
+	{
+		envelope->SetSEQ(msg_seq);
+		if(false == peer->BatchSend(envelope, addr.key))
+		{
+			Complete(msg_seq, ErrorCode::SendMsgFailError, nullptr);
+		}
+		return;
+	}
+	Address call_addr = addr;
+	call_addr.msg_seq = msg_seq;
+	if(false == caster.SendMsg(nullptr, call_addr, envelope))
+	{
+		Complete(msg_seq, ErrorCode::SendMsgFailError, nullptr);
+	}
+}
+
+bool CallManager::OnRecvMsg(const Address& from, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	const uint32_t msg_seq = (uint32_t)from.msg_seq;
+	if(0 == (CALL_SEQ & msg_seq))
+	{
+		return false;
+	}
+	const Slot& slot = slots_[msg_seq % SLOT_COUNT];
+	const bool pending = ((PENDING | msg_seq) == slot.state.load(std::memory_order_acquire));
+	if(false == pending && msg_seq != slot.closed.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	// request of the remote server may have the same msg_seq by chance. only the expected answer of the called server completes it
+	if(packet->GetID() != slot.msg_id.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	const uint32_t id = slot.id.load(std::memory_order_relaxed);
+	if((0 != id && from.id != id) || std::hash<std::string>()(from.service_name) != slot.service_hash.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	if(true == pending && true == Complete(msg_seq, ErrorCode::Success, packet))
+	{
+		return true;
+	}
+	// timeout or another server of multi-cast won. the callback was called already, so no handler gets it either
+	LOG_EVERY(10, 1000, GAMNET_WRN, "[Router] drop late answer(service_name:", from.service_name, ", id:", from.id, ", msg_seq:", msg_seq, ", msg_id:", packet->GetID(), ")");
+	return true;
+}
+
+Json::Value CallManager::State()
+{
+	Json::Value root;
+	Json::Value destinations(Json::arrayValue);
+	int64_t in_flight = 0;
+	std::lock_guard<std::mutex> lo(lock_);
+	for(auto& itr : statistics_)
+	{
+		in_flight += itr.second->in_flight.load(std::memory_order_relaxed);
+		destinations.append(itr.second->State());
+	}
+	root["in_flight"] = (Json::Int64)in_flight;
+	root["destination"] = destinations;
+	return root;
+}
+
+}}}
@@ -0,0 +1,108 @@
+#ifndef GAMNET_NETWORK_ROUTER_CALLMANAGER_H_
+#define GAMNET_NETWORK_ROUTER_CALLMANAGER_H_
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "Session.h"
+#include "../Tcp/Packet.h"
+#include "../../Library/Json/json.h"
+#include "../../Library/Timer.h"
+#include "../../Library/TimingWheel.h"
+
+namespace Gamnet { namespace Network { namespace Router {
+
+/*!
+ * \brief correlation table of 'Router::Call'
+ *
+ * 		request and answer are matched by router msg_seq. a call claims a free slot by compare and swap and its msg_seq
+ * 		is (CALL_SEQ | generation of the slot | index of the slot), so calls don't take the sequence of 'RouterCaster::SendMsg'
+ * 		and a slot is full only while its own call is pending. answer and timeout race on the slot without lock and
+ * 		exactly one of them wins. timeouts are kept in a timing wheel and an expired entry of an answered call is ignored.
+ */
+class CallManager
+{
+public :
+	typedef std::function<void(int error_code, const std::shared_ptr<Network::Tcp::Packet>& packet)> Callback;
+	enum {
+		SLOT_BITS = 16,
+		SLOT_COUNT = 1 << SLOT_BITS, // calls in flight at the same time
+		TICK_INTERVAL = 10, // ms
+		WHEEL_SIZE = 1024,
+		LATENCY_BUCKET_COUNT = 16 // under 1, 2, 4 ... 16384 ms and over
+	};
+private :
+	struct Statistics
+	{
+		std::string name;
+		std::atomic<int64_t> in_flight;
+		std::atomic<uint64_t> call_count;
+		std::atomic<uint64_t> error_count;
+		std::atomic<uint64_t> timeout_count;
+		std::atomic<uint64_t> latency[LATENCY_BUCKET_COUNT];
+
+		Statistics(const std::string& name);
+		void OnComplete(int error_code, uint64_t elapsed);
+		Json::Value State() const;
+	};
+
+	struct Slot
+	{
+		// EMPTY, LOCKED while owner writes or reads the fields below, or (PENDING | msg_seq)
+		std::atomic<uint64_t> state;
+		// read by receiver before claim. compared again by 'state' after claim
+		std::atomic<uint32_t> msg_id;
+		std::atomic<uint32_t> id; // 0 for any server of the service
+		std::atomic<size_t> service_hash;
+		uint32_t generation; // changed on each claim, so answer of the previous call in this slot doesn't match
+		std::atomic<uint32_t> closed; // msg_seq of the last completed call. its late answers are dropped, not dispatched
+		uint64_t start_time;
+		Callback callback;
+		std::shared_ptr<Statistics> statistics;
+		std::shared_ptr<Session> peer; // server selected for uni-cast and any-cast. counts it as outstanding
+
+		Slot();
+	};
+
+	static const uint64_t EMPTY = 0;
+	static const uint64_t PENDING = (uint64_t)1 << 32;
+	static const uint64_t LOCKED = (uint64_t)1 << 33;
+
+	std::unique_ptr<Slot[]> slots_;
+	std::atomic<uint32_t> next_slot_; // where search for a free slot starts
+	TimingWheel<uint32_t> wheel_;
+	Timer timer_;
+	std::mutex lock_;
+	std::map<std::string, std::shared_ptr<Statistics>> statistics_;
+	static std::atomic<CallManager*> instance_;
+
+	std::shared_ptr<Statistics> GetStatistics(const Address& addr);
+	// 0 if every slot is pending
+	uint32_t Register(const Address& addr, const std::shared_ptr<Session>& peer, uint32_t msg_id, int timeout, const Callback& callback);
+	bool Complete(uint32_t msg_seq, int error_code, const std::shared_ptr<Network::Tcp::Packet>& packet);
+public :
+	// top bit of msg_seq of calls. RouterCaster::SendMsg doesn't use it
+	static const uint32_t CALL_SEQ = (uint32_t)1 << 31;
+
+	CallManager();
+	~CallManager();
+
+	/*!
+	 * \brief sends 'envelope' written by 'Packet::WriteEnvelope' and waits for a message of 'msg_id'
+	 * \param timeout ms(1/1000 sec)
+	 * \param callback called once with the answer, or with ResponseTimeoutError, SendMsgFailError or BufferOverflowError(too many calls in flight) and null packet.
+	 * 		send failure calls it before return
+	 */
+	void Call(const Address& addr, const std::shared_ptr<Network::Tcp::Packet>& envelope, uint32_t msg_id, int timeout, const Callback& callback);
+	// true if 'packet' is an answer of a call, pending or late. called by Dispatcher for router messages with CALL_SEQ
+	bool OnRecvMsg(const Address& from, const std::shared_ptr<Network::Tcp::Packet>& packet);
+	// null until the first 'Router::Call'. unlike 'Singleton<CallManager>::GetInstance', doesn't create the slots and the timer
+	static CallManager* Find();
+
+	Json::Value State();
+};
+
+}}}
+#endif
@@ -10,6 +10,7 @@
 
 #include "../Tcp/Tcp.h"
 #include "MsgRouter.h"
+#include "CallManager.h"
 
 namespace Gamnet { namespace Network { namespace Router {
 
@@ -42,11 +43,21 @@ public:
 
 	void OnRecvMsg(const Address& from, const std::shared_ptr<Network::Tcp::Packet>& packet)
 	{
+		if(0 != (CallManager::CALL_SEQ & from.msg_seq))
+		{
+			// no CallManager yet means this server made no call, so it is a request of a remote call
+			CallManager* callManager = CallManager::Find();
+			if(nullptr != callManager && true == callManager->OnRecvMsg(from, packet))
+			{
+				return;
+			}
+		}
+
 		const unsigned int msg_id = packet->GetID();
 		auto itr = mapHandlerFunction_.find(msg_id);
 		if(itr == mapHandlerFunction_.end())
 		{
-			LOG(GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ")");
+			LOG_RATE(10, 100, GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ")");
 			return ;
 		}
 
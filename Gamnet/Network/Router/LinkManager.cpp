@@ -1,6 +1,13 @@
 #include "LinkManager.h"
 #include "RouterHandler.h"
+#include "RouterCaster.h"
 #include "../Tcp/Tcp.h"
+#include "../../Library/Random.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
 
 namespace Gamnet { namespace Network { namespace Router {
 
@@ -8,12 +15,48 @@ std::function<void(const Address& addr)> LinkManager::onRouterAccept = [](const
 std::function<void(const Address& addr)> LinkManager::onRouterClose = [](const Address&) {};
 std::mutex LinkManager::lock;
 
-LinkManager::LinkManager()
+// user + system time of this process in us
+static uint64_t GetProcessCpuTime()
+{
+#ifdef _WIN32
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	if(FALSE == GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+	{
+		return 0;
+	}
+	const uint64_t kernel = ((uint64_t)kernel_time.dwHighDateTime << 32) | kernel_time.dwLowDateTime;
+	const uint64_t user = ((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+	return (kernel + user) / 10;
+#else
+	struct rusage usage;
+	if(0 != getrusage(RUSAGE_SELF, &usage))
+	{
+		return 0;
+	}
+	return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+}
+
+LinkManager::LinkManager() : _cpu_time(GetProcessCpuTime()), _wall_time(Timer::Now<std::chrono::microseconds>()), weight(Session::DEFAULT_WEIGHT), heartbeat_interval(HEARTBEAT_INTERVAL), suspect_threshold(8.0), batch_size(DEFAULT_BATCH_SIZE), batch_delay(0), link_count(1), shm_size(0), onReportLoad([](ServerLoad&) {})
 {
 	name = "Gamnet::Network::Router::LinkManager";
 	_cast_group = Tcp::CastGroup::Create();
 }
 
+uint32_t LinkManager::GetCpuUsage()
+{
+	const uint64_t cpu_time = GetProcessCpuTime();
+	const uint64_t wall_time = Timer::Now<std::chrono::microseconds>();
+	uint32_t usage = 0;
+	if(_wall_time < wall_time && _cpu_time <= cpu_time)
+	{
+		usage = (uint32_t)((cpu_time - _cpu_time) * 100 / (wall_time - _wall_time));
+	}
+	_cpu_time = cpu_time;
+	_wall_time = wall_time;
+	return usage;
+}
+
 LinkManager::~LinkManager() {
 }
 
@@ -27,6 +70,11 @@ void LinkManager::Listen(const char* service_name, int port, const std::function
 	RegisterHandler(MsgRouter_SetAddress_Ntf::MSG_ID,	"MsgRouter_SetAddress_Ntf", &RouterHandler::Recv_SetAddress_Ntf, new Network::HandlerStatic<RouterHandler>());
 	RegisterHandler(MsgRouter_SendMsg_Ntf::MSG_ID,		"MsgRouter_SendMsg_Ntf", &RouterHandler::Recv_SendMsg_Ntf, new Network::HandlerStatic<RouterHandler>());
 	RegisterHandler(MsgRouter_HeartBeat_Ntf::MSG_ID,	"MsgRouter_HeartBeat_Ntf", &RouterHandler::Recv_HeartBeat_Ntf, new Network::HandlerStatic<RouterHandler>());
+	RegisterHandler(MsgRouter_Envelope_Ntf::MSG_ID,	"MsgRouter_Envelope_Ntf", &RouterHandler::Recv_Envelope_Ntf, new Network::HandlerStatic<RouterHandler>());
+	RegisterHandler(MsgRouter_JoinLink_Ntf::MSG_ID,	"MsgRouter_JoinLink_Ntf", &RouterHandler::Recv_JoinLink_Ntf, new Network::HandlerStatic<RouterHandler>());
+	RegisterHandler(MsgRouter_ShmLink_Req::MSG_ID,	"MsgRouter_ShmLink_Req", &RouterHandler::Recv_ShmLink_Req, new Network::HandlerStatic<RouterHandler>());
+	RegisterHandler(MsgRouter_ShmLink_Ans::MSG_ID,	"MsgRouter_ShmLink_Ans", &RouterHandler::Recv_ShmLink_Ans, new Network::HandlerStatic<RouterHandler>());
+	RegisterHandler(MsgRouter_ShmLink_Ntf::MSG_ID,	"MsgRouter_ShmLink_Ntf", &RouterHandler::Recv_ShmLink_Ntf, new Network::HandlerStatic<RouterHandler>());
 	local_address.service_name = service_name;
 	local_address.cast_type = ROUTER_CAST_TYPE::UNI_CAST;
 	local_address.id = Network::Tcp::GetLocalAddress().to_v4().to_ulong();
@@ -35,14 +83,38 @@ void LinkManager::Listen(const char* service_name, int port, const std::function
 		throw GAMNET_EXCEPTION(ErrorCode::InvalidAddressError, "unique router id is not set");
 	}
 
+	// messages to this server are dispatched in process, without a link to itself
+	local_session = std::make_shared<LocalSession>();
+	if(false == local_session->Init())
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::InvalidSessionError, "can not init local router session");
+	}
+	local_session->OnCreate();
+	if(false == Singleton<RouterCaster>::GetInstance().RegisterLocalAddress(local_address, local_session))
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::InvalidAddressError, "can not register local router address(service_name:", local_address.service_name, ", id:", local_address.id, ")");
+	}
+
 	_heartbeat_timer.AutoReset(true);
-	_heartbeat_timer.SetTimer(60000, [this] () {
+	_heartbeat_timer.SetTimer(heartbeat_interval, [this] () {
 		std::shared_ptr<Tcp::Packet> packet = Tcp::Packet::Create();
 		if(nullptr != packet) {
 			MsgRouter_HeartBeat_Ntf ntf;
+			try {
+				onReportLoad(ntf.load);
+			}
+			catch (const std::exception& e)
+			{
+				LOG(GAMNET_ERR, "unhandled exception occurred(reason:", e.what(), ")");
+			}
+			ntf.load.cpu = GetCpuUsage();
+			ntf.load.weight = weight;
+			ntf.interval = heartbeat_interval;
+			local_session->SetLoad(ntf.load);
 			_cast_group->SendMsg(ntf);
-			LOG(GAMNET_INF, "[Router] send heartbeat message(link count:", _cast_group->Size(), ")");
+			LOG(DEV, "[Router] send heartbeat message(link count:", _cast_group->Size(), ", cpu:", ntf.load.cpu, ", session_count:", ntf.load.session_count, ", queue_depth:", ntf.load.queue_depth, ")");
 		}
+		Singleton<RouterCaster>::GetInstance().DetectFailure(Timer::Now(), suspect_threshold);
 	});
 
 	session_manager.Init(0);
@@ -50,6 +122,22 @@ void LinkManager::Listen(const char* service_name, int port, const std::function
 }
 
 void LinkManager::Connect(const char* host, int port, int timeout, const std::function<void(const Address& addr)>& onConnect, const std::function<void(const Address& addr)>& onClose)
+{
+	if(nullptr == host)
+	{
+		throw GAMNET_EXCEPTION(ErrorCode::NullPointerError, "invalid host name");
+	}
+	std::shared_ptr<Connector> connector = std::make_shared<Connector>();
+	connector->host = host;
+	connector->port = port;
+	connector->timeout = timeout;
+	connector->link_count = std::max(1u, std::min((uint32_t)link_count, (uint32_t)Session::MAX_LINK_COUNT));
+	connector->onConnect = onConnect;
+	connector->onClose = onClose;
+	Connect(connector, nullptr, 0, 0);
+}
+
+void LinkManager::Connect(const std::shared_ptr<Connector>& connector, const std::shared_ptr<Session>& primary, uint32_t link_index, uint32_t retry_count)
 {
 	std::shared_ptr<Network::Link> link = Create();
 	if(nullptr == link)
@@ -64,15 +152,24 @@ void LinkManager::Connect(const char* host, int port, int timeout, const std::fu
 	}
 
 	link->session = session;
-	session->onRouterConnect = onConnect;
-	session->onRouterClose = onClose;
+	session->onRouterConnect = connector->onConnect;
+	session->onRouterClose = connector->onClose;
 
 	session_manager.Add(session->session_key, session);
 
-	session->strand.wrap([session, link] () {
+	session->strand.wrap([session, link, connector, primary, link_index, retry_count] () {
 		try {
 			session->OnCreate();
 			session->AttachLink(link);
+			session->connector = connector;
+			session->link_count = connector->link_count;
+			session->link_index = link_index;
+			session->retry_count = retry_count;
+			if(nullptr != primary)
+			{
+				session->primary = primary;
+				session->address = primary->address;
+			}
 		}
 		catch (const Exception& e)
 		{
@@ -80,7 +177,110 @@ void LinkManager::Connect(const char* host, int port, int timeout, const std::fu
 		}
 	})();
 	
-	link->Connect(host, port, timeout);
+	try {
+		link->Connect(connector->host.c_str(), connector->port, connector->timeout);
+	}
+	catch (const std::exception&)
+	{
+		session_manager.Remove(session->session_key);
+		throw;
+	}
+}
+
+void LinkManager::ConnectLanes(const std::shared_ptr<Session>& session)
+{
+	if(nullptr == session->connector)
+	{
+		return;
+	}
+	for(uint32_t link_index=1; link_index<session->connector->link_count; link_index++)
+	{
+		try {
+			Connect(session->connector, session, link_index, 0);
+		}
+		catch (const std::exception& e)
+		{
+			LOG(GAMNET_ERR, "[Router] can not open link(host:", session->connector->host, ", link_index:", link_index, ", reason:", e.what(), ")");
+		}
+	}
+}
+
+bool LinkManager::OfferShmLink(const std::shared_ptr<Session>& session)
+{
+	// router id is the address of the host, so servers of the same host have the same id
+	if(0 == shm_size || nullptr == session->connector || local_address.id != session->address.id || 0 == (session->features & Session::FEATURE_SHM_LINK))
+	{
+		return false;
+	}
+	std::shared_ptr<ShmLink> shm = ShmLink::Create(shm_size);
+	if(nullptr == shm)
+	{
+		return false;
+	}
+	session->OfferShmLink(shm);
+	MsgRouter_ShmLink_Req req;
+	req.name = shm->GetName();
+	req.size = shm->GetSize();
+	Network::Tcp::SendMsg(session, req);
+	LOG(GAMNET_INF, "[Router] send ShmLink_Req (localhost->", session->remote_address->to_string(), ", service_name:", session->address.service_name, ", name:", req.name, ", size:", req.size, ")");
+	return true;
+}
+
+int64_t LinkManager::ReconnectDelay(uint32_t retry_count)
+{
+	const int64_t delay = std::min((int64_t)RECONNECT_MAX_DELAY, (int64_t)RECONNECT_MIN_DELAY << std::min(retry_count, 16u));
+	// half fixed and half random, so servers dropped together don't come back together
+	return Random::Range(delay / 2, delay);
+}
+
+// called on strand of closed session. connected link is opened again after exponential backoff with jitter
+void LinkManager::Reconnect(const std::shared_ptr<Session>& session, int reason)
+{
+	// refused by the remote. same address would be refused again
+	if(nullptr == session->connector || ErrorCode::InvalidAddressError == reason)
+	{
+		return;
+	}
+	std::shared_ptr<Session> primary = session->primary.lock();
+	if(0 != session->link_index && nullptr == primary)
+	{
+		return;
+	}
+
+	Reconnect(session->connector, primary, session->link_index, session->retry_count);
+}
+
+void LinkManager::Reconnect(const std::shared_ptr<Connector>& connector, const std::shared_ptr<Session>& primary, uint32_t link_index, uint32_t retry_count)
+{
+	const int64_t jitter_delay = ReconnectDelay(retry_count);
+	LOG(GAMNET_WRN, "[Router] reconnect after ", jitter_delay, "ms(host:", connector->host, ", port:", connector->port, ", link_index:", link_index, ", retry_count:", retry_count, ")");
+
+	std::weak_ptr<Session> weak = primary;
+	std::shared_ptr<boost::asio::deadline_timer> timer = std::make_shared<boost::asio::deadline_timer>(Singleton<boost::asio::io_service>::GetInstance());
+	timer->expires_from_now(boost::posix_time::milliseconds(jitter_delay));
+	timer->async_wait([this, timer, connector, link_index, retry_count, weak](const boost::system::error_code& ec) {
+		if(0 != ec)
+		{
+			return;
+		}
+		std::shared_ptr<Session> primary = weak.lock();
+		if(0 != link_index)
+		{
+			// lane lives only while the first link is registered. its reconnect opens lanes again
+			if(nullptr == primary || primary != Singleton<RouterCaster>::GetInstance().FindSession(primary->address))
+			{
+				return;
+			}
+		}
+		try {
+			Connect(connector, primary, link_index, retry_count + 1);
+		}
+		catch (const std::exception& e)
+		{
+			LOG(GAMNET_ERR, "[Router] reconnect fail(host:", connector->host, ", port:", connector->port, ", reason:", e.what(), ")");
+			Reconnect(connector, primary, link_index, retry_count + 1);
+		}
+	});
 }
 
 void LinkManager::OnConnect(const std::shared_ptr<Network::Link>& link)
@@ -139,9 +339,10 @@ void LinkManager::OnClose(const std::shared_ptr<Network::Link>& link, int reason
 		return;
 	}
 
-	session->strand.wrap([session, reason]() {
+	session->strand.wrap([this, session, reason]() {
 		try {
 			session->OnClose(reason);
+			Reconnect(session, reason);
 			session->AttachLink(nullptr);
 			session->OnDestroy();
 		}
@@ -184,6 +385,10 @@ Json::Value LinkManager::State()
 	session["idle_count"] = (unsigned int)session_pool.Available();
 	session["active_count"] = (unsigned int)session_manager.Size();
 	root["session"] = session;
+	root["link_count"] = (unsigned int)link_count;
+	root["heartbeat_interval"] = (int)heartbeat_interval;
+	root["suspect_threshold"] = (double)suspect_threshold;
+	root["shm_size"] = (unsigned int)shm_size;
 	return root;
 }
 }}}
@@ -11,10 +11,39 @@
 namespace Gamnet { namespace Network { namespace Router {
 
 struct LinkManager : public Tcp::LinkManager<Session> {
+	enum {
+		HEARTBEAT_INTERVAL = 5000, // ms. default. heartbeat carries load for any-cast policies and feeds failure detector
+		DEFAULT_BATCH_SIZE = 16384,
+		RECONNECT_MIN_DELAY = 100, // ms. doubled on each failure with jitter
+		RECONNECT_MAX_DELAY = 30000,
+		DEFAULT_SHM_SIZE = 4 * 1024 * 1024 // bytes of each direction
+	};
 	Timer _heartbeat_timer;
 	std::shared_ptr<Tcp::CastGroup> _cast_group;
+	uint64_t _cpu_time; // us
+	uint64_t _wall_time; // us
+
+	uint32_t GetCpuUsage();
+	void Connect(const std::shared_ptr<Connector>& connector, const std::shared_ptr<Session>& primary, uint32_t link_index, uint32_t retry_count);
+	void Reconnect(const std::shared_ptr<Session>& session, int reason);
+	void Reconnect(const std::shared_ptr<Connector>& connector, const std::shared_ptr<Session>& primary, uint32_t link_index, uint32_t retry_count);
 public :
 	Address local_address;
+	// this server in routing table. registered by Listen
+	std::shared_ptr<Session> local_session;
+	std::atomic<uint32_t> weight;
+	std::atomic<int> heartbeat_interval;
+	// phi of late heartbeat to suspect the server. see FailureDetector
+	std::atomic<double> suspect_threshold;
+	// see Session::BatchSend. size 0 sends each frame by itself
+	std::atomic<size_t> batch_size;
+	std::atomic<int> batch_delay;
+	// links opened by each 'Connect'. see Session::BatchSend
+	std::atomic<uint32_t> link_count;
+	// shared memory ring size for servers on the same host. 0 keeps tcp. see ShmLink
+	std::atomic<uint32_t> shm_size;
+	// fills session count and queue depth of this server for heartbeat. cpu and weight are filled by router
+	std::function<void(ServerLoad& load)> onReportLoad;
 	static std::mutex lock;
 	static std::function<void(const Address& addr)> onRouterAccept;
 	static std::function<void(const Address& addr)> onRouterClose;
@@ -25,6 +54,15 @@ public :
 	void Listen(const char* service_name, int port, const std::function<void(const Address& addr)>& onAccept, const std::function<void(const Address& addr)>& onClose, int accept_queue_size = 5);
 	using Network::LinkManager::Connect;
 	void Connect(const char* host, int port, int timeout, const std::function<void(const Address& addr)>& onConnect, const std::function<void(const Address& addr)>& onClose);
+	/*!
+	 * \brief ms to wait before connecting again after 'retry_count' failures in a row. 'retry_count' is reset to 0 by a successful connect.
+	 * 		random in [delay / 2, delay] of delay = RECONNECT_MIN_DELAY * 2^retry_count, up to RECONNECT_MAX_DELAY
+	 */
+	static int64_t ReconnectDelay(uint32_t retry_count);
+	// opens lanes of connected session after its address is registered
+	void ConnectLanes(const std::shared_ptr<Session>& session);
+	// offers shared memory to connected session of a server on the same host. false if not offered
+	bool OfferShmLink(const std::shared_ptr<Session>& session);
 	
 	virtual void OnAccept(const std::shared_ptr<Network::Link>& link) override;
 	virtual void OnConnect(const std::shared_ptr<Network::Link>& link) override;
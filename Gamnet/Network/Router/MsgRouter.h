@@ -14,6 +14,7 @@ struct ROUTER_CAST_TYPE {
 			UNI_CAST,
 			MULTI_CAST,
 			ANY_CAST,
+			HASH_CAST,
 			MAX,
 	};
 	TYPE type;
@@ -58,9 +59,11 @@ struct Address {
 	ROUTER_CAST_TYPE	cast_type;
 	uint32_t	id;
 	uint64_t	msg_seq;
+	uint64_t	key; // HASH_CAST only. not serialized, so the wire format is the same as of routers without hash-cast
 	Address()	{
 		id = 0;
 		msg_seq = 0;
+		key = 0;
 	}
 	size_t Size() const {
 		size_t nSize = 0;
@@ -112,6 +115,103 @@ struct Address_Serializer {
 	static bool Load(Address& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
 	static size_t Size(const Address& obj) { return obj.Size(); }
 };
+struct ServerLoad {
+	uint32_t	cpu;
+	uint32_t	session_count;
+	uint32_t	queue_depth;
+	uint32_t	weight;
+	ServerLoad()	{
+		cpu = 0;
+		session_count = 0;
+		queue_depth = 0;
+		weight = 0;
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		nSize += sizeof(uint32_t);
+		nSize += sizeof(uint32_t);
+		nSize += sizeof(uint32_t);
+		nSize += sizeof(uint32_t);
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		std::memcpy(*_buf_, &cpu, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		std::memcpy(*_buf_, &session_count, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		std::memcpy(*_buf_, &queue_depth, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		std::memcpy(*_buf_, &weight, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&cpu, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&session_count, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&queue_depth, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&weight, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		return true;
+	}
+}; //ServerLoad
+struct ServerLoad_Serializer {
+	static bool Store(char** _buf_, const ServerLoad& obj) { return obj.Store(_buf_); }
+	static bool Load(ServerLoad& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const ServerLoad& obj) { return obj.Size(); }
+};
+struct Handshake {
+	uint32_t	features;
+	Handshake()	{
+		features = 0;
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		nSize += sizeof(uint32_t);
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		std::memcpy(*_buf_, &features, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&features, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		return true;
+	}
+}; //Handshake
+struct Handshake_Serializer {
+	static bool Store(char** _buf_, const Handshake& obj) { return obj.Store(_buf_); }
+	static bool Load(Handshake& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const Handshake& obj) { return obj.Size(); }
+};
 
 inline bool operator < (const Address& lhs, const Address& rhs)
 {
@@ -329,10 +429,15 @@ struct MsgRouter_SendMsg_Ntf_Serializer {
 };
 struct MsgRouter_HeartBeat_Ntf {
 	enum { MSG_ID = 5 }; 
+	ServerLoad	load;
+	uint32_t	interval;
 	MsgRouter_HeartBeat_Ntf()	{
+		interval = 0;
 	}
 	size_t Size() const {
 		size_t nSize = 0;
+		nSize += ServerLoad_Serializer::Size(load);
+		nSize += sizeof(uint32_t);
 		return nSize;
 	}
 	bool Store(std::vector<char>& _buf_) const {
@@ -346,6 +451,8 @@ struct MsgRouter_HeartBeat_Ntf {
 		return true;
 	}
 	bool Store(char** _buf_) const {
+		if(false == ServerLoad_Serializer::Store(_buf_, load)) { return false; }
+		std::memcpy(*_buf_, &interval, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
 		return true;
 	}
 	bool Load(const std::vector<char>& _buf_) {
@@ -356,6 +463,8 @@ struct MsgRouter_HeartBeat_Ntf {
 		return true;
 	}
 	bool Load(const char** _buf_, size_t& nSize) {
+		if(false == ServerLoad_Serializer::Load(load, _buf_, nSize)) { return false; }
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&interval, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
 		return true;
 	}
 }; //MsgRouter_HeartBeat_Ntf
@@ -364,6 +473,224 @@ struct MsgRouter_HeartBeat_Ntf_Serializer {
 	static bool Load(MsgRouter_HeartBeat_Ntf& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
 	static size_t Size(const MsgRouter_HeartBeat_Ntf& obj) { return obj.Size(); }
 };
+struct MsgRouter_Envelope_Ntf {
+	enum { MSG_ID = 6 }; 
+	MsgRouter_Envelope_Ntf()	{
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		return true;
+	}
+}; //MsgRouter_Envelope_Ntf
+struct MsgRouter_Envelope_Ntf_Serializer {
+	static bool Store(char** _buf_, const MsgRouter_Envelope_Ntf& obj) { return obj.Store(_buf_); }
+	static bool Load(MsgRouter_Envelope_Ntf& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const MsgRouter_Envelope_Ntf& obj) { return obj.Size(); }
+};
+struct MsgRouter_JoinLink_Ntf {
+	enum { MSG_ID = 7 }; 
+	Address	local_address;
+	uint32_t	link_index;
+	uint32_t	link_count;
+	MsgRouter_JoinLink_Ntf()	{
+		link_index = 0;
+		link_count = 0;
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		nSize += Address_Serializer::Size(local_address);
+		nSize += sizeof(uint32_t);
+		nSize += sizeof(uint32_t);
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		if(false == Address_Serializer::Store(_buf_, local_address)) { return false; }
+		std::memcpy(*_buf_, &link_index, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		std::memcpy(*_buf_, &link_count, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		if(false == Address_Serializer::Load(local_address, _buf_, nSize)) { return false; }
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&link_index, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&link_count, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		return true;
+	}
+}; //MsgRouter_JoinLink_Ntf
+struct MsgRouter_JoinLink_Ntf_Serializer {
+	static bool Store(char** _buf_, const MsgRouter_JoinLink_Ntf& obj) { return obj.Store(_buf_); }
+	static bool Load(MsgRouter_JoinLink_Ntf& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const MsgRouter_JoinLink_Ntf& obj) { return obj.Size(); }
+};
+struct MsgRouter_ShmLink_Req {
+	enum { MSG_ID = 8 }; 
+	std::string	name;
+	uint32_t	size;
+	MsgRouter_ShmLink_Req()	{
+		size = 0;
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		nSize += sizeof(uint32_t); nSize += name.length();
+		nSize += sizeof(uint32_t);
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		size_t name_size = name.length();
+		std::memcpy(*_buf_, &name_size, sizeof(int32_t)); (*_buf_) += sizeof(int32_t);
+		std::memcpy(*_buf_, name.c_str(), name.length()); (*_buf_) += name.length();
+		std::memcpy(*_buf_, &size, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t);
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		if(sizeof(int32_t) > nSize) { return false; }
+		uint32_t name_length = 0; std::memcpy(&name_length, *_buf_, sizeof(uint32_t)); (*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		if(nSize < name_length) { return false; }
+		name.assign((char*)*_buf_, name_length); (*_buf_) += name_length; nSize -= name_length;
+		if(sizeof(uint32_t) > nSize) { return false; }	std::memcpy(&size, *_buf_, sizeof(uint32_t));	(*_buf_) += sizeof(uint32_t); nSize -= sizeof(uint32_t);
+		return true;
+	}
+}; //MsgRouter_ShmLink_Req
+struct MsgRouter_ShmLink_Req_Serializer {
+	static bool Store(char** _buf_, const MsgRouter_ShmLink_Req& obj) { return obj.Store(_buf_); }
+	static bool Load(MsgRouter_ShmLink_Req& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const MsgRouter_ShmLink_Req& obj) { return obj.Size(); }
+};
+struct MsgRouter_ShmLink_Ans {
+	enum { MSG_ID = 9 }; 
+	int32_t	error_code;
+	MsgRouter_ShmLink_Ans()	{
+		error_code = 0;
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		nSize += sizeof(int32_t);
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		std::memcpy(*_buf_, &error_code, sizeof(int32_t)); (*_buf_) += sizeof(int32_t);
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		if(sizeof(int32_t) > nSize) { return false; }	std::memcpy(&error_code, *_buf_, sizeof(int32_t));	(*_buf_) += sizeof(int32_t); nSize -= sizeof(int32_t);
+		return true;
+	}
+}; //MsgRouter_ShmLink_Ans
+struct MsgRouter_ShmLink_Ans_Serializer {
+	static bool Store(char** _buf_, const MsgRouter_ShmLink_Ans& obj) { return obj.Store(_buf_); }
+	static bool Load(MsgRouter_ShmLink_Ans& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const MsgRouter_ShmLink_Ans& obj) { return obj.Size(); }
+};
+struct MsgRouter_ShmLink_Ntf {
+	enum { MSG_ID = 10 }; 
+	MsgRouter_ShmLink_Ntf()	{
+	}
+	size_t Size() const {
+		size_t nSize = 0;
+		return nSize;
+	}
+	bool Store(std::vector<char>& _buf_) const {
+		size_t nSize = Size();
+ 		if(0 == nSize) { return true; }
+		if(nSize > _buf_.size()) { 
+			_buf_.resize(nSize);
+		}
+		char* pBuf = &(_buf_[0]);
+		if(false == Store(&pBuf)) return false;
+		return true;
+	}
+	bool Store(char** _buf_) const {
+		return true;
+	}
+	bool Load(const std::vector<char>& _buf_) {
+		size_t nSize = _buf_.size();
+ 		if(0 == nSize) { return true; }
+		const char* pBuf = &(_buf_[0]);
+		if(false == Load(&pBuf, nSize)) return false;
+		return true;
+	}
+	bool Load(const char** _buf_, size_t& nSize) {
+		return true;
+	}
+}; //MsgRouter_ShmLink_Ntf
+struct MsgRouter_ShmLink_Ntf_Serializer {
+	static bool Store(char** _buf_, const MsgRouter_ShmLink_Ntf& obj) { return obj.Store(_buf_); }
+	static bool Load(MsgRouter_ShmLink_Ntf& obj, const char** _buf_, size_t& nSize) { return obj.Load(_buf_, nSize); }
+	static size_t Size(const MsgRouter_ShmLink_Ntf& obj) { return obj.Size(); }
+};
 
 }}}
 
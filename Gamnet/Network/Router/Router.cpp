@@ -9,6 +9,85 @@ const Address& GetRouterAddress()
 	return Singleton<LinkManager>::GetInstance().local_address;
 }
 
+Json::Value State()
+{
+	Json::Value root;
+	root["link"] = Singleton<LinkManager>::GetInstance().State();
+	// reading state doesn't create CallManager of a server which makes no call
+	CallManager* callManager = CallManager::Find();
+	if(nullptr != callManager)
+	{
+		root["call"] = callManager->State();
+	}
+	else
+	{
+		root["call"]["in_flight"] = 0;
+		root["call"]["destination"] = Json::Value(Json::arrayValue);
+	}
+	root["route"] = Singleton<RouterCaster>::GetInstance().State();
+	return root;
+}
+
+void SetAnyCastPolicy(const std::string& service_name, ANY_CAST_POLICY policy)
+{
+	Singleton<RouterCaster>::GetInstance().SetAnyCastPolicy(service_name, policy);
+}
+
+void SetWeight(uint32_t weight)
+{
+	Singleton<LinkManager>::GetInstance().weight = weight;
+}
+
+void SetBatch(size_t size, int delay)
+{
+	Singleton<LinkManager>::GetInstance().batch_size = size;
+	Singleton<LinkManager>::GetInstance().batch_delay = delay;
+}
+
+void SetLinkCount(uint32_t count)
+{
+	Singleton<LinkManager>::GetInstance().link_count = count;
+}
+
+void SetSharedMemory(uint32_t size)
+{
+	Singleton<LinkManager>::GetInstance().shm_size = size;
+}
+
+void SetHeartBeat(int interval, double threshold)
+{
+	Singleton<LinkManager>::GetInstance().heartbeat_interval = interval;
+	Singleton<LinkManager>::GetInstance().suspect_threshold = threshold;
+}
+
+void SetSuspectHandler(const std::function<void(const Address& addr, bool suspected)>& handler)
+{
+	Singleton<RouterCaster>::GetInstance().onSuspect = handler;
+}
+
+void SetLoadReporter(const std::function<void(ServerLoad& load)>& reporter)
+{
+	Singleton<LinkManager>::GetInstance().onReportLoad = reporter;
+}
+
+void SetRebalanceHandler(const std::function<void(const Address& addr, bool join)>& handler)
+{
+	Singleton<RouterCaster>::GetInstance().onRebalance = handler;
+}
+
+bool GetHashOwner(const Address& addr, Address& owner)
+{
+	Address hash_addr = addr;
+	hash_addr.cast_type = ROUTER_CAST_TYPE::HASH_CAST;
+	std::shared_ptr<Session> session = Singleton<RouterCaster>::GetInstance().Select(hash_addr);
+	if(nullptr == session)
+	{
+		return false;
+	}
+	owner = session->address;
+	return true;
+}
+
 void Listen(const char* service_name, int port, const std::function<void(const Address& addr)>& onAccept, const std::function<void(const Address& addr)>& onClose)
 {
 	Singleton<LinkManager>::GetInstance().Listen(service_name, port, onAccept, onClose);
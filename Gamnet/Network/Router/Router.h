@@ -1,13 +1,68 @@
 #ifndef GAMNET_NETWORK_ROUTER_H_
 #define GAMNET_NETWORK_ROUTER_H_
 
+#include <future>
 #include "../Tcp/Tcp.h"
 #include "RouterCaster.h"
 #include "Dispatcher.h"
 #include "LinkManager.h"
+#include "CallManager.h"
 
 namespace Gamnet { namespace Network { namespace Router {
 	const Address& GetRouterAddress();
+	Json::Value State();
+
+	/*!
+	 * \brief how any-cast to 'service_name' picks a server. default is ROUND_ROBIN
+	 */
+	void SetAnyCastPolicy(const std::string& service_name, ANY_CAST_POLICY policy);
+	/*!
+	 * \brief share of this server in WEIGHTED_ROUND_ROBIN of other servers. sent by heartbeat
+	 */
+	void SetWeight(uint32_t weight);
+	/*!
+	 * \brief frames to the same server are written together when they reach 'size' bytes or after 'delay' ms.
+	 * 		delay 0 writes them as soon as the link strand runs. size 0 turns batching off
+	 */
+	void SetBatch(size_t size, int delay);
+	/*!
+	 * \brief links opened by each 'Connect' after this, up to Session::MAX_LINK_COUNT. default 1.
+	 * 		message goes through the link of its Address::key, or of the session key of the sender, so the same key keeps order.
+	 * 		dropped link is connected again with exponential backoff, and its keys go through the first link until then,
+	 * 		so messages sent around the drop may be reordered. remote server should support MsgRouter_JoinLink_Ntf
+	 */
+	void SetLinkCount(uint32_t count);
+	/*!
+	 * \brief frames to a server on the same host go through shared memory rings of 'size' bytes each way, instead of
+	 * 		tcp. tcp link is kept for handshake and heartbeat. 0 turns it off, default. linux only. set before Connect.
+	 * 		both servers should set it. server refusing it is reached by tcp as before
+	 */
+	void SetSharedMemory(uint32_t size);
+	/*!
+	 * \brief heartbeat of this server is sent every 'interval' ms, sub-second is fine. server of which heartbeat is late
+	 * 		over phi 'threshold' is suspected. any-cast and multi-cast skip it until its next heartbeat, unless every server
+	 * 		of the service is suspected. uni-cast and hash-cast still go to it. set before Listen. default 5000 ms and 8.0,
+	 * 		so a dead server is suspected about 12 sec after its last heartbeat. it was 60000 ms before heartbeat fed failure detector
+	 */
+	void SetHeartBeat(int interval, double threshold);
+	/*!
+	 * \brief 'handler' is called when a server is suspected and when it is reinstated. set before Listen
+	 */
+	void SetSuspectHandler(const std::function<void(const Address& addr, bool suspected)>& handler);
+	/*!
+	 * \brief 'reporter' fills session count and queue depth of this server for heartbeat. set before Listen
+	 */
+	void SetLoadReporter(const std::function<void(ServerLoad& load)>& reporter);
+	/*!
+	 * \brief 'handler' is called after a server joined or left the hash ring of its service. state of the keys
+	 * 		now owned by other server is moved by the application. 'GetHashOwner' tells the new owner. set before Listen
+	 */
+	void SetRebalanceHandler(const std::function<void(const Address& addr, bool join)>& handler);
+	/*!
+	 * \brief server which HASH_CAST of 'addr.service_name' and 'addr.key' goes to
+	 * \return false if no server of the service
+	 */
+	bool GetHashOwner(const Address& addr, Address& owner);
 
 	void Listen(const char* service_name, int port, const std::function<void(const Address& addr)>& onAccept = [](const Address&){}, const std::function<void(const Address& addr)>& onClose = [](const Address&) {});
 	void Connect(const char* host, int port, int timeout, const std::function<void(const Address& addr)>& onConnect = [](const Address&) {}, const std::function<void(const Address& addr)>& onClose = [](const Address&) {});
@@ -39,12 +94,13 @@ namespace Gamnet { namespace Network { namespace Router {
 			throw GAMNET_EXCEPTION(ErrorCode::NullPointerError, "fail to create packet instance(session_key:", session->session_key, ", msg_id:", MSG::MSG_ID, ")");
 		}
 
-		if(false == packet->Write(msg_seq, msg))
+		// message is serialized once, right after the envelope header. router seq is filled by RouterCaster
+		if(false == packet->WriteEnvelope(MsgRouter_Envelope_Ntf::MSG_ID, 0, msg_seq, msg))
 		{
 			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "fail to serialize message(session_key:", session->session_key, ", msg_id:", MSG::MSG_ID, ")");
 		}
 
-		return Singleton<RouterCaster>::GetInstance().SendMsg(session, addr, packet->ReadPtr(), (int)packet->Size());
+		return Singleton<RouterCaster>::GetInstance().SendMsg(session, addr, packet);
 	}
 
 	template <class MSG>
@@ -52,6 +108,70 @@ namespace Gamnet { namespace Network { namespace Router {
 	{
 		return SendMsg(nullptr, addr, msg);
 	}
+
+	/*!
+	 * \brief sends 'req' and calls 'callback' with the answer of ANS type
+	 *
+	 *		remote handler replies with 'Router::SendMsg(from, ans)' as usual. 'callback' runs on the thread which received
+	 *		the answer, or on timer thread with ResponseTimeoutError after 'timeout' ms. only the first answer of multi-cast is taken.
+	 * <pre>
+		Gamnet::Network::Router::Call<MsgSvrSvr_GetUser_Req, MsgSvrSvr_GetUser_Ans>(addr, req, 3000, [](int error_code, const MsgSvrSvr_GetUser_Ans& ans) {
+		});
+	 * </pre>
+	 */
+	template <class REQ, class ANS>
+	void Call(const Address& addr, const REQ& req, int timeout, const std::function<void(int error_code, const ANS& ans)>& callback)
+	{
+		std::shared_ptr<Network::Tcp::Packet> packet = Network::Tcp::Packet::Create();
+		if(nullptr == packet)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::NullPointerError, "fail to create packet instance(msg_id:", REQ::MSG_ID, ")");
+		}
+
+		if(false == packet->WriteEnvelope(MsgRouter_Envelope_Ntf::MSG_ID, 0, 0, req))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "fail to serialize message(msg_id:", REQ::MSG_ID, ")");
+		}
+
+		Singleton<CallManager>::GetInstance().Call(addr, packet, ANS::MSG_ID, timeout, [callback](int error_code, const std::shared_ptr<Network::Tcp::Packet>& packet) {
+			ANS ans;
+			if(ErrorCode::Success == error_code && false == Network::Tcp::Packet::Load(ans, packet))
+			{
+				error_code = ErrorCode::MessageFormatError;
+			}
+			callback(error_code, ans);
+		});
+	}
+
+	/*!
+	 * \brief 'callback' runs on the strand of 'session', so it accesses the session like its own message handler
+	 */
+	template <class REQ, class ANS>
+	void Call(const std::shared_ptr<Network::Tcp::Session>& session, const Address& addr, const REQ& req, int timeout, const std::function<void(int error_code, const ANS& ans)>& callback)
+	{
+		Call<REQ, ANS>(addr, req, timeout, std::function<void(int, const ANS&)>([session, callback](int error_code, const ANS& ans) {
+			session->strand.wrap(std::bind(callback, error_code, ans))();
+		}));
+	}
+
+	/*!
+	 * \brief future of the answer. get() throws Exception of ResponseTimeoutError, SendMsgFailError or MessageFormatError.
+	 * 		don't wait for it on io thread which may be the one to receive the answer
+	 */
+	template <class REQ, class ANS>
+	std::future<ANS> Call(const Address& addr, const REQ& req, int timeout)
+	{
+		std::shared_ptr<std::promise<ANS>> promise = std::make_shared<std::promise<ANS>>();
+		Call<REQ, ANS>(addr, req, timeout, std::function<void(int, const ANS&)>([promise](int error_code, const ANS& ans) {
+			if(ErrorCode::Success != error_code)
+			{
+				promise->set_exception(std::make_exception_ptr(GAMNET_EXCEPTION(error_code, "router call fail(msg_id:", REQ::MSG_ID, ", error_code:", error_code, ")")));
+				return;
+			}
+			promise->set_value(ans);
+		}));
+		return promise->get_future();
+	}
 }}}
 
 #define GAMNET_BIND_ROUTER_HANDLER(message_type, class_type, func, policy) \
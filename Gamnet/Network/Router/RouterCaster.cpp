@@ -6,10 +6,27 @@
  */
 
 #include "RouterCaster.h"
+#include "CallManager.h"
 #include "../../Log/Log.h"
+#include "../../Library/Random.h"
 
 namespace Gamnet { namespace Network { namespace Router {
 
+// link of the server which carries the message. same key keeps its order
+static uint64_t LinkKey(const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr)
+{
+	if(0 != addr.key || nullptr == network_session)
+	{
+		return addr.key;
+	}
+	return network_session->session_key;
+}
+
+std::shared_ptr<RouterCasterImpl> RouterCasterImpl_Uni::Clone() const
+{
+	return std::make_shared<RouterCasterImpl_Uni>(*this);
+}
+
 bool RouterCasterImpl_Uni::RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session)
 {
 	if(false == mapRouteTable.insert(std::make_pair(addr, router_session)).second)
@@ -21,7 +38,7 @@ bool RouterCasterImpl_Uni::RegisterAddress(const Address& addr, const std::share
 	return true;
 }
 
-bool RouterCasterImpl_Uni::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len)
+bool RouterCasterImpl_Uni::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const
 {
 	std::shared_ptr<Session> router_session = FindSession(addr);
 	if(NULL == router_session)
@@ -32,7 +49,7 @@ bool RouterCasterImpl_Uni::SendMsg(uint64_t msg_seq, const std::shared_ptr<Netwo
 	{
 		router_session->watingSessionManager_.AddSession(msg_seq, network_session);
 	}
-	router_session->AsyncSend(buf, len);
+	router_session->BatchSend(envelope, LinkKey(network_session, addr));
 	return true;
 }
 
@@ -49,7 +66,12 @@ bool RouterCasterImpl_Uni::UnregisterAddress(const Address& addr)
 	return true;
 }
 
-std::shared_ptr<Session> RouterCasterImpl_Uni::FindSession(const Address& addr)
+std::shared_ptr<Session> RouterCasterImpl_Uni::Select(const Address& addr) const
+{
+	return FindSession(addr);
+}
+
+std::shared_ptr<Session> RouterCasterImpl_Uni::FindSession(const Address& addr) const
 {
 	auto itr = mapRouteTable.find(addr);
 	if(mapRouteTable.end() == itr)
@@ -60,9 +82,23 @@ std::shared_ptr<Session> RouterCasterImpl_Uni::FindSession(const Address& addr)
 	return itr->second;
 }
 
+std::shared_ptr<RouterCasterImpl> RouterCasterImpl_Multi::Clone() const
+{
+	return std::make_shared<RouterCasterImpl_Multi>(*this);
+}
+
 bool RouterCasterImpl_Multi::RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session)
 {
 	SessionList& lstSession = mapRouteTable[addr.service_name];
+	SessionList& lstSuspect = mapSuspect[addr.service_name];
+	for(auto&s : lstSuspect)
+	{
+		if(addr == s->address)
+		{
+			LOG(GAMNET_ERR, "[Router] register same multi-cast address(service_name:", addr.service_name.c_str(), ", id:", addr.id, ", ip:", router_session->remote_address->to_string(), ")");
+			return false;
+		}
+	}
 	for(auto&s : lstSession)
 	{
 		if(addr == s->address)
@@ -76,7 +112,7 @@ bool RouterCasterImpl_Multi::RegisterAddress(const Address& addr, const std::sha
 	return true;
 }
 
-bool RouterCasterImpl_Multi::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len)
+bool RouterCasterImpl_Multi::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const
 {
 	auto itr = mapRouteTable.find(addr.service_name);
 	if(mapRouteTable.end() == itr)
@@ -85,13 +121,23 @@ bool RouterCasterImpl_Multi::SendMsg(uint64_t msg_seq, const std::shared_ptr<Net
 		return false;
 	}
 
-	for(auto& s : itr->second)
+	const SessionList* lstSession = &itr->second;
+	if(true == lstSession->empty())
+	{
+		// every server looks dead. more likely this server is the one stalled, so they are still tried
+		auto suspect = mapSuspect.find(addr.service_name);
+		if(mapSuspect.end() != suspect)
+		{
+			lstSession = &suspect->second;
+		}
+	}
+	for(auto& s : *lstSession)
 	{
 		if(NULL != network_session)
 		{
 			s->watingSessionManager_.AddSession(msg_seq, network_session);
 		}
-		s->AsyncSend(buf, len);
+		s->BatchSend(envelope, LinkKey(network_session, addr));
 	}
 	return true;
 }
@@ -113,14 +159,76 @@ bool RouterCasterImpl_Multi::UnregisterAddress(const Address& addr)
 			return true;
 		}
 		return false;
-	}));
+	}), lstSession.end());
+	SessionList& lstSuspect = mapSuspect[addr.service_name];
+	lstSuspect.erase(std::remove_if(lstSuspect.begin(), lstSuspect.end(), [&addr](const std::shared_ptr<Session> session) -> bool {
+		return addr.id == session->address.id;
+	}), lstSuspect.end());
 	return true;
 }
 
+std::shared_ptr<Session> RouterCasterImpl_Multi::Select(const Address& addr) const
+{
+	return nullptr;
+}
+
+// moves session of 'addr' from one list to the other
+static bool MoveSession(const Address& addr, std::vector<std::shared_ptr<Session>>& from, std::vector<std::shared_ptr<Session>>& to)
+{
+	for(auto itr = from.begin(); itr != from.end(); itr++)
+	{
+		if(addr.id == (*itr)->address.id)
+		{
+			to.push_back(*itr);
+			from.erase(itr);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool RouterCasterImpl_Multi::SetSuspected(const Address& addr, bool suspected)
+{
+	auto itr = mapRouteTable.find(addr.service_name);
+	if(mapRouteTable.end() == itr)
+	{
+		return false;
+	}
+	SessionList& lstSuspect = mapSuspect[addr.service_name];
+	if(true == suspected)
+	{
+		return MoveSession(addr, itr->second, lstSuspect);
+	}
+	return MoveSession(addr, lstSuspect, itr->second);
+}
+
+std::shared_ptr<RouterCasterImpl> RouterCasterImpl_Any::Clone() const
+{
+	return std::make_shared<RouterCasterImpl_Any>(*this);
+}
+
 bool RouterCasterImpl_Any::RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session)
 {
-	std::pair<int, SessionArray>& pairSessionArray = mapRouteTable[addr.service_name];
-	SessionArray& arrSession = pairSessionArray.second;
+	auto itr = mapRouteTable.find(addr.service_name);
+	if(mapRouteTable.end() == itr)
+	{
+		itr = mapRouteTable.insert(std::make_pair(addr.service_name, Service())).first;
+		auto policy = mapPolicy.find(addr.service_name);
+		if(mapPolicy.end() != policy)
+		{
+			itr->second.policy = policy->second;
+		}
+	}
+	Service& service = itr->second;
+	SessionArray& arrSession = service.sessions;
+	for(auto&s : service.suspects)
+	{
+		if(addr == s->address)
+		{
+			LOG(GAMNET_ERR, "[Router] register same any-cast address(service_name:", addr.service_name.c_str(), ", id:", addr.id, ", ip:", router_session->remote_address->to_string(), ")");
+			return false;
+		}
+	}
 	for(auto&s : arrSession)
 	{
 		if(addr == s->address)
@@ -131,36 +239,126 @@ bool RouterCasterImpl_Any::RegisterAddress(const Address& addr, const std::share
 	}
 
 	arrSession.push_back(router_session);
-	pairSessionArray.first = arrSession.size()-1;
+	service.next = (uint32_t)arrSession.size()-1;
 	LOG(GAMNET_INF, "[Router] register any-cast address success (service_name:", addr.service_name.c_str(), ", id:", addr.id, ", ip:", router_session->remote_address->to_string(), ")");
 	return true;
 }
 
-bool RouterCasterImpl_Any::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len)
+bool RouterCasterImpl_Any::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const
+{
+	std::shared_ptr<Session> router_session = Select(addr);
+	if(NULL == router_session)
+	{
+		return false;
+	}
+	if(NULL != network_session)
+	{
+		router_session->watingSessionManager_.AddSession(msg_seq, network_session);
+	}
+
+	router_session->BatchSend(envelope, LinkKey(network_session, addr));
+	return true;
+}
+
+// queue depth is what the request waits behind. cpu only breaks tie
+static uint64_t LoadScore(const Session& session)
+{
+	const uint64_t depth = (uint64_t)session.queue_depth.load(std::memory_order_relaxed) + session.outstanding.load(std::memory_order_relaxed);
+	return (depth << 32) | session.cpu.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<Session> RouterCasterImpl_Any::Select(const Address& addr) const
 {
 	auto itr = mapRouteTable.find(addr.service_name);
 	if(mapRouteTable.end() == itr)
 	{
 		LOG(GAMNET_ERR, "Cant find route info(service_name:", addr.service_name.c_str(), ")");
-		return false;
+		return nullptr;
 	}
 
-	std::pair<int, SessionArray>& pairSessionArray = itr->second;
-	SessionArray& arrSession = pairSessionArray.second;
+	const Service& service = itr->second;
+	// every server looks dead. more likely this server is the one stalled, so they are still tried
+	const SessionArray& arrSession = (false == service.sessions.empty() ? service.sessions : service.suspects);
 
 	if(0 >= arrSession.size())
 	{
 		LOG(GAMNET_ERR, "Cant find Session");
-		return false;
+		return nullptr;
 	}
-	std::shared_ptr<Session> router_session = arrSession[pairSessionArray.first++ % arrSession.size()];
-	if(NULL != network_session)
+	const uint32_t size = (uint32_t)arrSession.size();
+	const uint32_t next = service.next.fetch_add(1, std::memory_order_relaxed);
+	switch(service.policy)
 	{
-		router_session->watingSessionManager_.AddSession(msg_seq, network_session);
+	case LEAST_OUTSTANDING :
+	{
+		// scan starts at round robin cursor, so servers of the same count take turns
+		uint32_t select = next % size;
+		uint32_t min = arrSession[select]->outstanding.load(std::memory_order_relaxed);
+		for(uint32_t i=1; i<size && 0 < min; i++)
+		{
+			const uint32_t index = (next + i) % size;
+			const uint32_t outstanding = arrSession[index]->outstanding.load(std::memory_order_relaxed);
+			if(outstanding < min)
+			{
+				select = index;
+				min = outstanding;
+			}
+		}
+		return arrSession[select];
+	}
+	case POWER_OF_TWO_CHOICES :
+	{
+		if(1 == size)
+		{
+			return arrSession[0];
+		}
+		Xoshiro256& engine = Random::Engine();
+		const uint32_t first = engine.Below(size);
+		uint32_t second = engine.Below(size - 1);
+		if(first <= second)
+		{
+			second++;
+		}
+		return (LoadScore(*arrSession[second]) < LoadScore(*arrSession[first]) ? arrSession[second] : arrSession[first]);
+	}
+	case WEIGHTED_ROUND_ROBIN :
+	{
+		uint64_t total = 0;
+		for(const auto& s : arrSession)
+		{
+			total += s->weight.load(std::memory_order_relaxed);
+		}
+		if(0 == total)
+		{
+			break;
+		}
+		// golden ratio sequence of cursor spreads turns of a heavy server over the round, instead of giving them in a row
+		uint64_t pos = ((uint64_t)(uint32_t)(next * 2654435769u) * total) >> 32;
+		for(const auto& s : arrSession)
+		{
+			const uint32_t weight = s->weight.load(std::memory_order_relaxed);
+			if(pos < weight)
+			{
+				return s;
+			}
+			pos -= weight;
+		}
+		break;
+	}
+	default :
+		break;
 	}
+	return arrSession[next % size];
+}
 
-	router_session->AsyncSend(buf, len);
-	return true;
+void RouterCasterImpl_Any::SetPolicy(const std::string& service_name, ANY_CAST_POLICY policy)
+{
+	mapPolicy[service_name] = policy;
+	auto itr = mapRouteTable.find(service_name);
+	if(mapRouteTable.end() != itr)
+	{
+		itr->second.policy = policy;
+	}
 }
 
 bool RouterCasterImpl_Any::UnregisterAddress(const Address& addr)
@@ -172,8 +370,7 @@ bool RouterCasterImpl_Any::UnregisterAddress(const Address& addr)
 		return false;
 	}
 
-	std::pair<int, SessionArray>& pairSessionArray = itr->second;
-	SessionArray& arrSession = pairSessionArray.second;
+	SessionArray& arrSession = itr->second.sessions;
 	arrSession.erase(std::remove_if(arrSession.begin(), arrSession.end(), [&addr](const std::shared_ptr<Session> session) -> bool {
 		if(addr.id == session->address.id)
 		{
@@ -181,77 +378,405 @@ bool RouterCasterImpl_Any::UnregisterAddress(const Address& addr)
 			return true;
 		}
 		return false;
-	}));
+	}), arrSession.end());
+	SessionArray& arrSuspect = itr->second.suspects;
+	arrSuspect.erase(std::remove_if(arrSuspect.begin(), arrSuspect.end(), [&addr](const std::shared_ptr<Session> session) -> bool {
+		return addr.id == session->address.id;
+	}), arrSuspect.end());
 	return true;
 }
 
-RouterCaster::RouterCaster() 
+bool RouterCasterImpl_Any::SetSuspected(const Address& addr, bool suspected)
 {
-	msg_seq = 1;
-	arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Uni());
-	arrCasterImpl_[ROUTER_CAST_TYPE::MULTI_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Multi());
-	arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Any());
+	auto itr = mapRouteTable.find(addr.service_name);
+	if(mapRouteTable.end() == itr)
+	{
+		return false;
+	}
+	Service& service = itr->second;
+	if(true == suspected)
+	{
+		return MoveSession(addr, service.sessions, service.suspects);
+	}
+	return MoveSession(addr, service.suspects, service.sessions);
 }
 
-bool RouterCaster::RegisterAddress(const Address& addr, std::shared_ptr<Session> session)
+// splitmix64 finalizer. spreads sequential ids and keys over the ring
+static uint64_t HashMix(uint64_t x)
 {
-	std::lock_guard<std::mutex> lo(lock_);
-	for(int i=0; i<ROUTER_CAST_TYPE::MAX; i++)
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+void RouterCasterImpl_Hash::Ring::Build()
+{
+	points.clear();
+	points.reserve(nodes.size() * VIRTUAL_NODE_COUNT);
+	for(uint32_t i=0; i<(uint32_t)nodes.size(); i++)
+	{
+		const uint64_t id = nodes[i].id;
+		for(uint64_t node=0; node<VIRTUAL_NODE_COUNT; node++)
+		{
+			points.push_back(std::make_pair(HashMix((id << 32) | node), i));
+		}
+	}
+	// order of registration differs by router. ties are broken by server id, not by index
+	std::sort(points.begin(), points.end(), [this](const std::pair<uint64_t, uint32_t>& lhs, const std::pair<uint64_t, uint32_t>& rhs) {
+		if(lhs.first != rhs.first)
+		{
+			return lhs.first < rhs.first;
+		}
+		return nodes[lhs.second].id < nodes[rhs.second].id;
+	});
+}
+
+const std::shared_ptr<Session>& RouterCasterImpl_Hash::Ring::Find(uint64_t key) const
+{
+	auto itr = std::upper_bound(points.begin(), points.end(), std::make_pair(HashMix(key), (uint32_t)0), [](const std::pair<uint64_t, uint32_t>& lhs, const std::pair<uint64_t, uint32_t>& rhs) {
+		return lhs.first < rhs.first;
+	});
+	if(points.end() == itr)
+	{
+		itr = points.begin();
+	}
+	return nodes[itr->second].session;
+}
+
+std::shared_ptr<RouterCasterImpl> RouterCasterImpl_Hash::Clone() const
+{
+	return std::make_shared<RouterCasterImpl_Hash>(*this);
+}
+
+bool RouterCasterImpl_Hash::RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session)
+{
+	Ring& ring = mapRouteTable[addr.service_name];
+	for(auto& node : ring.nodes)
 	{
-		if(false == arrCasterImpl_[i]->RegisterAddress(addr, session))
+		if(addr.id == node.id)
 		{
+			LOG(GAMNET_ERR, "[Router] register same hash-cast address(service_name:", addr.service_name.c_str(), ", id:", addr.id, ", ip:", router_session->remote_address->to_string(), ")");
 			return false;
 		}
 	}
-	session->address = addr;
+	const Node node = { addr.id, router_session };
+	ring.nodes.push_back(node);
+	ring.Build();
+	LOG(GAMNET_INF, "[Router] register hash-cast address success (service_name:", addr.service_name.c_str(), ", id:", addr.id, ", ip:", router_session->remote_address->to_string(), ")");
 	return true;
 }
 
-bool RouterCaster::SendMsg(const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len)
+bool RouterCasterImpl_Hash::SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const
 {
-	MsgRouter_SendMsg_Ntf ntf;
-	ntf.msg_seq = addr.msg_seq;
+	std::shared_ptr<Session> router_session = Select(addr);
+	if(NULL == router_session)
+	{
+		return false;
+	}
 	if(NULL != network_session)
 	{
-		ntf.msg_seq = msg_seq++;
+		router_session->watingSessionManager_.AddSession(msg_seq, network_session);
 	}
-	ntf.buffer.assign(buf, len);
-	std::shared_ptr<Network::Tcp::Packet> packet = Network::Tcp::Packet::Create();
-	if(NULL == packet)
+
+	router_session->BatchSend(envelope, LinkKey(network_session, addr));
+	return true;
+}
+
+bool RouterCasterImpl_Hash::UnregisterAddress(const Address& addr)
+{
+	auto itr = mapRouteTable.find(addr.service_name);
+	if(mapRouteTable.end() == itr)
 	{
+		LOG(GAMNET_WRN, "Can't find route info(service_name:", addr.service_name.c_str(), ", cast_type:HASH_CAST, server_id:", addr.id, ")");
 		return false;
 	}
-	if(false == packet->Write(0, ntf))
+
+	Ring& ring = itr->second;
+	ring.nodes.erase(std::remove_if(ring.nodes.begin(), ring.nodes.end(), [&addr](const Node& node) -> bool {
+		return addr.id == node.id;
+	}), ring.nodes.end());
+	if(true == ring.nodes.empty())
+	{
+		mapRouteTable.erase(itr);
+		return true;
+	}
+	ring.Build();
+	LOG(GAMNET_INF, "[Router] unregister hash-cast address success (service_name:", addr.service_name.c_str(), ", id:", addr.id, ")");
+	return true;
+}
+
+std::shared_ptr<Session> RouterCasterImpl_Hash::Select(const Address& addr) const
+{
+	auto itr = mapRouteTable.find(addr.service_name);
+	if(mapRouteTable.end() == itr || true == itr->second.nodes.empty())
+	{
+		LOG(GAMNET_ERR, "Cant find route info(service_name:", addr.service_name.c_str(), ", cast_type:HASH_CAST)");
+		return nullptr;
+	}
+	return itr->second.Find(addr.key);
+}
+
+// versions of all RouterCaster. a version identifies one published table
+static std::atomic<uint64_t> table_version(0);
+
+struct TableCache
+{
+	uint64_t version;
+	std::weak_ptr<const RouterCaster::RoutingTable> idle; // table of 'version'. weak, so a thread with no snapshot doesn't keep a replaced table and its sessions
+	std::shared_ptr<const RouterCaster::RoutingTable> table; // held only while pinned
+	uint32_t pins; // alive snapshots of this thread
+	std::vector<std::shared_ptr<const RouterCaster::RoutingTable>> retired; // replaced while pinned
+};
+static thread_local TableCache table_cache = { 0, {}, nullptr, 0, {} };
+
+RouterCaster::Snapshot::~Snapshot()
+{
+	if(nullptr != table_ && 0 == --table_cache.pins)
+	{
+		table_cache.retired.clear();
+		table_cache.table.reset();
+	}
+}
+
+RouterCaster::RouterCaster() : version_(table_version.fetch_add(1) + 1), onRebalance([](const Address&, bool) {}), onSuspect([](const Address&, bool) {})
+{
+	msg_seq = 1;
+	std::shared_ptr<RoutingTable> table = std::make_shared<RoutingTable>();
+	table->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Uni());
+	table->arrCasterImpl_[ROUTER_CAST_TYPE::MULTI_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Multi());
+	table->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Any());
+	table->arrCasterImpl_[ROUTER_CAST_TYPE::HASH_CAST] = std::shared_ptr<RouterCasterImpl>(new RouterCasterImpl_Hash());
+	table_ = table;
+}
+
+RouterCaster::Snapshot RouterCaster::GetTable()
+{
+	// version is read before the table, so the table is never older than the cached version
+	const uint64_t version = version_.load(std::memory_order_acquire);
+	if(0 == table_cache.pins && version == table_cache.version)
+	{
+		table_cache.table = table_cache.idle.lock();
+	}
+	if(version != table_cache.version || nullptr == table_cache.table)
+	{
+		if(0 < table_cache.pins)
+		{
+			table_cache.retired.push_back(std::move(table_cache.table));
+		}
+		table_cache.table = std::atomic_load(&table_);
+		table_cache.idle = table_cache.table;
+		table_cache.version = version;
+	}
+	table_cache.pins++;
+	return Snapshot(table_cache.table.get());
+}
+
+void RouterCaster::Publish(const std::shared_ptr<const RoutingTable>& table)
+{
+	std::atomic_store(&table_, table);
+	version_.store(table_version.fetch_add(1) + 1, std::memory_order_release);
+}
+
+bool RouterCaster::RegisterAddress(const Address& addr, std::shared_ptr<Session> session)
+{
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		std::shared_ptr<RoutingTable> table = std::make_shared<RoutingTable>();
+		for(int i=0; i<ROUTER_CAST_TYPE::MAX; i++)
+		{
+			table->arrCasterImpl_[i] = table_->arrCasterImpl_[i]->Clone();
+			if(false == table->arrCasterImpl_[i]->RegisterAddress(addr, session))
+			{
+				return false;
+			}
+		}
+		session->address = addr;
+		Publish(table);
+	}
+	onRebalance(addr, true);
+	return true;
+}
+
+bool RouterCaster::RegisterLocalAddress(const Address& addr, const std::shared_ptr<Session>& local_session)
+{
+	std::lock_guard<std::mutex> lo(lock_);
+	std::shared_ptr<RoutingTable> table = std::make_shared<RoutingTable>(*table_);
+	table->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST] = table_->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST]->Clone();
+	if(false == table->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST]->RegisterAddress(addr, local_session))
 	{
 		return false;
 	}
+	local_session->address = addr;
+	Publish(table);
+	return true;
+}
+
+bool RouterCaster::SendMsg(const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Network::Tcp::Packet>& envelope)
+{
 	if(ROUTER_CAST_TYPE::MAX <= (int)addr.cast_type)
 	{
 		LOG(ERR, "cast_type:",  (int)addr.cast_type, " is undefined cast_type");
 		return false;
 	}
-	std::lock_guard<std::mutex> lo(lock_);
-	return arrCasterImpl_[(int)addr.cast_type]->SendMsg(ntf.msg_seq, network_session, addr, packet->ReadPtr(), packet->Size());
+	uint32_t seq = (uint32_t)addr.msg_seq;
+	if(NULL != network_session)
+	{
+		// top bit is of Router::Call. answer waiting session and call never share msg_seq
+		seq = msg_seq++ & ~CallManager::CALL_SEQ;
+	}
+	envelope->SetSEQ(seq);
+	return GetTable()->arrCasterImpl_[(int)addr.cast_type]->SendMsg(seq, network_session, addr, envelope);
+}
+
+bool RouterCaster::SendMsg(const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len)
+{
+	std::shared_ptr<Network::Tcp::Packet> packet = Network::Tcp::Packet::Create();
+	if(NULL == packet)
+	{
+		return false;
+	}
+	if(false == packet->WriteEnvelope(MsgRouter_Envelope_Ntf::MSG_ID, 0, buf, len))
+	{
+		return false;
+	}
+	return SendMsg(network_session, addr, packet);
 }
 
 bool RouterCaster::UnregisterAddress(const Address& addr)
 {
-	std::lock_guard<std::mutex> lo(lock_);
-	for(int i=0; i<ROUTER_CAST_TYPE::MAX; i++)
 	{
-		if(false == arrCasterImpl_[i]->UnregisterAddress(addr))
+		std::lock_guard<std::mutex> lo(lock_);
+		std::shared_ptr<RoutingTable> table = std::make_shared<RoutingTable>();
+		for(int i=0; i<ROUTER_CAST_TYPE::MAX; i++)
 		{
-			return false;
+			table->arrCasterImpl_[i] = table_->arrCasterImpl_[i]->Clone();
+			if(false == table->arrCasterImpl_[i]->UnregisterAddress(addr))
+			{
+				return false;
+			}
 		}
+		Publish(table);
 	}
+	onRebalance(addr, false);
 	return true;
 }
 
 std::shared_ptr<Session> RouterCaster::FindSession(const Address& addr)
+{
+	const Snapshot table = GetTable();
+	const RouterCasterImpl_Uni& caster_impl = static_cast<const RouterCasterImpl_Uni&>(*table->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST]);
+	return caster_impl.FindSession(addr);
+}
+
+std::shared_ptr<Session> RouterCaster::Select(const Address& addr)
+{
+	if(ROUTER_CAST_TYPE::MAX <= (int)addr.cast_type)
+	{
+		LOG(ERR, "cast_type:",  (int)addr.cast_type, " is undefined cast_type");
+		return nullptr;
+	}
+	return GetTable()->arrCasterImpl_[(int)addr.cast_type]->Select(addr);
+}
+
+void RouterCaster::SetAnyCastPolicy(const std::string& service_name, ANY_CAST_POLICY policy)
 {
 	std::lock_guard<std::mutex> lo(lock_);
-	std::shared_ptr<RouterCasterImpl_Uni> caster_impl = std::static_pointer_cast<RouterCasterImpl_Uni>(arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST]);
-	return caster_impl->FindSession(addr);
+	std::shared_ptr<RoutingTable> table = std::make_shared<RoutingTable>(*table_);
+	std::shared_ptr<RouterCasterImpl_Any> caster_impl = std::static_pointer_cast<RouterCasterImpl_Any>(table->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST]->Clone());
+	caster_impl->SetPolicy(service_name, policy);
+	table->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST] = caster_impl;
+	Publish(table);
+}
+
+void RouterCaster::UpdateSuspected(const std::shared_ptr<Session>& session)
+{
+	const Address addr = session->address;
+	bool suspected = false;
+	bool changed = false;
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		suspected = session->suspected;
+		std::shared_ptr<RoutingTable> table = std::make_shared<RoutingTable>(*table_);
+		for(int cast_type : { ROUTER_CAST_TYPE::MULTI_CAST, ROUTER_CAST_TYPE::ANY_CAST })
+		{
+			std::shared_ptr<RouterCasterImpl> caster_impl = table->arrCasterImpl_[cast_type]->Clone();
+			if(true == caster_impl->SetSuspected(addr, suspected))
+			{
+				table->arrCasterImpl_[cast_type] = caster_impl;
+				changed = true;
+			}
+		}
+		if(false == changed)
+		{
+			return;
+		}
+		Publish(table);
+	}
+	LOG(GAMNET_WRN, "[Router] ", (true == suspected ? "suspect" : "reinstate"), " server(service_name:", addr.service_name, ", id:", addr.id, ", phi:", session->failure_detector.Phi(Timer::Now()), ")");
+	onSuspect(addr, suspected);
+}
+
+void RouterCaster::DetectFailure(uint64_t now, double threshold)
+{
+	std::vector<std::shared_ptr<Session>> suspects;
+	{
+		const Snapshot table = GetTable();
+		const RouterCasterImpl_Uni& uni_cast = static_cast<const RouterCasterImpl_Uni&>(*table->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST]);
+		for(const auto& itr : uni_cast.mapRouteTable)
+		{
+			const std::shared_ptr<Session>& session = itr.second;
+			if(false == session->suspected && threshold < session->failure_detector.Phi(now))
+			{
+				suspects.push_back(session);
+			}
+		}
+	}
+	for(const std::shared_ptr<Session>& session : suspects)
+	{
+		if(false == session->suspected.exchange(true))
+		{
+			UpdateSuspected(session);
+		}
+	}
+}
+
+Json::Value RouterCaster::State()
+{
+	Json::Value root;
+	const Snapshot table = GetTable();
+	const RouterCasterImpl_Uni& uni_cast = static_cast<const RouterCasterImpl_Uni&>(*table->arrCasterImpl_[ROUTER_CAST_TYPE::UNI_CAST]);
+	Json::Value servers(Json::arrayValue);
+	for(const auto& itr : uni_cast.mapRouteTable)
+	{
+		servers.append(itr.second->State());
+	}
+	root["server"] = servers;
+
+	const char* policy_names[] = { "round_robin", "least_outstanding", "power_of_two_choices", "weighted_round_robin" };
+	const RouterCasterImpl_Any& any_cast = static_cast<const RouterCasterImpl_Any&>(*table->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST]);
+	Json::Value services;
+	for(const auto& itr : any_cast.mapRouteTable)
+	{
+		services[itr.first] = policy_names[itr.second.policy];
+	}
+	root["any_cast_policy"] = services;
+
+	const RouterCasterImpl_Hash& hash_cast = static_cast<const RouterCasterImpl_Hash&>(*table->arrCasterImpl_[ROUTER_CAST_TYPE::HASH_CAST]);
+	Json::Value rings;
+	for(const auto& itr : hash_cast.mapRouteTable)
+	{
+		Json::Value ids(Json::arrayValue);
+		for(const auto& node : itr.second.nodes)
+		{
+			ids.append(node.id);
+		}
+		rings[itr.first] = ids;
+	}
+	root["hash_cast"] = rings;
+	return root;
 }
 }}}
 
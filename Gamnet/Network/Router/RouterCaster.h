@@ -1,65 +1,188 @@
 #ifndef GAMNET_NETWORK_ROUTER_CASTER_H_
 #define GAMNET_NETWORK_ROUTER_CASTER_H_
 
-#include <list>
+#include <atomic>
 #include <string>
-#include <map>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include "Session.h"
 
 namespace Gamnet { namespace Network {namespace Router {
 
+// how ANY_CAST picks one server of the service
+enum ANY_CAST_POLICY
+{
+	ROUND_ROBIN,
+	LEAST_OUTSTANDING, // fewest Router::Call waiting for answer
+	POWER_OF_TWO_CHOICES, // less loaded of two random servers by reported queue depth + outstanding, then cpu
+	WEIGHTED_ROUND_ROBIN // by reported weight
+};
+
+struct AddressHash
+{
+	size_t operator () (const Address& addr) const
+	{
+		return std::hash<std::string>()(addr.service_name) ^ ((size_t)addr.id * 0x9e3779b9);
+	}
+};
+
+/*
+ * routing tables are immutable after they are published. register and unregister modify a 'Clone' and
+ * 'SendMsg' reads the published one without lock, so 'SendMsg' and 'FindSession' are const.
+ */
 struct RouterCasterImpl {
 	virtual ~RouterCasterImpl() {}
+	virtual std::shared_ptr<RouterCasterImpl> Clone() const = 0;
 	virtual bool RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session) = 0;
-	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session,  const Address& addr, const char* buf, int len) = 0;
+	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session,  const Address& addr, const std::shared_ptr<Buffer>& envelope) const = 0;
 	virtual bool UnregisterAddress(const Address& addr) = 0;
+	// the one server 'SendMsg' would send to. null for multi-cast
+	virtual std::shared_ptr<Session> Select(const Address& addr) const = 0;
+	// takes suspected server out of selection, or puts it back. true if changed
+	virtual bool SetSuspected(const Address& addr, bool suspected) { return false; }
 };
 
 struct RouterCasterImpl_Uni : public RouterCasterImpl
 {
-	typedef std::map<Address, std::shared_ptr<Session>> RoutingTableMap;
+	typedef std::unordered_map<Address, std::shared_ptr<Session>, AddressHash> RoutingTableMap;
 	RoutingTableMap mapRouteTable;
 
+	virtual std::shared_ptr<RouterCasterImpl> Clone() const;
 	virtual bool RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session);
-	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len);
+	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const;
 	virtual bool UnregisterAddress(const Address& addr);
-	std::shared_ptr<Session> FindSession(const Address& addr);
+	virtual std::shared_ptr<Session> Select(const Address& addr) const;
+	std::shared_ptr<Session> FindSession(const Address& addr) const;
 };
 
 struct RouterCasterImpl_Multi : public RouterCasterImpl
 {
-	typedef std::list<std::shared_ptr<Session>> SessionList;
-	typedef std::map<std::string, SessionList> RoutingTableMap;
+	typedef std::vector<std::shared_ptr<Session>> SessionList;
+	typedef std::unordered_map<std::string, SessionList> RoutingTableMap;
 	RoutingTableMap mapRouteTable;
+	RoutingTableMap mapSuspect; // used only while every server of the service is suspected
 
+	virtual std::shared_ptr<RouterCasterImpl> Clone() const;
 	virtual bool RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session);
-	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session,  const Address& addr, const char* buf, int len);
+	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session,  const Address& addr, const std::shared_ptr<Buffer>& envelope) const;
 	virtual bool UnregisterAddress(const Address& addr);
+	virtual std::shared_ptr<Session> Select(const Address& addr) const;
+	virtual bool SetSuspected(const Address& addr, bool suspected);
 };
 
 struct RouterCasterImpl_Any : public RouterCasterImpl
 {
 	typedef std::vector<std::shared_ptr<Session>> SessionArray;
-	typedef std::map<std::string, std::pair<int, SessionArray> > RoutingTableMap;
+	struct Service
+	{
+		// round robin cursor is the only field changed after publish
+		mutable std::atomic<uint32_t> next;
+		ANY_CAST_POLICY policy;
+		SessionArray sessions;
+		SessionArray suspects; // used only while every server of the service is suspected
+
+		Service() : next(0), policy(ROUND_ROBIN) {}
+		Service(const Service& service) : next(service.next.load()), policy(service.policy), sessions(service.sessions), suspects(service.suspects) {}
+	};
+	typedef std::unordered_map<std::string, Service> RoutingTableMap;
+	RoutingTableMap mapRouteTable;
+	// kept for services not registered yet
+	std::unordered_map<std::string, ANY_CAST_POLICY> mapPolicy;
+
+	virtual std::shared_ptr<RouterCasterImpl> Clone() const;
+	virtual bool RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session);
+	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const;
+	virtual bool UnregisterAddress(const Address& addr);
+	virtual std::shared_ptr<Session> Select(const Address& addr) const;
+	virtual bool SetSuspected(const Address& addr, bool suspected);
+	void SetPolicy(const std::string& service_name, ANY_CAST_POLICY policy);
+};
+
+/*
+ * consistent hash ring of each service. every server has VIRTUAL_NODE_COUNT points on the ring, and 'key' of
+ * address goes to the server of the next point. when a server joins or leaves, only keys of its points move.
+ * points depend only on server id, so every router maps a key to the same server.
+ */
+struct RouterCasterImpl_Hash : public RouterCasterImpl
+{
+	enum {
+		VIRTUAL_NODE_COUNT = 160
+	};
+	struct Node
+	{
+		uint32_t id;
+		std::shared_ptr<Session> session;
+	};
+	struct Ring
+	{
+		std::vector<std::pair<uint64_t, uint32_t>> points; // hash, index of 'nodes'. sorted
+		std::vector<Node> nodes;
+
+		void Build();
+		const std::shared_ptr<Session>& Find(uint64_t key) const;
+	};
+	typedef std::unordered_map<std::string, Ring> RoutingTableMap;
 	RoutingTableMap mapRouteTable;
 
+	virtual std::shared_ptr<RouterCasterImpl> Clone() const;
 	virtual bool RegisterAddress(const Address& addr, const std::shared_ptr<Session>& router_session);
-	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len);
+	virtual bool SendMsg(uint64_t msg_seq, const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Buffer>& envelope) const;
 	virtual bool UnregisterAddress(const Address& addr);
+	virtual std::shared_ptr<Session> Select(const Address& addr) const;
 };
 
 struct RouterCaster
 {
+	struct RoutingTable
+	{
+		std::shared_ptr<RouterCasterImpl> arrCasterImpl_[ROUTER_CAST_TYPE::MAX];
+	};
+	// pins the table of the calling thread while alive. nested 'GetTable' may load a newer table, and the older one
+	// is released when the last snapshot of the thread ends, so no caller is left with a freed table
+	class Snapshot
+	{
+		const RoutingTable* table_;
+	public :
+		explicit Snapshot(const RoutingTable* table) : table_(table) {}
+		Snapshot(Snapshot&& other) : table_(other.table_) { other.table_ = nullptr; }
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator = (const Snapshot&) = delete;
+		~Snapshot();
+		const RoutingTable* operator -> () const { return table_; }
+		const RoutingTable& operator * () const { return *table_; }
+	};
+
 	std::atomic<uint32_t> msg_seq;
+	// serializes writers only. readers take the published table
 	std::mutex lock_;
-	std::shared_ptr<RouterCasterImpl> arrCasterImpl_[ROUTER_CAST_TYPE::MAX];
+	std::shared_ptr<const RoutingTable> table_;
+	std::atomic<uint64_t> version_; // unique in the process, so a snapshot of other or destroyed RouterCaster never matches
+	// called after a server joined or left hash rings of its service. keys of the server moved. set before Listen
+	std::function<void(const Address& addr, bool join)> onRebalance;
+	// called when heartbeat of a server is late and when it comes again. set before Listen
+	std::function<void(const Address& addr, bool suspected)> onSuspect;
+
 	RouterCaster();
+	// snapshot of routing table. each thread keeps a weak reference to it and reloads only when version changes. the outermost
+	// snapshot of a thread locks the weak reference, nested ones touch nothing shared but 'version_'. keep the snapshot, not a reference to the table
+	Snapshot GetTable();
+	void Publish(const std::shared_ptr<const RoutingTable>& table);
 	bool RegisterAddress(const Address& addr, std::shared_ptr<Session> router_session);
+	// registers this server for uni-cast to its own address only. it is not a member of its service for multi-cast, any-cast and hash-cast
+	bool RegisterLocalAddress(const Address& addr, const std::shared_ptr<Session>& local_session);
+	// 'envelope' is written by 'Packet::WriteEnvelope'. same packet is queued to every router link without copy
+	bool SendMsg(const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const std::shared_ptr<Network::Tcp::Packet>& envelope);
 	bool SendMsg(const std::shared_ptr<Network::Tcp::Session>& network_session, const Address& addr, const char* buf, int len);
 	bool UnregisterAddress(const Address& addr);
 	std::shared_ptr<Session> FindSession(const Address& addr);
+	std::shared_ptr<Session> Select(const Address& addr);
+	void SetAnyCastPolicy(const std::string& service_name, ANY_CAST_POLICY policy);
+	// applies 'Session::suspected' to routing table. last call sees the last flag, so table follows the flag in any order
+	void UpdateSuspected(const std::shared_ptr<Session>& session);
+	// suspects registered servers of which phi is over 'threshold'
+	void DetectFailure(uint64_t now, double threshold);
+	Json::Value State();
 };
 }}}
 #endif /* ROUTER_CASTER_H_ */
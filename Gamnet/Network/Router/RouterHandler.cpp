@@ -5,6 +5,7 @@
 #include "LinkManager.h"
 namespace Gamnet { namespace Network { namespace Router {
 
+// message of the router of older build, which doesn't send envelope
 void RouterHandler::Recv_SendMsg_Ntf(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
 {
 	MsgRouter_SendMsg_Ntf ntf;
@@ -36,14 +37,38 @@ void RouterHandler::Recv_SendMsg_Ntf(const std::shared_ptr<Session>& session, co
 	session_packet->Append(ntf.buffer.c_str(), ntf.buffer.length());
 	Singleton<Dispatcher>::GetInstance().OnRecvMsg(addr, session_packet);
 }
+void RouterHandler::Recv_Envelope_Ntf(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	Address addr = session->address;
+	addr.msg_seq = packet->GetSEQ();
+	try {
+		if(false == packet->OpenEnvelope())
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "router message format error");
+		}
+
+		if(NULL == Singleton<RouterCaster>::GetInstance().FindSession(session->address))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidAddressError, " receive a message from unregistered address(ip:", session->remote_address->to_string(), ", service_name:", session->address.service_name, ")");
+		}
+	}
+	catch(const Exception& e) {
+		LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(", e.error_code(), ")");
+		return;
+	}
+
+	// inner message is dispatched in the received packet itself
+	Singleton<Dispatcher>::GetInstance().OnRecvMsg(addr, packet);
+}
 void RouterHandler::Recv_SetAddress_Req(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
 {
 	MsgRouter_SetAddress_Req req;
 	MsgRouter_SetAddress_Ans ans;
+	Handshake handshake;
 	ans.error_code = ErrorCode::Success;
 
 	try {
-		if(false == Network::Tcp::Packet::Load(req, packet))
+		if(false == packet->Read(req, handshake))
 		{
 			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "router message format error");
 		}
@@ -54,6 +79,7 @@ void RouterHandler::Recv_SetAddress_Req(const std::shared_ptr<Session>& session,
 			throw GAMNET_EXCEPTION(ErrorCode::InvalidAddressError, "same router address(", req.local_address.service_name, ":", (int)req.local_address.cast_type, ":", req.local_address.id, ")");
 		}
 		session->address = req.local_address;
+		session->features = handshake.features;
 		ans.remote_address = Singleton<LinkManager>::GetInstance().local_address;
 	}
 	catch(const Exception& e) {
@@ -61,14 +87,16 @@ void RouterHandler::Recv_SetAddress_Req(const std::shared_ptr<Session>& session,
 		ans.error_code = e.error_code();
 	}
 
-	LOG(INF, "[Router] send SetAddress_Ans (localhost->", session->remote_address->to_string(), ", service_name:", req.local_address.service_name.c_str(), ")");
-	SendMsg(session, ans);
+	LOG(INF, "[Router] send SetAddress_Ans (localhost->", session->remote_address->to_string(), ", service_name:", req.local_address.service_name.c_str(), ", features:", handshake.features, ")");
+	handshake.features = Session::FEATURE_ALL;
+	Network::Tcp::SendMsg(session, ans, handshake);
 }
 void RouterHandler::Recv_SetAddress_Ans(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
 {
 	MsgRouter_SetAddress_Ans ans;
+	Handshake handshake;
 	try {
-		if(false == Network::Tcp::Packet::Load(ans, packet))
+		if(false == packet->Read(ans, handshake))
 		{
 			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "router message format error");
 		}
@@ -79,15 +107,27 @@ void RouterHandler::Recv_SetAddress_Ans(const std::shared_ptr<Session>& session,
 			_link->strand.wrap(std::bind(&Link::Close, _link, ans.error_code))();
 			throw Exception(ans.error_code, "ERR [", __FILE__, ":", __func__, "@" , __LINE__, "] Recv_SetAddress_Ans fail");
 		}
-		LOG(GAMNET_INF, "[Router] recv SetAddress_Ans(", session->remote_address->to_string(), "->localhost, service_name:", ans.remote_address.service_name, ")");
-		Singleton<RouterCaster>::GetInstance().RegisterAddress(ans.remote_address, session);
+		LOG(GAMNET_INF, "[Router] recv SetAddress_Ans(", session->remote_address->to_string(), "->localhost, service_name:", ans.remote_address.service_name, ", features:", handshake.features, ")");
+		session->features = handshake.features;
+		const bool registered = Singleton<RouterCaster>::GetInstance().RegisterAddress(ans.remote_address, session);
 		if (Singleton<LinkManager>::GetInstance().local_address != ans.remote_address)
 		{
 			Log::Write(GAMNET_INF, "[Router] send SetAddress_Ntf (localhost->", session->remote_address->to_string(), ")");
 			MsgRouter_SetAddress_Ntf ntf;
 			SendMsg(session, ntf);
-			std::lock_guard<std::mutex> lo(LinkManager::lock);
-			session->onRouterConnect(session->address);
+			{
+				std::lock_guard<std::mutex> lo(LinkManager::lock);
+				session->onRouterConnect(session->address);
+			}
+			if(true == registered)
+			{
+				session->retry_count = 0;
+				// shared memory replaces lanes. they are opened if the server refuses it
+				if(false == Singleton<LinkManager>::GetInstance().OfferShmLink(session))
+				{
+					Singleton<LinkManager>::GetInstance().ConnectLanes(session);
+				}
+			}
 		}
 	}
 	catch(const Exception& e) {
@@ -112,9 +152,153 @@ void RouterHandler::Recv_SetAddress_Ntf(const std::shared_ptr<Session>& session,
 	}
 }
 
+void RouterHandler::Recv_JoinLink_Ntf(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	MsgRouter_JoinLink_Ntf ntf;
+	try {
+		if(false == Network::Tcp::Packet::Load(ntf, packet))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "router message format error");
+		}
+		LOG(GAMNET_INF, "[Router] recv JoinLink_Ntf (", session->remote_address->to_string(), "->localhost, service_name:", ntf.local_address.service_name, ", link_index:", ntf.link_index, ", link_count:", ntf.link_count, ")");
+		if(0 == ntf.link_index || ntf.link_count <= ntf.link_index || Session::MAX_LINK_COUNT < ntf.link_count)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "invalid link index(link_index:", ntf.link_index, ", link_count:", ntf.link_count, ")");
+		}
+		// SetAddress_Ntf of the first link may not be here yet. remote connects this link again after backoff
+		std::shared_ptr<Session> primary = Singleton<RouterCaster>::GetInstance().FindSession(ntf.local_address);
+		if(nullptr == primary)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidAddressError, "first link is not registered(service_name:", ntf.local_address.service_name, ", id:", ntf.local_address.id, ")");
+		}
+		session->address = primary->address;
+		session->link_index = ntf.link_index;
+		session->primary = primary;
+		primary->link_count = ntf.link_count;
+		primary->AttachLane(ntf.link_index, session->link);
+	}
+	catch(const Exception& e) {
+		if(ErrorCode::InvalidAddressError == e.error_code())
+		{
+			LOG(Log::Logger::LOG_LEVEL_WRN, e.what(), "(error_code:", e.error_code(), ")");
+		}
+		else
+		{
+			LOG(Log::Logger::LOG_LEVEL_ERR, e.what(), "(error_code:", e.error_code(), ")");
+		}
+		std::shared_ptr<Link> _link = session->link;
+		if(nullptr != _link)
+		{
+			_link->strand.wrap(std::bind(&Link::Close, _link, e.error_code()))();
+		}
+	}
+}
+
+void RouterHandler::Recv_ShmLink_Req(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	MsgRouter_ShmLink_Req req;
+	MsgRouter_ShmLink_Ans ans;
+	ans.error_code = ErrorCode::Success;
+	try {
+		if(false == Network::Tcp::Packet::Load(req, packet))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "router message format error");
+		}
+		LOG(GAMNET_INF, "[Router] recv ShmLink_Req (", session->remote_address->to_string(), "->localhost, service_name:", session->address.service_name, ", name:", req.name, ", size:", req.size, ")");
+		if(0 == Singleton<LinkManager>::GetInstance().shm_size)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::NotInitializedError, "shared memory is not enabled(name:", req.name, ")");
+		}
+		std::shared_ptr<ShmLink> shm = ShmLink::Open(req.name, req.size);
+		if(nullptr == shm)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::InvalidArgumentError, "can not open shared memory(name:", req.name, ")");
+		}
+		std::shared_ptr<Network::Tcp::Packet> reply = Network::Tcp::Packet::Create();
+		if(nullptr == reply || false == reply->Write(0, ans))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::NullPointerError, "can not create packet(name:", req.name, ")");
+		}
+		// frames before this go through the link ahead of the answer
+		session->AttachShmLink(shm, reply);
+		return;
+	}
+	catch(const Exception& e) {
+		LOG(Log::Logger::LOG_LEVEL_WRN, e.what(), "(error_code:", e.error_code(), ")");
+		ans.error_code = e.error_code();
+	}
+	SendMsg(session, ans);
+}
+
+void RouterHandler::Recv_ShmLink_Ans(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	MsgRouter_ShmLink_Ans ans;
+	std::shared_ptr<ShmLink> shm = session->TakeShmOffer();
+	try {
+		if(false == Network::Tcp::Packet::Load(ans, packet))
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::MessageFormatError, "router message format error");
+		}
+		if(nullptr == shm)
+		{
+			throw GAMNET_EXCEPTION(ErrorCode::NullPointerError, "shared memory is not offered(service_name:", session->address.service_name, ")");
+		}
+		if(ErrorCode::Success != ans.error_code)
+		{
+			throw GAMNET_EXCEPTION(ans.error_code, "shared memory is refused(service_name:", session->address.service_name, ", name:", shm->GetName(), ")");
+		}
+		LOG(GAMNET_INF, "[Router] recv ShmLink_Ans (", session->remote_address->to_string(), "->localhost, service_name:", session->address.service_name, ", name:", shm->GetName(), ")");
+	}
+	catch(const Exception& e) {
+		LOG(Log::Logger::LOG_LEVEL_WRN, e.what(), "(error_code:", e.error_code(), ")");
+		if(nullptr != shm)
+		{
+			shm->Close();
+		}
+		Singleton<LinkManager>::GetInstance().ConnectLanes(session);
+		return;
+	}
+
+	MsgRouter_ShmLink_Ntf ntf;
+	std::shared_ptr<Network::Tcp::Packet> reply = Network::Tcp::Packet::Create();
+	if(nullptr == reply || false == reply->Write(0, ntf))
+	{
+		LOG(GAMNET_ERR, "[Router] can not create packet(service_name:", session->address.service_name, ", name:", shm->GetName(), ")");
+		shm->Close();
+		Singleton<LinkManager>::GetInstance().ConnectLanes(session);
+		return;
+	}
+	session->AttachShmLink(shm, reply);
+	// frames of the server before its answer are already handled on this strand
+	session->StartShmLink();
+}
+
+void RouterHandler::Recv_ShmLink_Ntf(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
+{
+	LOG(GAMNET_INF, "[Router] recv ShmLink_Ntf (", session->remote_address->to_string(), "->localhost, service_name:", session->address.service_name, ")");
+	session->StartShmLink();
+}
+
 void RouterHandler::Recv_HeartBeat_Ntf(const std::shared_ptr<Session>& session, const std::shared_ptr<Network::Tcp::Packet>& packet)
 {
-	LOG(DEV, "[Router] recv heartbeat message(address:", session->address.service_name, ":", (int)session->address.cast_type, ":", session->address.id,")");
+	// lanes carry heartbeat only to keep the link alive. load is kept by the first link
+	if(0 != session->link_index)
+	{
+		return;
+	}
+	MsgRouter_HeartBeat_Ntf ntf;
+	// heartbeat of the router which doesn't report load has empty body
+	if(true == Network::Tcp::Packet::Load(ntf, packet))
+	{
+		session->SetLoad(ntf.load);
+	}
+	// interval is 0 from the router which doesn't send it. detector learns it from arrivals then
+	session->failure_detector.HeartBeat(Timer::Now(), ntf.interval);
+	if(true == session->suspected.exchange(false))
+	{
+		Singleton<RouterCaster>::GetInstance().UpdateSuspected(session);
+	}
+	LOG(DEV, "[Router] recv heartbeat message(address:", session->address.service_name, ":", (int)session->address.cast_type, ":", session->address.id, ", cpu:", ntf.load.cpu, ", queue_depth:", ntf.load.queue_depth, ")");
 }
 
 }}}
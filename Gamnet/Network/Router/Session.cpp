@@ -3,14 +3,21 @@
 #include "../Tcp/Tcp.h"
 #include "LinkManager.h"
 #include "RouterCaster.h"
+#include "Dispatcher.h"
 
 
 namespace Gamnet { namespace Network { namespace Router {
 
 static boost::asio::io_service& io_service_ = Singleton<boost::asio::io_service>::GetInstance();
 
-Session::Session() : Network::Tcp::Session() 
+Session::Session() : Network::Tcp::Session(), features(0), outstanding(0), cpu(0), session_count(0), queue_depth(0), weight(DEFAULT_WEIGHT), send_frame_count(0), send_batch_count(0), link_count(1), link_index(0), retry_count(0), suspected(false)
 {
+	for(SendBatch& batch : batch_)
+	{
+		batch.size = 0;
+		batch.frame_count = 0;
+		batch.scheduled = false;
+	}
 	onRouterConnect = [](const Address&) {};
 	onRouterClose = [](const Address&) {};
 }
@@ -21,6 +28,33 @@ Session::~Session()
 
 void Session::OnCreate() 
 {
+	// pooled session keeps address of its last use. closing before SetAddress would unregister it
+	address = Address();
+	features = 0;
+	outstanding = 0;
+	cpu = 0;
+	session_count = 0;
+	queue_depth = 0;
+	weight = DEFAULT_WEIGHT;
+	send_frame_count = 0;
+	send_batch_count = 0;
+	link_count = 1;
+	link_index = 0;
+	primary.reset();
+	connector = nullptr;
+	retry_count = 0;
+	suspected = false;
+	failure_detector.Reset();
+	CloseShmLink();
+	for(SendBatch& batch : batch_)
+	{
+		std::lock_guard<std::mutex> lo(batch.lock);
+		batch.link = nullptr;
+		batch.buffers.clear();
+		batch.size = 0;
+		batch.frame_count = 0;
+		batch.scheduled = false;
+	}
 }
 
 void Session::OnAccept() 
@@ -30,16 +64,49 @@ void Session::OnAccept()
 
 void Session::OnConnect()
 {
+	if(0 != link_index)
+	{
+		std::shared_ptr<Session> _primary = primary.lock();
+		if(nullptr == _primary)
+		{
+			// first link closed while this one was connecting. reconnect of the first link opens lanes again
+			std::shared_ptr<Network::Link> _link = link;
+			_link->strand.wrap(std::bind(&Network::Link::Close, _link, ErrorCode::InvalidSessionError))();
+			return;
+		}
+		LOG(GAMNET_INF, "[Router] link connect success..(remote ip:", remote_address->to_string(), ", link_index:", link_index, ")");
+		MsgRouter_JoinLink_Ntf ntf;
+		ntf.local_address = Singleton<LinkManager>::GetInstance().local_address;
+		ntf.link_index = link_index;
+		ntf.link_count = _primary->link_count;
+		Network::Tcp::SendMsg(std::static_pointer_cast<Session>(shared_from_this()), ntf);
+		// join message goes first on this link, so frames after it reach the remote lane
+		_primary->AttachLane(link_index, link);
+		retry_count = 0;
+		return;
+	}
 	watingSessionManager_.Clear();
 	LOG(GAMNET_INF, "[Router] connect success..(remote ip:", remote_address->to_string(), ")");
 	MsgRouter_SetAddress_Req req;
 	req.local_address = Singleton<LinkManager>::GetInstance().local_address;
-	Network::Tcp::SendMsg(std::static_pointer_cast<Session>(shared_from_this()), req);
+	Handshake handshake;
+	handshake.features = FEATURE_ALL;
+	Network::Tcp::SendMsg(std::static_pointer_cast<Session>(shared_from_this()), req, handshake);
 	LOG(GAMNET_INF, "[Router] send SetAddress_Req (localhost->", remote_address->to_string(), ", service_name:", req.local_address.service_name.c_str(), ")");
 }
 
 void Session::OnClose(int reason)
 {
+	if(0 != link_index)
+	{
+		LOG(GAMNET_INF, "[Router] remote server link closed(session_key:", session_key, ", ip:", remote_address->to_string(), ", service_name:", address.service_name, ", link_index:", link_index, ", reason:", reason, ")");
+		std::shared_ptr<Session> _primary = primary.lock();
+		if(nullptr != _primary)
+		{
+			_primary->DetachLane(link_index, link);
+		}
+		return;
+	}
 	LOG(GAMNET_INF, "[Router] remote server closed(session_key:", session_key, ", ip:", remote_address->to_string(), ", service_name:", address.service_name, ", reason:", reason, ")");
 	if("" != address.service_name)
 	{
@@ -49,6 +116,8 @@ void Session::OnClose(int reason)
 		}
 		Singleton<RouterCaster>::GetInstance().UnregisterAddress(address);
 	}
+	CloseLanes();
+	CloseShmLink();
 	watingSessionManager_.Clear();
 }
 
@@ -56,4 +125,390 @@ void Session::OnDestroy()
 {
 }
 
+bool Session::BatchSend(const std::shared_ptr<Buffer>& buffer, uint64_t key)
+{
+	if(0 != (features.load(std::memory_order_relaxed) & FEATURE_ENVELOPE))
+	{
+		return BatchSend(&buffer, 1, key);
+	}
+
+	// router of older build reads MsgRouter_SendMsg_Ntf only
+	std::shared_ptr<Buffer> buffers[2];
+	if(false == WriteSendMsgNtf(buffer, buffers))
+	{
+		return false;
+	}
+	return BatchSend(buffers, 2, key);
+}
+
+// body of MsgRouter_SendMsg_Ntf is (msg_seq, length of frame, frame)
+bool Session::WriteSendMsgNtf(const std::shared_ptr<Buffer>& buffer, std::shared_ptr<Buffer> (&buffers)[2])
+{
+	const char* envelope = buffer->ReadPtr();
+	const uint16_t length = *((uint16_t*)(envelope + Network::Tcp::Packet::OFFSET_LENGTH));
+	if(buffer->Size() < length || Network::Tcp::Packet::HEADER_SIZE > length)
+	{
+		LOG(GAMNET_ERR, "router message format error");
+		return false;
+	}
+	const uint32_t frame_length = length - Network::Tcp::Packet::HEADER_SIZE;
+	char header[Network::Tcp::Packet::HEADER_SIZE + sizeof(uint32_t) * 2];
+	const size_t total_length = sizeof(header) + frame_length;
+	if((size_t)Buffer::MAX_SIZE <= total_length)
+	{
+		LOG(GAMNET_WRN, "packet max capacity over(msg_id:", MsgRouter_SendMsg_Ntf::MSG_ID, ", size:", total_length, ")");
+		return false;
+	}
+	(*(uint16_t*)(header + Network::Tcp::Packet::OFFSET_LENGTH)) = (uint16_t)total_length;
+	(*(uint32_t*)(header + Network::Tcp::Packet::OFFSET_MSGSEQ)) = 0;
+	(*(uint32_t*)(header + Network::Tcp::Packet::OFFSET_MSGID)) = MsgRouter_SendMsg_Ntf::MSG_ID;
+	(*(uint32_t*)(header + Network::Tcp::Packet::HEADER_SIZE)) = *((uint32_t*)(envelope + Network::Tcp::Packet::OFFSET_MSGSEQ));
+	(*(uint32_t*)(header + Network::Tcp::Packet::HEADER_SIZE + sizeof(uint32_t))) = frame_length;
+
+	buffers[0] = Network::Tcp::Packet::Create();
+	buffers[1] = Network::Tcp::Packet::View(buffer, Network::Tcp::Packet::HEADER_SIZE, frame_length);
+	if(nullptr == buffers[0] || nullptr == buffers[1])
+	{
+		LOG(GAMNET_ERR, "can not create packet");
+		return false;
+	}
+	buffers[0]->Append(header, sizeof(header));
+	return true;
+}
+
+std::shared_ptr<Network::Link> Session::LockLink(uint64_t key, uint32_t& index, std::unique_lock<std::mutex>& lo)
+{
+	const uint32_t count = link_count.load(std::memory_order_relaxed);
+	index = (1 < count ? (uint32_t)(key % count) : 0);
+	lo = std::unique_lock<std::mutex>(batch_[index].lock);
+	std::shared_ptr<Network::Link> _link = (0 == index ? link : batch_[index].link);
+	if(nullptr == _link && 0 != index)
+	{
+		lo.unlock();
+		index = 0;
+		lo = std::unique_lock<std::mutex>(batch_[index].lock);
+		_link = link;
+	}
+	return _link;
+}
+
+uint32_t Session::GetLinkIndex(uint64_t key)
+{
+	uint32_t index = 0;
+	std::unique_lock<std::mutex> lo;
+	LockLink(key, index, lo);
+	return index;
+}
+
+bool Session::BatchSend(const std::shared_ptr<Buffer>* buffers, size_t buffer_count, uint64_t key)
+{
+	uint32_t index = 0;
+	std::unique_lock<std::mutex> lo;
+	std::shared_ptr<Network::Link> _link = LockLink(key, index, lo);
+	// checked under the lock, so no frame goes to the link after the switch.
+	// it is offered only to router with FEATURE_SHM_LINK, which takes envelope of one buffer
+	const std::shared_ptr<ShmLink> shm = (0 == index ? std::atomic_load(&shm_link_) : nullptr);
+	if(nullptr != shm)
+	{
+		send_frame_count.fetch_add(1, std::memory_order_relaxed);
+		send_batch_count.fetch_add(1, std::memory_order_relaxed);
+		if(false == shm->Send(buffers[0]))
+		{
+			// frames in the ring would be overtaken on tcp, so the frame is lost and the link is closed to reconnect.
+			// posted, because close of the link takes this lock
+			if(nullptr != _link)
+			{
+				_link->strand.post(std::bind(&Network::Link::Close, _link, ErrorCode::ResponseTimeoutError));
+			}
+			return false;
+		}
+		return true;
+	}
+	if(nullptr == _link)
+	{
+		LOG(ERR, "invalid link[session_key:", session_key, "]");
+		return false;
+	}
+
+	const LinkManager& link_manager = Singleton<LinkManager>::GetInstance();
+	const size_t batch_size = link_manager.batch_size;
+	SendBatch& batch = batch_[index];
+	if(0 == batch_size)
+	{
+		// posted like batches, so frames of the same link keep the order they were queued in under the lock
+		send_frame_count.fetch_add(1, std::memory_order_relaxed);
+		send_batch_count.fetch_add(1, std::memory_order_relaxed);
+		_link->AsyncSend(std::vector<std::shared_ptr<Buffer>>(buffers, buffers + buffer_count));
+		return true;
+	}
+
+	for(size_t i=0; i<buffer_count; i++)
+	{
+		batch.buffers.push_back(buffers[i]);
+		batch.size += buffers[i]->Size();
+	}
+	batch.frame_count++;
+	if(batch_size <= batch.size)
+	{
+		FlushBatch(batch, _link);
+		return true;
+	}
+	if(false == batch.scheduled)
+	{
+		batch.scheduled = true;
+		std::weak_ptr<Session> weak = std::static_pointer_cast<Session>(shared_from_this());
+		auto flush = [weak, index]() {
+			std::shared_ptr<Session> self = weak.lock();
+			if(nullptr != self)
+			{
+				self->FlushBatch(index);
+			}
+		};
+		const int batch_delay = link_manager.batch_delay;
+		if(0 < batch_delay)
+		{
+			batch.timer.SetTimer(batch_delay, flush);
+		}
+		else
+		{
+			_link->strand.post(flush);
+		}
+	}
+	return true;
+}
+
+void Session::FlushBatch(uint32_t index)
+{
+	SendBatch& batch = batch_[index];
+	std::lock_guard<std::mutex> lo(batch.lock);
+	std::shared_ptr<Network::Link> _link = (0 == index ? link : batch.link);
+	batch.scheduled = false;
+	if(nullptr == _link)
+	{
+		batch.buffers.clear();
+		batch.size = 0;
+		batch.frame_count = 0;
+		return;
+	}
+	FlushBatch(batch, _link);
+}
+
+// called with batch lock, so batches reach the link in the order they were made
+void Session::FlushBatch(SendBatch& batch, const std::shared_ptr<Network::Link>& link)
+{
+	if(true == batch.buffers.empty())
+	{
+		return;
+	}
+	send_frame_count.fetch_add(batch.frame_count, std::memory_order_relaxed);
+	send_batch_count.fetch_add(1, std::memory_order_relaxed);
+	link->AsyncSend(batch.buffers);
+	batch.buffers.clear();
+	batch.size = 0;
+	batch.frame_count = 0;
+}
+
+bool Session::AttachLane(uint32_t index, const std::shared_ptr<Network::Link>& link)
+{
+	if(0 == index || MAX_LINK_COUNT <= index || nullptr == link)
+	{
+		return false;
+	}
+	SendBatch& batch = batch_[index];
+	std::lock_guard<std::mutex> lo(batch.lock);
+	if(nullptr != batch.link && link != batch.link)
+	{
+		// remote reconnected the lane before close of the old one reached here
+		batch.link->strand.wrap(std::bind(&Network::Link::Close, batch.link, ErrorCode::DuplicateConnectionError))();
+	}
+	batch.link = link;
+	return true;
+}
+
+void Session::DetachLane(uint32_t index, const std::shared_ptr<Network::Link>& link)
+{
+	if(0 == index || MAX_LINK_COUNT <= index)
+	{
+		return;
+	}
+	SendBatch& batch = batch_[index];
+	std::lock_guard<std::mutex> lo(batch.lock);
+	if(link == batch.link)
+	{
+		// frames still in batch are lost with the link, like frames queued to it
+		batch.link = nullptr;
+		batch.buffers.clear();
+		batch.size = 0;
+		batch.frame_count = 0;
+	}
+}
+
+void Session::CloseLanes()
+{
+	for(uint32_t index=1; index<MAX_LINK_COUNT; index++)
+	{
+		std::shared_ptr<Network::Link> lane;
+		{
+			std::lock_guard<std::mutex> lo(batch_[index].lock);
+			lane.swap(batch_[index].link);
+			batch_[index].buffers.clear();
+			batch_[index].size = 0;
+			batch_[index].frame_count = 0;
+		}
+		if(nullptr != lane)
+		{
+			lane->strand.wrap(std::bind(&Network::Link::Close, lane, ErrorCode::Success))();
+		}
+	}
+}
+
+void Session::AttachShmLink(const std::shared_ptr<ShmLink>& shm, const std::shared_ptr<Buffer>& reply)
+{
+	SendBatch& batch = batch_[0];
+	std::lock_guard<std::mutex> lo(batch.lock);
+	if(nullptr != link)
+	{
+		// in the same posted send as the frames before it. inline send of strand would go ahead of them
+		batch.buffers.push_back(reply);
+		batch.size += reply->Size();
+		batch.frame_count++;
+		FlushBatch(batch, link);
+	}
+	std::atomic_store(&shm_link_, shm);
+}
+
+void Session::OfferShmLink(const std::shared_ptr<ShmLink>& shm)
+{
+	std::lock_guard<std::mutex> lo(batch_[0].lock);
+	shm_offer_ = shm;
+}
+
+std::shared_ptr<ShmLink> Session::TakeShmOffer()
+{
+	std::lock_guard<std::mutex> lo(batch_[0].lock);
+	std::shared_ptr<ShmLink> shm;
+	shm.swap(shm_offer_);
+	return shm;
+}
+
+void Session::StartShmLink()
+{
+	const std::shared_ptr<ShmLink> shm = std::atomic_load(&shm_link_);
+	if(nullptr == shm)
+	{
+		return;
+	}
+	std::weak_ptr<Session> weak = std::static_pointer_cast<Session>(shared_from_this());
+	shm->Start([weak](const std::shared_ptr<Network::Tcp::Packet>& packet) {
+		std::shared_ptr<Session> self = weak.lock();
+		if(nullptr == self)
+		{
+			return;
+		}
+		// same as frames read from the link
+		self->strand.post(std::bind(&Network::Tcp::Dispatcher<Session>::OnRecvMsg, &Singleton<Network::Tcp::Dispatcher<Session>>::GetInstance(), self, packet));
+	});
+}
+
+void Session::CloseShmLink()
+{
+	// closed before the lock. sender waiting on full ring holds it until close
+	std::shared_ptr<ShmLink> shm = std::atomic_load(&shm_link_);
+	if(nullptr != shm)
+	{
+		shm->Close();
+	}
+	std::shared_ptr<ShmLink> offer;
+	{
+		std::lock_guard<std::mutex> lo(batch_[0].lock);
+		shm = std::atomic_exchange(&shm_link_, std::shared_ptr<ShmLink>());
+		offer.swap(shm_offer_);
+	}
+	for(const std::shared_ptr<ShmLink>& s : { shm, offer })
+	{
+		if(nullptr != s)
+		{
+			s->Close();
+		}
+	}
+}
+
+void Session::SetLoad(const ServerLoad& load)
+{
+	cpu.store(load.cpu, std::memory_order_relaxed);
+	session_count.store(load.session_count, std::memory_order_relaxed);
+	queue_depth.store(load.queue_depth, std::memory_order_relaxed);
+	weight.store(load.weight, std::memory_order_relaxed);
+}
+
+Json::Value Session::State() const
+{
+	Json::Value root;
+	root["service_name"] = address.service_name;
+	root["id"] = address.id;
+	root["outstanding"] = outstanding.load(std::memory_order_relaxed);
+	root["cpu"] = cpu.load(std::memory_order_relaxed);
+	root["session_count"] = session_count.load(std::memory_order_relaxed);
+	root["queue_depth"] = queue_depth.load(std::memory_order_relaxed);
+	root["weight"] = weight.load(std::memory_order_relaxed);
+	root["send_frame_count"] = (Json::UInt64)send_frame_count.load(std::memory_order_relaxed);
+	root["send_batch_count"] = (Json::UInt64)send_batch_count.load(std::memory_order_relaxed);
+	root["link_count"] = link_count.load(std::memory_order_relaxed);
+	root["suspected"] = suspected.load(std::memory_order_relaxed);
+	root["phi"] = failure_detector.Phi(Timer::Now());
+	const std::shared_ptr<ShmLink> shm = std::atomic_load(&shm_link_);
+	if(nullptr != shm)
+	{
+		root["shm"] = shm->State();
+	}
+	return root;
+}
+
+LocalSession::LocalSession() : Session(), ip_(boost::asio::ip::address_v4::loopback())
+{
+	features = FEATURE_ALL;
+}
+
+LocalSession::~LocalSession()
+{
+}
+
+bool LocalSession::Init()
+{
+	if(false == Session::Init())
+	{
+		return false;
+	}
+	remote_address = &ip_;
+	return true;
+}
+
+bool LocalSession::BatchSend(const std::shared_ptr<Buffer>& buffer, uint64_t key)
+{
+	// the same envelope may be queued to other servers. inner frame is copied, not serialized again
+	std::shared_ptr<Network::Tcp::Packet> packet = Network::Tcp::Packet::Create();
+	if(nullptr == packet)
+	{
+		LOG(GAMNET_ERR, "can not create packet");
+		return false;
+	}
+	packet->Append(buffer->ReadPtr(), buffer->Size());
+	send_frame_count.fetch_add(1, std::memory_order_relaxed);
+	send_batch_count.fetch_add(1, std::memory_order_relaxed);
+
+	// posted, not dispatched. handler sending to its own server returns before the message is handled, like remote one
+	std::shared_ptr<Session> self = std::static_pointer_cast<Session>(shared_from_this());
+	strand.post([self, packet]() {
+		Address from = self->address;
+		from.msg_seq = packet->GetSEQ();
+		if(false == packet->OpenEnvelope())
+		{
+			LOG(GAMNET_ERR, "router message format error");
+			return;
+		}
+		Singleton<Dispatcher>::GetInstance().OnRecvMsg(from, packet);
+	});
+	return true;
+}
+
 }}} /* namespace Gamnet */
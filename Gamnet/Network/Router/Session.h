@@ -1,12 +1,26 @@
 #ifndef GAMNET_NETWORK_ROUTER_SESSION_H
 #define GAMNET_NETWORK_ROUTER_SESSION_H
 
+#include <atomic>
 #include "MsgRouter.h"
+#include "ShmLink.h"
 #include "../Tcp/Session.h"
+#include "../../Library/FailureDetector.h"
 #include "../../Library/Timer.h"
 
 namespace Gamnet { namespace Network { namespace Router {
 
+// target of 'Router::Connect'. kept by its sessions to open more links and to reconnect
+struct Connector
+{
+	std::string host;
+	int port;
+	int timeout;
+	uint32_t link_count;
+	std::function<void(const Address& addr)> onConnect;
+	std::function<void(const Address& addr)> onClose;
+};
+
 class Session : public Network::Tcp::Session {
 private :
 	struct AnswerWatingSessionManager
@@ -62,6 +76,43 @@ private :
 			mapSession_.clear();
 		}
 	};
+
+public:
+	enum {
+		DEFAULT_WEIGHT = 100, // until first heartbeat
+		MAX_LINK_COUNT = 16
+	};
+	// what the remote router supports. sent by Handshake after SetAddress_Req and SetAddress_Ans, none for older build
+	enum FEATURE {
+		FEATURE_ENVELOPE = 0x01, // MsgRouter_Envelope_Ntf. MsgRouter_SendMsg_Ntf is sent to router without it
+		FEATURE_SHM_LINK = 0x02, // MsgRouter_ShmLink_Req
+		FEATURE_ALL = FEATURE_ENVELOPE | FEATURE_SHM_LINK
+	};
+private :
+	// router frames waiting to go out together in one write. one for each link to the server
+	struct SendBatch
+	{
+		std::mutex lock;
+		std::shared_ptr<Network::Link> link; // lane link. first one uses 'Session::link'
+		std::vector<std::shared_ptr<Buffer>> buffers;
+		size_t size;
+		size_t frame_count; // frame of older router is two buffers
+		bool scheduled;
+		Timer timer;
+	};
+	SendBatch batch_[MAX_LINK_COUNT];
+	// frames go through it instead of links once it is attached. changed under lock of the first batch
+	std::shared_ptr<ShmLink> shm_link_; // std::atomic_load
+
+	std::shared_ptr<ShmLink> shm_offer_; // sent to the server by ShmLink_Req, not answered yet
+
+	// link of 'key' and its batch lock held in 'lo'. lane of 'key % link_count', or the first link while the lane is not attached
+	std::shared_ptr<Network::Link> LockLink(uint64_t key, uint32_t& index, std::unique_lock<std::mutex>& lo);
+	// 'buffers' of one frame go out together through the same link
+	bool BatchSend(const std::shared_ptr<Buffer>* buffers, size_t count, uint64_t key);
+
+	void FlushBatch(uint32_t index);
+	void FlushBatch(SendBatch& batch, const std::shared_ptr<Link>& link);
 public:
 	/*
 	struct Init {
@@ -74,6 +125,24 @@ public:
 	virtual ~Session();
 
 	Address address;
+	std::atomic<uint32_t> features; // FEATURE bits of the remote router. set before its address is registered
+	// 'outstanding' is Router::Call waiting for answer of this server. others are reported by its heartbeat
+	std::atomic<uint32_t> outstanding;
+	std::atomic<uint32_t> cpu;
+	std::atomic<uint32_t> session_count;
+	std::atomic<uint32_t> queue_depth;
+	std::atomic<uint32_t> weight;
+	std::atomic<uint64_t> send_frame_count;
+	std::atomic<uint64_t> send_batch_count;
+	// links to the server including 'link'. others are lanes, each of them has its own session with 'link_index' and 'primary'
+	std::atomic<uint32_t> link_count;
+	uint32_t link_index;
+	std::weak_ptr<Session> primary;
+	std::shared_ptr<Connector> connector; // null for accepted session
+	uint32_t retry_count;
+	// set when heartbeat is late over 'LinkManager::suspect_threshold'. any-cast and multi-cast skip the server until next heartbeat
+	std::atomic<bool> suspected;
+	mutable FailureDetector failure_detector;
 	std::function<void(const Address& addr)> onRouterConnect;
 	std::function<void(const Address& addr)> onRouterClose;
 
@@ -82,6 +151,52 @@ public:
 	virtual void OnConnect();
 	virtual void OnClose(int reason) override;
 	virtual void OnDestroy() override;
+
+	/*!
+	 * \brief queues router frame to batch. batch is written when it reaches 'LinkManager::batch_size',
+	 * 		or after 'LinkManager::batch_delay' ms. delay 0 flushes after the handlers already queued on the link strand
+	 * \param key frames of the same key go through the same link in order. lane not joined yet is replaced by the first link
+	 * \param buffer envelope written by 'Packet::WriteEnvelope'. remote router without FEATURE_ENVELOPE gets
+	 * 		MsgRouter_SendMsg_Ntf header and the inner frame of the envelope by one gather write, so the frame is not copied
+	 */
+	virtual bool BatchSend(const std::shared_ptr<Buffer>& buffer, uint64_t key = 0);
+	/*!
+	 * \brief MsgRouter_SendMsg_Ntf of the inner frame of 'buffer' envelope, as its header and the view of the frame
+	 */
+	static bool WriteSendMsgNtf(const std::shared_ptr<Buffer>& buffer, std::shared_ptr<Buffer> (&buffers)[2]);
+	bool AttachLane(uint32_t index, const std::shared_ptr<Network::Link>& link);
+	// index of the link which frames of 'key' go through now. 0 is the first link
+	uint32_t GetLinkIndex(uint64_t key);
+	void DetachLane(uint32_t index, const std::shared_ptr<Network::Link>& link);
+	void CloseLanes();
+	/*!
+	 * \brief frames queued to the first link are flushed to it with 'reply' last, and frames after this go through 'shm'.
+	 * 		'reply' tells the switch to the other side, which starts reading 'shm' on it, so frames keep order across the switch
+	 */
+	void AttachShmLink(const std::shared_ptr<ShmLink>& shm, const std::shared_ptr<Buffer>& reply);
+	void OfferShmLink(const std::shared_ptr<ShmLink>& shm);
+	std::shared_ptr<ShmLink> TakeShmOffer();
+	// starts reader thread of attached shared memory. frames are dispatched on the strand of this session
+	void StartShmLink();
+	void CloseShmLink();
+	void SetLoad(const ServerLoad& load);
+	Json::Value State() const;
+};
+
+/*!
+ * \brief this server in its own routing table. registered by Listen for uni-cast to its own address only, so those sends skip the socket.
+ * 		it is not a member of its service for multi-cast, any-cast and hash-cast
+ */
+class LocalSession : public Session
+{
+	boost::asio::ip::address ip_;
+public :
+	LocalSession();
+	virtual ~LocalSession();
+
+	virtual bool Init() override;
+	// dispatches envelope on the strand of this session, as if it came from a link
+	virtual bool BatchSend(const std::shared_ptr<Buffer>& buffer, uint64_t key = 0) override;
 };
 
 }}} /* namespace Gamnet */
@@ -0,0 +1,356 @@
+#include "ShmLink.h"
+#include "../../Log/Log.h"
+#include "../../Library/Singleton.h"
+#include <algorithm>
+#include <chrono>
+#include <new>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+
+namespace Gamnet { namespace Network { namespace Router {
+
+enum {
+	SHM_MAGIC = 0x474d5348 // 'GMSH'
+};
+
+struct ShmLink::Ring
+{
+	alignas(64) std::atomic<uint64_t> head; // moved by reader
+	alignas(64) std::atomic<uint64_t> tail; // moved by writer
+	alignas(64) std::atomic<uint32_t> waiting; // futex word. 1 while reader sleeps
+	std::atomic<uint32_t> closed; // set by either side
+};
+
+struct ShmLink::Header
+{
+	std::atomic<uint32_t> magic; // set last by creator
+	uint32_t size;
+	Ring ring[2];
+};
+
+static std::atomic<uint32_t> segment_seq(0);
+
+#ifdef __linux__
+static void FutexWait(std::atomic<uint32_t>* word, uint32_t value, int timeout)
+{
+	struct timespec ts;
+	ts.tv_sec = timeout / 1000;
+	ts.tv_nsec = (timeout % 1000) * 1000000;
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, value, &ts, nullptr, 0);
+}
+
+static void FutexWake(std::atomic<uint32_t>* word)
+{
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+#endif
+
+ShmLink::ShmLink() : size_(0), segment_(nullptr), segment_size_(0), owner_(false), send_ring_(nullptr), recv_ring_(nullptr), send_data_(nullptr), recv_data_(nullptr), closed_(false), send_frame_count_(0), recv_frame_count_(0), wait_count_(0)
+{
+}
+
+ShmLink::~ShmLink()
+{
+	Close();
+#ifdef __linux__
+	if(nullptr != segment_)
+	{
+		munmap(segment_, segment_size_);
+	}
+#endif
+}
+
+std::shared_ptr<ShmLink> ShmLink::Create(uint32_t size)
+{
+#ifdef __linux__
+	if(MIN_SIZE > size)
+	{
+		size = MIN_SIZE;
+	}
+	std::shared_ptr<ShmLink> link(new ShmLink());
+	link->name_ = Format("/gamnet.router.", getpid(), ".", ++segment_seq);
+	link->size_ = size;
+	int fd = shm_open(link->name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(0 > fd)
+	{
+		LOG(GAMNET_ERR, "[Router] can not create shared memory(name:", link->name_, ", errno:", errno, ")");
+		return nullptr;
+	}
+	const bool mapped = (0 == ftruncate(fd, sizeof(Header) + (size_t)size * 2)) && link->Map(fd, true);
+	close(fd);
+	if(false == mapped)
+	{
+		LOG(GAMNET_ERR, "[Router] can not map shared memory(name:", link->name_, ", errno:", errno, ")");
+		shm_unlink(link->name_.c_str());
+		return nullptr;
+	}
+	return link;
+#else
+	return nullptr;
+#endif
+}
+
+std::shared_ptr<ShmLink> ShmLink::Open(const std::string& name, uint32_t size)
+{
+#ifdef __linux__
+	if(MIN_SIZE > size || 0 != name.find("/gamnet.router."))
+	{
+		LOG(GAMNET_ERR, "[Router] invalid shared memory(name:", name, ", size:", size, ")");
+		return nullptr;
+	}
+	std::shared_ptr<ShmLink> link(new ShmLink());
+	link->name_ = name;
+	link->size_ = size;
+	int fd = shm_open(name.c_str(), O_RDWR, 0600);
+	if(0 > fd)
+	{
+		LOG(GAMNET_ERR, "[Router] can not open shared memory(name:", name, ", errno:", errno, ")");
+		return nullptr;
+	}
+	struct stat st;
+	const bool mapped = (0 == fstat(fd, &st) && (off_t)(sizeof(Header) + (size_t)size * 2) == st.st_size) && link->Map(fd, false);
+	close(fd);
+	// both processes have it mapped now
+	shm_unlink(name.c_str());
+	if(false == mapped)
+	{
+		LOG(GAMNET_ERR, "[Router] can not map shared memory(name:", name, ", errno:", errno, ")");
+		return nullptr;
+	}
+	return link;
+#else
+	return nullptr;
+#endif
+}
+
+bool ShmLink::Map(int fd, bool owner)
+{
+#ifdef __linux__
+	segment_size_ = sizeof(Header) + (size_t)size_ * 2;
+	void* segment = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(MAP_FAILED == segment)
+	{
+		return false;
+	}
+	segment_ = segment;
+	owner_ = owner;
+	Header* header = static_cast<Header*>(segment_);
+	if(true == owner)
+	{
+		new (header) Header();
+		header->size = size_;
+		for(Ring& ring : header->ring)
+		{
+			ring.head = 0;
+			ring.tail = 0;
+			ring.waiting = 0;
+			ring.closed = 0;
+		}
+		header->magic.store(SHM_MAGIC, std::memory_order_release);
+	}
+	else if(SHM_MAGIC != header->magic.load(std::memory_order_acquire) || size_ != header->size)
+	{
+		return false;
+	}
+	char* data = static_cast<char*>(segment_) + sizeof(Header);
+	send_ring_ = &header->ring[true == owner ? 0 : 1];
+	recv_ring_ = &header->ring[true == owner ? 1 : 0];
+	send_data_ = data + (true == owner ? 0 : size_);
+	recv_data_ = data + (true == owner ? size_ : 0);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool ShmLink::Send(const std::shared_ptr<Buffer>& buffer)
+{
+#ifdef __linux__
+	const uint32_t length = (uint32_t)buffer->Size();
+	const uint64_t record = sizeof(uint32_t) + length;
+	if(size_ < record)
+	{
+		return false;
+	}
+	const uint64_t tail = send_ring_->tail.load(std::memory_order_relaxed);
+	if(size_ < tail + record - send_ring_->head.load(std::memory_order_acquire))
+	{
+		// reader thread of the other process drains the ring by itself, so this never waits for a handler.
+		// but the process may hang without closing, and the lock of the sender is held meanwhile
+		wait_count_.fetch_add(1, std::memory_order_relaxed);
+		const auto expire = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEND_TIMEOUT);
+		uint32_t spin = 0;
+		while(size_ < tail + record - send_ring_->head.load(std::memory_order_acquire))
+		{
+			if(true == closed_ || 0 != send_ring_->closed.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+			if(SPIN_COUNT > spin++)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			if(expire < std::chrono::steady_clock::now())
+			{
+				LOG(GAMNET_ERR, "[Router] shared memory is not drained(name:", name_, ", timeout:", (int)SEND_TIMEOUT, "ms)");
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+	}
+	if(true == closed_ || 0 != send_ring_->closed.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+	auto write = [this](uint64_t pos, const char* src, uint64_t len) {
+		const uint64_t offset = pos % size_;
+		const uint64_t first = std::min(len, size_ - offset);
+		std::memcpy(send_data_ + offset, src, first);
+		std::memcpy(send_data_, src + first, len - first);
+	};
+	write(tail, (const char*)&length, sizeof(uint32_t));
+	write(tail + sizeof(uint32_t), buffer->ReadPtr(), length);
+	send_ring_->tail.store(tail + record, std::memory_order_seq_cst);
+	send_frame_count_.fetch_add(1, std::memory_order_relaxed);
+	if(0 != send_ring_->waiting.load(std::memory_order_seq_cst))
+	{
+		send_ring_->waiting.store(0, std::memory_order_relaxed);
+		FutexWake(&send_ring_->waiting);
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ShmLink::Start(const RecvHandler& handler)
+{
+	reader_ = std::thread(std::bind(&ShmLink::Read, this, handler));
+}
+
+void ShmLink::Read(const RecvHandler& handler)
+{
+#ifdef __linux__
+	// reader and io thread of both processes. spin on fewer cores takes the core from the thread making the next frame
+	const bool spin = (4 <= std::thread::hardware_concurrency());
+	bool idle = false;
+	std::chrono::steady_clock::time_point idle_since;
+	while(false == closed_)
+	{
+		const uint64_t head = recv_ring_->head.load(std::memory_order_relaxed);
+		if(head == recv_ring_->tail.load(std::memory_order_acquire))
+		{
+			if(0 != recv_ring_->closed.load(std::memory_order_relaxed))
+			{
+				break;
+			}
+			// by time, not by count, so the spin is as long as a round trip whatever yield costs on this host
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			if(false == idle)
+			{
+				idle = true;
+				idle_since = now;
+			}
+			if(true == spin && idle_since + std::chrono::microseconds(SPIN_TIME) > now)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			// writer checks 'waiting' after it moves 'tail', so one of the two sees the other
+			recv_ring_->waiting.store(1, std::memory_order_seq_cst);
+			if(head == recv_ring_->tail.load(std::memory_order_seq_cst))
+			{
+				FutexWait(&recv_ring_->waiting, 1, SLEEP_TIMEOUT);
+			}
+			recv_ring_->waiting.store(0, std::memory_order_relaxed);
+			continue;
+		}
+		idle = false;
+
+		auto read = [this](uint64_t pos, char* dst, uint64_t len) {
+			const uint64_t offset = pos % size_;
+			const uint64_t first = std::min(len, size_ - offset);
+			std::memcpy(dst, recv_data_ + offset, first);
+			std::memcpy(dst + first, recv_data_, len - first);
+		};
+		uint32_t length = 0;
+		read(head, (char*)&length, sizeof(uint32_t));
+		std::shared_ptr<Network::Tcp::Packet> packet = Network::Tcp::Packet::Create();
+		if(nullptr == packet || packet->Available() < length)
+		{
+			LOG(GAMNET_ERR, "[Router] can not create packet(name:", name_, ", length:", length, ")");
+			break;
+		}
+		read(head + sizeof(uint32_t), packet->WritePtr(), length);
+		packet->writeCursor_ += length;
+		recv_ring_->head.store(head + sizeof(uint32_t) + length, std::memory_order_release);
+		recv_frame_count_.fetch_add(1, std::memory_order_relaxed);
+		try {
+			handler(packet);
+		}
+		catch (const std::exception& e)
+		{
+			LOG(GAMNET_ERR, "unhandled exception occurred(reason:", e.what(), ")");
+		}
+	}
+#endif
+}
+
+void ShmLink::Close()
+{
+	if(true == closed_.exchange(true))
+	{
+		return;
+	}
+#ifdef __linux__
+	if(nullptr != segment_)
+	{
+		// both directions, so the other writer stops waiting and the other reader leaves
+		for(Ring* ring : { send_ring_, recv_ring_ })
+		{
+			ring->closed.store(1, std::memory_order_seq_cst);
+			ring->waiting.store(0, std::memory_order_relaxed);
+			FutexWake(&ring->waiting);
+		}
+		if(true == owner_)
+		{
+			// other process may not have opened it
+			shm_unlink(name_.c_str());
+		}
+	}
+#endif
+	if(true == reader_.joinable())
+	{
+		if(std::this_thread::get_id() == reader_.get_id())
+		{
+			reader_.detach();
+		}
+		else
+		{
+			reader_.join();
+		}
+	}
+}
+
+Json::Value ShmLink::State() const
+{
+	Json::Value root;
+	root["name"] = name_;
+	root["size"] = size_;
+	root["send_frame_count"] = (Json::UInt64)send_frame_count_.load(std::memory_order_relaxed);
+	root["recv_frame_count"] = (Json::UInt64)recv_frame_count_.load(std::memory_order_relaxed);
+	root["wait_count"] = (Json::UInt64)wait_count_.load(std::memory_order_relaxed);
+	return root;
+}
+
+}}}
@@ -0,0 +1,76 @@
+#ifndef GAMNET_NETWORK_ROUTER_SHMLINK_H_
+#define GAMNET_NETWORK_ROUTER_SHMLINK_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "../Tcp/Packet.h"
+#include "../../Library/Json/json.h"
+
+namespace Gamnet { namespace Network { namespace Router {
+
+/*!
+ * \brief router frames between two processes on the same host through shared memory
+ *
+ * 		segment has two single producer single consumer rings, one for each direction. writer copies the frame
+ * 		and moves 'tail', reader thread copies it out and moves 'head'. reader spins SPIN_TIME on empty ring, then
+ * 		sleeps on futex word of the ring and writer wakes it only if it is sleeping. (linux only. elsewhere 'Create'
+ * 		and 'Open' fail and router keeps tcp)
+ * 		segment name is unlinked as soon as both processes map it, so nothing is left after a crash.
+ */
+class ShmLink
+{
+public :
+	typedef std::function<void(const std::shared_ptr<Network::Tcp::Packet>& packet)> RecvHandler;
+	enum {
+		SPIN_COUNT = 1000, // polls of full ring before the writer sleeps
+		SPIN_TIME = 100, // us. reader polls empty ring this long after the last frame, so the answer of a round trip doesn't wait for futex wake. on 4 cores or more
+		SLEEP_TIMEOUT = 100, // ms. sleeping reader checks close on this interval
+		SEND_TIMEOUT = 1000, // ms. writer gives up on a full ring the other process doesn't drain
+		MIN_SIZE = 65536 * 2
+	};
+private :
+	struct Ring;
+	struct Header;
+
+	std::string name_;
+	uint32_t size_; // bytes of each ring
+	void* segment_;
+	size_t segment_size_;
+	bool owner_;
+	Ring* send_ring_;
+	Ring* recv_ring_;
+	char* send_data_;
+	char* recv_data_;
+	std::atomic<bool> closed_;
+	std::thread reader_;
+	std::atomic<uint64_t> send_frame_count_;
+	std::atomic<uint64_t> recv_frame_count_;
+	std::atomic<uint64_t> wait_count_; // writer waited for space
+
+	ShmLink();
+	bool Map(int fd, bool owner);
+	void Read(const RecvHandler& handler);
+public :
+	~ShmLink();
+
+	// creates new segment. creator writes the first ring
+	static std::shared_ptr<ShmLink> Create(uint32_t size);
+	// maps segment made by 'Create' of the other process
+	static std::shared_ptr<ShmLink> Open(const std::string& name, uint32_t size);
+
+	const std::string& GetName() const { return name_; }
+	uint32_t GetSize() const { return size_; }
+	// waits while ring is full, up to SEND_TIMEOUT. false if the link is closed or the wait timed out. called under lock of the sender
+	bool Send(const std::shared_ptr<Buffer>& buffer);
+	// starts reader thread. 'handler' is called on it in order of frames
+	void Start(const RecvHandler& handler);
+	// tells the other process and stops reader thread. not from 'handler'
+	void Close();
+	Json::Value State() const;
+};
+
+}}}
+#endif
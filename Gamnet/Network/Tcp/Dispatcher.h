@@ -85,7 +85,7 @@ public:
 		auto itr = mapHandlerFunction_.find(msg_id);
 		if(itr == mapHandlerFunction_.end())
 		{
-			LOG(GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ", session_key:", session->session_key,",packet_size:", packet->Size(), ", packet_read_cursor:", packet->readCursor_, ")");
+			LOG_RATE(10, 100, GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ", session_key:", session->session_key,",packet_size:", packet->Size(), ", packet_read_cursor:", packet->readCursor_, ")");
 			std::shared_ptr<Network::Link> link = session->link;
 			link->strand.wrap(std::bind(&Network::Link::Close, link, ErrorCode::NullPointerError))();
 			return ;
@@ -95,7 +95,7 @@ public:
 		std::shared_ptr<IHandler> handler = handler_function.factory_->GetHandler(&session->handler_container, msg_id);
 		if(NULL == handler)
 		{
-			LOG(GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ", session_key:", session->session_key,",packet_size:", packet->Size(), ", packet_read_cursor:", packet->readCursor_, ")");
+			LOG_RATE(10, 100, GAMNET_ERR, "can't find handler function(msg_id:", msg_id, ", session_key:", session->session_key,",packet_size:", packet->Size(), ", packet_read_cursor:", packet->readCursor_, ")");
 			std::shared_ptr<Network::Link> link = session->link;
 			link->strand.wrap(std::bind(&Network::Link::Close, link, ErrorCode::NullPointerError))();
 			return;
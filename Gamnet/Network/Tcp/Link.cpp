@@ -1,5 +1,6 @@
 #include "Link.h"
 #include "LinkManager.h"
+#include <algorithm>
 
 namespace Gamnet { namespace Network { namespace Tcp {
 
@@ -30,33 +31,42 @@ namespace Gamnet { namespace Network { namespace Tcp {
 
 	void Link::OnRead(const std::shared_ptr<Buffer>& buffer)
 	{
-		recv_packet->Append(buffer->ReadPtr(), buffer->Size());
-		while (Packet::HEADER_SIZE <= (int)recv_packet->Size())
+		// partial packet left by the last read and a full read may not fit together. appended as much as it fits
+		const char* readPtr = buffer->ReadPtr();
+		size_t readSize = buffer->Size();
+		while (0 < readSize)
 		{
-			uint16_t totalLength = recv_packet->GetLength();
-			if (Packet::HEADER_SIZE > totalLength)
+			const size_t appendSize = std::min(readSize, recv_packet->Available());
+			recv_packet->Append(readPtr, appendSize);
+			readPtr += appendSize;
+			readSize -= appendSize;
+			while (Packet::HEADER_SIZE <= (int)recv_packet->Size())
 			{
-				LOG(GAMNET_ERR, "buffer underflow(read size:", totalLength, ")");
-				Close(ErrorCode::BufferUnderflowError);
-				return;
-			}
+				uint16_t totalLength = recv_packet->GetLength();
+				if (Packet::HEADER_SIZE > totalLength)
+				{
+					LOG(GAMNET_ERR, "buffer underflow(read size:", totalLength, ")");
+					Close(ErrorCode::BufferUnderflowError);
+					return;
+				}
 
-			if (totalLength >= recv_packet->Capacity())
-			{
-				LOG(GAMNET_ERR, "buffer overflow(read size:", totalLength, ")");
-				Close(ErrorCode::BufferOverflowError);
-				return;
-			}
+				if (totalLength >= recv_packet->Capacity())
+				{
+					LOG(GAMNET_ERR, "buffer overflow(read size:", totalLength, ")");
+					Close(ErrorCode::BufferOverflowError);
+					return;
+				}
 
-			if (totalLength > (uint16_t)recv_packet->Size())
-			{
-				break;
-			}
+				if (totalLength > (uint16_t)recv_packet->Size())
+				{
+					break;
+				}
 
-			std::shared_ptr<Packet> packet = recv_packet;
-			recv_packet = Packet::Create();
-			recv_packet->Append(packet->ReadPtr() + totalLength, packet->Size() - totalLength);
-			link_manager->OnRecvMsg(shared_from_this(), packet);
+				std::shared_ptr<Packet> packet = recv_packet;
+				recv_packet = Packet::Create();
+				recv_packet->Append(packet->ReadPtr() + totalLength, packet->Size() - totalLength);
+				link_manager->OnRecvMsg(shared_from_this(), packet);
+			}
 		}
 	}
 }}}
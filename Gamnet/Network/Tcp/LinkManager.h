@@ -116,7 +116,7 @@ public :
 		std::shared_ptr<Link> tcpLink = std::static_pointer_cast<Link>(link);
 		if(msgSEQ <= tcpLink->msg_seq)
 		{
-			LOG(WRN, "[link_key:", link->link_key, "] discard message(msg_id:", packet->GetID(), ", received msg_seq:", msgSEQ, ", expected msg_seq:", tcpLink->msg_seq + 1, ")");
+			LOG_EVERY(10, 1000, WRN, "[link_key:", link->link_key, "] discard message(msg_id:", packet->GetID(), ", received msg_seq:", msgSEQ, ", expected msg_seq:", tcpLink->msg_seq + 1, ")");
 			return;
 		}
 
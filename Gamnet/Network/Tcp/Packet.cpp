@@ -42,4 +42,30 @@ std::shared_ptr<Packet> Packet::Create()
 {
 	return packetPool_.Create();
 }
+
+// data points into the viewed buffer, and is not freed by ~Buffer
+struct BufferView : public Buffer
+{
+	std::shared_ptr<Buffer> buffer;
+	BufferView(const std::shared_ptr<Buffer>& buffer, size_t offset, size_t size) : Buffer(0), buffer(buffer)
+	{
+		delete [] data;
+		data = buffer->data + buffer->readCursor_ + offset;
+		writeCursor_ = size;
+		bufSize_ = size;
+	}
+	virtual ~BufferView()
+	{
+		data = NULL;
+	}
+};
+
+std::shared_ptr<Buffer> Packet::View(const std::shared_ptr<Buffer>& buffer, size_t offset, size_t size)
+{
+	if(buffer->Size() < offset + size)
+	{
+		return nullptr;
+	}
+	return std::make_shared<BufferView>(buffer, offset, size);
+}
 }}}
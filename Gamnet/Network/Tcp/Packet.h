@@ -36,6 +36,24 @@ public:
 		}
 	};
 
+private :
+	template <class MSG, class EXT>
+	struct Extended
+	{
+		enum { MSG_ID = MSG::MSG_ID };
+		const MSG& msg;
+		const EXT& ext;
+		Extended(const MSG& msg, const EXT& ext) : msg(msg), ext(ext) {}
+		size_t Size() const
+		{
+			return msg.Size() + ext.Size();
+		}
+		bool Store(char** buf) const
+		{
+			return msg.Store(buf) && ext.Store(buf);
+		}
+	};
+
 public :
 	struct Header {
 		uint16_t length;
@@ -65,6 +83,25 @@ public :
 		return true;
 	}
 
+	/*
+	 * byte stream -> Msg and 'ext' written after it by 'Write(msg_seq, msg, ext)'. 'ext' is left as is if the peer didn't write it
+	 */
+	template <class MSG, class EXT>
+	bool Read(MSG& msg, EXT& ext)
+	{
+		size_t bodyLength = GetLength() - HEADER_SIZE;
+		const char* pBuf = ReadPtr() + HEADER_SIZE;
+		if(false == msg.Load(&pBuf, bodyLength))
+		{
+			return false;
+		}
+		if(0 == bodyLength)
+		{
+			return true;
+		}
+		return ext.Load(&pBuf, bodyLength);
+	}
+
 	template <class MSG>
 	bool Write(uint32_t msg_seq, const MSG& msg)
 	{
@@ -94,6 +131,14 @@ public :
 		this->writeCursor_ += total_length;
 		return true;
 	}
+	/*
+	 * Msg followed by 'ext'. peer of older build reads 'msg' and ignores the rest
+	 */
+	template <class MSG, class EXT>
+	bool Write(uint32_t msg_seq, const MSG& msg, const EXT& ext)
+	{
+		return Write(msg_seq, Extended<MSG, EXT>(msg, ext));
+	}
 	bool Write(const Header& header, const char* buf, size_t length)
 	{
 		Clear();
@@ -120,7 +165,78 @@ public :
 		return true;
 	}
 
+	/*
+	 * Msg -> byte stream wrapped by envelope header. body of envelope is the whole frame of 'msg',
+	 * so relaying it neither serializes nor copies the message again
+	 */
+	template <class MSG>
+	bool WriteEnvelope(uint32_t envelope_id, uint32_t envelope_seq, uint32_t msg_seq, const MSG& msg)
+	{
+		Clear();
+		size_t total_length = msg.Size() + HEADER_SIZE * 2;
+		uint32_t msg_id = MSG::MSG_ID;
+
+		if(Capacity() <= total_length)
+		{
+			LOG(GAMNET_WRN, "packet max capacity over(msg_id:", msg_id, ", size:", total_length, ")");
+			return false;
+		}
+
+		(*(uint16_t*)(data + OFFSET_LENGTH)) = (uint16_t)total_length;
+		(*(uint32_t*)(data + OFFSET_MSGSEQ)) = envelope_seq;
+		(*(uint32_t*)(data + OFFSET_MSGID)) = envelope_id;
+		(*(uint16_t*)(data + HEADER_SIZE + OFFSET_LENGTH)) = (uint16_t)(total_length - HEADER_SIZE);
+		(*(uint32_t*)(data + HEADER_SIZE + OFFSET_MSGSEQ)) = msg_seq;
+		(*(uint32_t*)(data + HEADER_SIZE + OFFSET_MSGID)) = msg_id;
+		char* pBuf = data + HEADER_SIZE * 2;
+		if(false == msg.Store(&pBuf))
+		{
+			return false;
+		}
+		this->writeCursor_ += total_length;
+		return true;
+	}
+
+	/*
+	 * raw frame -> envelope. one copy for callers which have serialized frame only
+	 */
+	bool WriteEnvelope(uint32_t envelope_id, uint32_t envelope_seq, const char* frame, size_t length)
+	{
+		Header header;
+		header.msg_id = envelope_id;
+		header.msg_seq = envelope_seq;
+		return Write(header, frame, length);
+	}
+
+	/*
+	 * moves read cursor to the frame in envelope body. after this the packet reads as the inner message without copy
+	 */
+	bool OpenEnvelope()
+	{
+		const uint16_t length = GetLength();
+		if(Size() < length || HEADER_SIZE * 2 > length)
+		{
+			return false;
+		}
+		if(length - HEADER_SIZE != *((uint16_t*)(data + readCursor_ + HEADER_SIZE + OFFSET_LENGTH)))
+		{
+			return false;
+		}
+		readCursor_ += HEADER_SIZE;
+		return true;
+	}
+
+	void SetSEQ(uint32_t msg_seq)
+	{
+		(*(uint32_t*)(data + readCursor_ + OFFSET_MSGSEQ)) = msg_seq;
+	}
+
 	static std::shared_ptr<Packet> Create();
+	/*
+	 * read only 'size' bytes of 'buffer' from 'offset' of its read pointer, without copy. 'buffer' is kept until the view is released.
+	 * lets a frame go out behind other header by one gather write
+	 */
+	static std::shared_ptr<Buffer> View(const std::shared_ptr<Buffer>& buffer, size_t offset, size_t size);
 	template <class MSG>
 	static bool Load(MSG& msg, std::shared_ptr<Packet> packet)
 	{
@@ -57,6 +57,30 @@ namespace Gamnet { namespace Network { namespace Tcp {
 		return session->AsyncSend(packet);
 	}
 
+	// 'msg' followed by 'ext', which peer of older build ignores. see Packet::Read(msg, ext)
+	template <class SESSION_T, class MSG, class EXT>
+	bool SendMsg(const std::shared_ptr<SESSION_T>& session, const MSG& msg, const EXT& ext)
+	{
+		std::shared_ptr<Link> link = std::static_pointer_cast<Link>(session->link);
+		if(nullptr == link)
+		{
+			LOG(GAMNET_ERR, "invalid link(session_key:", session->session_key, ", msg_id:", MSG::MSG_ID, ")");
+			return false;
+		}
+		std::shared_ptr<Packet> packet = Packet::Create();
+		if(nullptr == packet)
+		{
+			LOG(GAMNET_ERR, "fail to create packet instance(session_key:", session->session_key, ", msg_id:", MSG::MSG_ID, ")");
+			return false;
+		}
+		if(false == packet->Write(link->msg_seq, msg, ext))
+		{
+			LOG(GAMNET_ERR, "fail to serialize message(session_key:", session->session_key, ", msg_id:", MSG::MSG_ID, ")");
+			return false;
+		}
+		return session->AsyncSend(packet);
+	}
+
 	boost::asio::ip::address GetLocalAddress();
 	
 	template <class SESSION_T>
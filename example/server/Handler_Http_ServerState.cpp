@@ -17,6 +17,9 @@ void Handler_Http_ServerState::Recv_Req(const std::shared_ptr<Gamnet::Network::H
 	try
 	{
 		Json::Value root = Gamnet::Network::Tcp::ServerState<Session>();
+		root["log"] = Gamnet::Log::State();
+		root["router"] = Gamnet::Network::Router::State();
+		root["database"] = Gamnet::Database::State();
 		Json::StyledWriter writer;
 		res.context = writer.write(root);
 	}
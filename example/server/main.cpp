@@ -10,6 +10,9 @@ int main() {
 		Gamnet::Network::Tcp::Listen<Session>(20000, 8192, 60);
 		Gamnet::Network::Http::Listen(20001);
 
+		Gamnet::Network::Router::SetLoadReporter([](Gamnet::Network::Router::ServerLoad& load) {
+			load.session_count = (uint32_t)Gamnet::Singleton<Gamnet::Network::Tcp::LinkManager<Session>>::GetInstance().session_manager.Size();
+		});
 		Gamnet::Network::Router::Listen("GAME", 20002,
 			[](const Gamnet::Network::Router::Address& addr) {
 				LOG(DEV, "Router::OnAccept(address:", addr.service_name, ":", (int)addr.cast_type, ":", addr.id, ")");
@@ -6,7 +6,7 @@
 #include "generate_rule_python.h"
 #include "generate_rule_csharp.h"
 
-Compiler::Compiler(const std::string& sFileName, const std::string& sOption) : m_sFileName(sFileName), m_sOption(sOption)
+Compiler::Compiler(const std::string& sFileName, const std::string& sOption, bool bDirty) : m_sFileName(sFileName), m_sOption(sOption), m_bDirty(bDirty)
 {
 }
 
@@ -42,7 +42,7 @@ bool Compiler::Compile()
 	else if("cpp" == m_sOption)
 	{
 		sOutFile = sOutPath + sFileName + ".h";
-		pParser = new GenerateRuleCpp(sFileName);
+		pParser = new GenerateRuleCpp(sFileName, m_bDirty);
 	}
 	else if("cs" == m_sOption)
 	{
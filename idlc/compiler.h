@@ -10,8 +10,9 @@ class Compiler
 {
 	std::string 	m_sFileName;
 	std::string 	m_sOption;
+	bool			m_bDirty;
 public :
-	Compiler(const std::string& sFileName, const std::string& sOption);
+	Compiler(const std::string& sFileName, const std::string& sOption, bool bDirty = false);
 	~Compiler();
 
 	bool Compile();
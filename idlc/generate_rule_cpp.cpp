@@ -24,7 +24,7 @@ const std::string GenerateRuleCpp::ReplaceSpecialChar(const std::string& ori)
     return ret;
 }
 
-GenerateRuleCpp::GenerateRuleCpp(const std::string& sFileName) : Parser(sFileName)
+GenerateRuleCpp::GenerateRuleCpp(const std::string& sFileName, bool bDirty) : Parser(sFileName), m_bDirty(bDirty)
 {
 	SymbolInfo booleanInfo 	= { Token::TYPE_PRIMITIVE, 	"bool", "false" };
 	SymbolInfo charInfo 	= { Token::TYPE_PRIMITIVE, 	"char", "'\\0'" };
@@ -333,6 +333,107 @@ void GenerateRuleCpp::GenerateVariableSize(const Token::Base* typeInfo, const st
 	};
 }
 
+void GenerateRuleCpp::GenerateDirtyFlag(const Token::Message* pToken)
+{
+	// one bit per field. setters and 'Mutable_' accessors mark the bit, so only changed fields are saved
+	// fields of derived message are numbered after the parent's and its bits are kept apart from the parent's bitset,
+	// so 'IsDirty', 'ClearDirty' and 'VisitDirtyField' go up to the parent for the parent's fields
+	const std::string& sParent = pToken->m_sParentName;
+	const std::string sBegin = ("" == sParent ? std::string("0") : sParent + "::DIRTY_FIELD_COUNT");
+	int nFieldCount = 0;
+	std::cout << "\tenum DIRTY_FIELD {" << std::endl;
+	std::cout << "\t\tDIRTY_FIELD_BEGIN = " << sBegin << "," << std::endl;
+	for(const auto& itr : pToken->list_)
+	{
+		if(Token::TYPE_VARDECL == itr->Type())
+		{
+			std::cout << "\t\tDIRTY_" << static_cast<const Token::VarDecl*>(itr)->m_pVarName->GetName() << " = DIRTY_FIELD_BEGIN + " << nFieldCount++ << "," << std::endl;
+		}
+	}
+	std::cout << "\t\tDIRTY_FIELD_COUNT = DIRTY_FIELD_BEGIN + " << nFieldCount << std::endl;
+	std::cout << "\t};" << std::endl;
+	std::cout << "\tstd::bitset<DIRTY_FIELD_COUNT - DIRTY_FIELD_BEGIN> _dirty_;" << std::endl;
+
+	for(const auto& itr : pToken->list_)
+	{
+		if(Token::TYPE_VARDECL != itr->Type())
+		{
+			continue;
+		}
+		const Token::VarDecl* pVarDecl = static_cast<const Token::VarDecl*>(itr);
+		const std::string& sVarName = pVarDecl->m_pVarName->GetName();
+		const std::string sTypeName = TranslateVariableType(pVarDecl->m_pVarType);
+		const std::string sSet = "_dirty_.set(DIRTY_" + sVarName + " - DIRTY_FIELD_BEGIN);";
+		switch(pVarDecl->m_pVarType->Type())
+		{
+		case Token::TYPE_STATIC_ARRAY :
+			std::cout << "\t" << sTypeName << "* Mutable_" << sVarName << "() { " << sSet << " return " << sVarName << "; }" << std::endl;
+			break;
+		case Token::TYPE_PRIMITIVE :
+			std::cout << "\tvoid Set_" << sVarName << "(" << sTypeName << " value) { " << sVarName << " = value; " << sSet << " }" << std::endl;
+			std::cout << "\t" << sTypeName << "& Mutable_" << sVarName << "() { " << sSet << " return " << sVarName << "; }" << std::endl;
+			break;
+		default :
+			std::cout << "\tvoid Set_" << sVarName << "(const " << sTypeName << "& value) { " << sVarName << " = value; " << sSet << " }" << std::endl;
+			std::cout << "\t" << sTypeName << "& Mutable_" << sVarName << "() { " << sSet << " return " << sVarName << "; }" << std::endl;
+			break;
+		}
+	}
+
+	if("" == sParent)
+	{
+		std::cout << "\tbool IsDirty() const { return _dirty_.any(); }" << std::endl;
+		std::cout << "\tbool IsDirty(int field) const { return _dirty_.test(field); }" << std::endl;
+		std::cout << "\tvoid SetDirty(int field) { _dirty_.set(field); }" << std::endl;
+		std::cout << "\tvoid ClearDirty() { _dirty_.reset(); }" << std::endl;
+		std::cout << "\tvoid ClearDirty(int field) { _dirty_.reset(field); }" << std::endl;
+	}
+	else
+	{
+		std::cout << "\tbool IsDirty() const { return _dirty_.any() || " << sParent << "::IsDirty(); }" << std::endl;
+		std::cout << "\tbool IsDirty(int field) const { return DIRTY_FIELD_BEGIN > field ? " << sParent << "::IsDirty(field) : _dirty_.test(field - DIRTY_FIELD_BEGIN); }" << std::endl;
+		std::cout << "\tvoid SetDirty(int field) { if(DIRTY_FIELD_BEGIN > field) { " << sParent << "::SetDirty(field); } else { _dirty_.set(field - DIRTY_FIELD_BEGIN); } }" << std::endl;
+		std::cout << "\tvoid ClearDirty() { _dirty_.reset(); " << sParent << "::ClearDirty(); }" << std::endl;
+		std::cout << "\tvoid ClearDirty(int field) { if(DIRTY_FIELD_BEGIN > field) { " << sParent << "::ClearDirty(field); } else { _dirty_.reset(field - DIRTY_FIELD_BEGIN); } }" << std::endl;
+	}
+
+	// only scalar fields can be a column. containers and structs are left to the caller
+	std::cout << "\ttemplate <class VISITOR>" << std::endl;
+	std::cout << "\tvoid VisitDirtyField(VISITOR& visitor) const {" << std::endl;
+	if("" != sParent)
+	{
+		std::cout << "\t\t" << sParent << "::VisitDirtyField(visitor);" << std::endl;
+	}
+	for(const auto& itr : pToken->list_)
+	{
+		if(Token::TYPE_VARDECL != itr->Type())
+		{
+			continue;
+		}
+		const Token::VarDecl* pVarDecl = static_cast<const Token::VarDecl*>(itr);
+		const std::string& sVarName = pVarDecl->m_pVarName->GetName();
+		std::string sValue = "";
+		if(Token::TYPE_PRIMITIVE == pVarDecl->m_pVarType->Type() || Token::TYPE_STRING == pVarDecl->m_pVarType->Type())
+		{
+			sValue = sVarName;
+		}
+		else if(Token::TYPE_USERDEFINE == pVarDecl->m_pVarType->Type())
+		{
+			SYMBOL_TABLE::const_iterator symbol = m_mapSymbolTable.find(pVarDecl->m_pVarType->GetName());
+			if(m_mapSymbolTable.end() != symbol && Token::TYPE_ENUM == symbol->second.m_eType)
+			{
+				sValue = "(int32_t)" + sVarName;
+			}
+		}
+		if("" == sValue)
+		{
+			continue;
+		}
+		std::cout << "\t\tif(true == _dirty_.test(DIRTY_" << sVarName << " - DIRTY_FIELD_BEGIN)) { visitor(DIRTY_" << sVarName << ", \"" << sVarName << "\", " << sValue << "); }" << std::endl;
+	}
+	std::cout << "\t}" << std::endl;
+}
+
 bool GenerateRuleCpp::CompileMessage(const Token::Message* pToken)
 {
 	std::cout << "struct " << pToken->GetName();
@@ -365,6 +466,11 @@ bool GenerateRuleCpp::CompileMessage(const Token::Message* pToken)
 		}
 	}
 
+	if(true == m_bDirty)
+	{
+		GenerateDirtyFlag(pToken);
+	}
+
 	// Constructor
 	std::cout << "\t" << pToken->GetName() << "()";
 	if("" != pToken->m_sParentName)
@@ -479,6 +585,9 @@ bool GenerateRuleCpp::CompileMessage(const Token::Message* pToken)
 bool GenerateRuleCpp::CompileEnum(const Token::Enum* pToken)
 {
 	std::string default_value = "";
+	m_mapSymbolTable[pToken->GetName()].m_sTypeName = pToken->GetName();
+	m_mapSymbolTable[pToken->GetName()].m_eType = Token::TYPE_ENUM;
+	m_mapSymbolTable[pToken->GetName()].m_sInitValue = "";
 	//std::cout << "struct " << pToken->GetName() << " {" << std::endl;
 	std::cout << "enum class " << pToken->GetName() << " {" << std::endl;
 	//std::cout << "\tenum TYPE {" << std::endl;
@@ -571,6 +680,10 @@ bool GenerateRuleCpp::CompileStmtList(const Token::StmtList* pToken)
 	std::cout << "#include <map>" << std::endl;
 	std::cout << "#include <cstring>" << std::endl;
 	std::cout << "#include <stdint.h>" << std::endl;
+	if(true == m_bDirty)
+	{
+		std::cout << "#include <bitset>" << std::endl;
+	}
 
 	//GenerateStubCode();
 
@@ -13,8 +13,9 @@ class GenerateRuleCpp : public Token::Parser
 	};
 	typedef std::map<std::string, SymbolInfo> SYMBOL_TABLE;
 	SYMBOL_TABLE m_mapSymbolTable;
+	bool m_bDirty;
 public :
-	GenerateRuleCpp(const std::string& sFileName);
+	GenerateRuleCpp(const std::string& sFileName, bool bDirty = false);
 
 	virtual bool CompileLiteralBlock(const Token::LiteralBlock* pToken);
 	virtual bool CompileTypedef(const Token::Typedef* pToken);
@@ -28,6 +29,7 @@ private :
 	void GenerateVariableLoad(const Token::Base* typeInfo, const std::string& sVarName, const std::string& sIndent = "\t\t");
 	void GenerateVariableSize(const Token::Base* typeInfo, const std::string& sVarName, const std::string& sIndent = "\t\t");
 	void GenerateVariableInit(const Token::Base* typeInfo, const std::string& sVarName, const std::string& sIndent = "\t\t");
+	void GenerateDirtyFlag(const Token::Message* pToken);
 	const std::string ReplaceSpecialChar(const std::string& str);
 };
 #endif//__GENERATE_RULE_H__
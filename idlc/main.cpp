@@ -7,11 +7,13 @@
 
 void DisplayUsage()
 {
-	std::cout << "idlc -l [cpp|cs|py] <input_file>" << std::endl;
+	std::cout << "idlc [-d] -l [cpp|cs|py] <input_file>" << std::endl;
+	std::cout << "\t-d : generate dirty flags of fields(cpp only)" << std::endl;
 }
 
 std::string sFileName = "";
 std::string sLanguage = "";
+bool bDirty = false;
 
 bool GetOption(int argc, char* argv[])
 {
@@ -24,6 +26,11 @@ bool GetOption(int argc, char* argv[])
 	{
 		std::string sOption = argv[i];
 
+		if("-d" == sOption)
+		{
+			bDirty = true;
+			continue;
+		}
 		if("" != sLanguage)
 		{
 			sFileName = argv[i];
@@ -60,7 +67,7 @@ int main(int argc, char* argv[])
 		DisplayUsage();
 	}
 
-	Compiler* pComp = new Compiler(sFileName, sLanguage);
+	Compiler* pComp = new Compiler(sFileName, sLanguage, bDirty);
 	pComp->Compile();
 
 	return 0;
@@ -0,0 +1,86 @@
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "../Gamnet/Log/Record.h"
+
+void DisplayUsage()
+{
+	std::cout << "logdec <binary_log_file>..." << std::endl;
+	std::cout << "\tprints binary log of 'Gamnet::Log::SetAsync(queue_size, policy, true)' as text log" << std::endl;
+}
+
+bool Decode(const char* path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if(false == file.is_open())
+	{
+		std::cerr << "can not open file(path:" << path << ")" << std::endl;
+		return false;
+	}
+	char magic[sizeof(Gamnet::Log::RECORD_FILE_MAGIC)] = { 0 };
+	if(false == (bool)file.read(magic, sizeof(magic)) || 0 != ::memcmp(magic, Gamnet::Log::RECORD_FILE_MAGIC, sizeof(magic)))
+	{
+		std::cerr << "not a binary log file(path:" << path << ")" << std::endl;
+		return false;
+	}
+
+	std::string data;
+	std::string line;
+	int64_t cached = -1;
+	char timebuf[32] = { 0 };
+	while(true)
+	{
+		uint32_t size = 0;
+		int64_t time = 0;
+		if(false == (bool)file.read((char*)&size, sizeof(uint32_t)))
+		{
+			break;
+		}
+		data.resize(size);
+		if(false == (bool)file.read((char*)&time, sizeof(int64_t)) || (0 < size && false == (bool)file.read(&data[0], size)))
+		{
+			// last frame is cut by crash or by a writer still running
+			std::cerr << "truncated frame at the end(path:" << path << ")" << std::endl;
+			break;
+		}
+		if(cached != time)
+		{
+			cached = time;
+			const time_t now = (time_t)time;
+			tm when;
+#ifdef _WIN32
+			localtime_s(&when, &now);
+#else
+			localtime_r(&now, &when);
+#endif
+			snprintf(timebuf, sizeof(timebuf), "[%04d-%02d-%02d %02d:%02d:%02d]", when.tm_year + 1900, when.tm_mon + 1, when.tm_mday, when.tm_hour, when.tm_min, when.tm_sec);
+		}
+		line.assign(timebuf).append(" ");
+		if(false == Gamnet::Log::DecodeRecord(data.data(), data.size(), line))
+		{
+			line.append(" (broken record)");
+		}
+		line.append("\n");
+		std::cout.write(line.data(), line.size());
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if(2 > argc)
+	{
+		DisplayUsage();
+		return 1;
+	}
+	int result = 0;
+	for(int i = 1; i < argc; i++)
+	{
+		if(false == Decode(argv[i]))
+		{
+			result = 1;
+		}
+	}
+	return result;
+}
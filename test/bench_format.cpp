@@ -0,0 +1,46 @@
+// ns per query-like line of std::stringstream, Format, FormatTemp and FormatTo to char array
+#include <Gamnet.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+static const int LINE_COUNT = 1000000;
+
+template <class F>
+static double Run(F f)
+{
+	size_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < LINE_COUNT; i++)
+	{
+		total += f(i);
+	}
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LINE_COUNT;
+	if(0 == total)
+	{
+		std::cerr << "nothing formatted" << std::endl;
+	}
+	return ns;
+}
+
+int main()
+{
+	const std::string name = "user_name";
+	const double stream = Run([&name](int i) {
+		std::stringstream out;
+		out << "UPDATE user SET user_name='" << name << "', level=" << i % 100 << ", exp=" << i * 0.5 << " WHERE user_seq=" << i;
+		return out.str().size();
+	});
+	const double format = Run([&name](int i) {
+		return Gamnet::Format("UPDATE user SET user_name='", name, "', level=", i % 100, ", exp=", i * 0.5, " WHERE user_seq=", i).size();
+	});
+	const double temp = Run([&name](int i) {
+		return Gamnet::FormatTemp("UPDATE user SET user_name='", name, "', level=", i % 100, ", exp=", i * 0.5, " WHERE user_seq=", i).size();
+	});
+	const double array = Run([&name](int i) {
+		char buf[256];
+		return Gamnet::FormatTo(buf, "UPDATE user SET user_name='", name, "', level=", i % 100, ", exp=", i * 0.5, " WHERE user_seq=", i);
+	});
+	std::cout << "ns/line stringstream:" << stream << " Format:" << format << " FormatTemp:" << temp << " FormatTo(char[]):" << array << std::endl;
+	return 0;
+}
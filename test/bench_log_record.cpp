@@ -0,0 +1,88 @@
+// ns per line of eager format, record encode and encode of the runtime values only, ns per LOG on the caller thread in async text and binary, and writer throughput.
+// on a single core the caller time includes the writer thread
+#include <Gamnet.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <iostream>
+#include <unistd.h>
+
+static const int LINE_COUNT = 1000000;
+
+struct Result
+{
+	double caller_ns; // per line, until 'LOG' returns
+	double lines_per_second; // until all lines are written
+};
+
+static Result Run()
+{
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < LINE_COUNT; i++)
+	{
+		LOG(INF, "dispatch message(session_key:", i, ", msg_id:", 1001, ", elapsed:", 0.25, ", name:", "user", ")");
+	}
+	auto pushed = std::chrono::steady_clock::now();
+	Gamnet::Log::Logger::GetInstance().Stop();
+	auto written = std::chrono::steady_clock::now();
+
+	Result result;
+	result.caller_ns = std::chrono::duration<double, std::nano>(pushed - start).count() / LINE_COUNT;
+	result.lines_per_second = LINE_COUNT / std::chrono::duration<double>(written - start).count();
+	return result;
+}
+
+int main()
+{
+	const std::string path = Gamnet::Format("/tmp/bench_log_record_", getpid());
+	Gamnet::Log::Init(path.c_str(), "log", 1024);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_INF, Gamnet::Log::Logger::LOG_FILE);
+
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < LINE_COUNT; i++)
+	{
+		const std::string line = Gamnet::Format("INF dispatch message(session_key:", i, ", msg_id:", 1001, ", elapsed:", 0.25, ", name:", "user", ")");
+		if(true == line.empty())
+		{
+			return 1;
+		}
+	}
+	const double format = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LINE_COUNT;
+
+	// slot of the queue reuses its buffer like this
+	std::string data;
+	start = std::chrono::steady_clock::now();
+	for(int i = 0; i < LINE_COUNT; i++)
+	{
+		Gamnet::Log::EncodeRecord(data, "INF ", "dispatch message(session_key:", i, ", msg_id:", 1001, ", elapsed:", 0.25, ", name:", "user", ")");
+		if(true == data.empty())
+		{
+			return 1;
+		}
+	}
+	const double encode = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LINE_COUNT;
+	const size_t encode_bytes = data.size();
+
+	// what a per call site descriptor would leave to encode. the difference is the cost of copying the literals
+	start = std::chrono::steady_clock::now();
+	for(int i = 0; i < LINE_COUNT; i++)
+	{
+		Gamnet::Log::EncodeRecord(data, i, 1001, 0.25);
+		if(true == data.empty())
+		{
+			return 1;
+		}
+	}
+	const double values = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / LINE_COUNT;
+	const size_t values_bytes = data.size();
+
+	Gamnet::Log::SetAsync(65536, Gamnet::Log::Logger::FULL_POLICY_BLOCK, false);
+	const Result text = Run();
+	Gamnet::Log::SetAsync(65536, Gamnet::Log::Logger::FULL_POLICY_BLOCK, true);
+	const Result binary = Run();
+
+	std::cout << "format ns/line:" << format << " encode ns/line:" << encode << "(" << encode_bytes << " bytes) runtime values only ns/line:" << values << "(" << values_bytes << " bytes)" << std::endl;
+	std::cout << "async text   caller ns/line:" << text.caller_ns << " written lines/s:" << (int64_t)text.lines_per_second << std::endl;
+	std::cout << "async binary caller ns/line:" << binary.caller_ns << " written lines/s:" << (int64_t)binary.lines_per_second << std::endl;
+	boost::filesystem::remove_all(path);
+	return 0;
+}
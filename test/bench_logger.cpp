@@ -0,0 +1,61 @@
+// lines/s of sync and async log across threads, and cpu time of the idle async writer thread
+#include <Gamnet.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <sys/resource.h>
+#include <unistd.h>
+
+static const int THREAD_COUNT = 4;
+static const int LINE_COUNT = 200000; // per thread
+
+static double Run()
+{
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for(int t = 0; t < THREAD_COUNT; t++)
+	{
+		threads.push_back(std::thread([t]() {
+			for(int i = 0; i < LINE_COUNT; i++)
+			{
+				LOG(INF, "bench line(thread:", t, ", seq:", i, ", name:", "user", ")");
+			}
+		}));
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	return THREAD_COUNT * LINE_COUNT / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double CpuSeconds()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+int main()
+{
+	const std::string path = Gamnet::Format("/tmp/bench_logger_", getpid());
+	Gamnet::Log::Init(path.c_str(), "log", 1024);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_INF, Gamnet::Log::Logger::LOG_FILE);
+
+	const double sync = Run();
+	Gamnet::Log::SetAsync(65536, Gamnet::Log::Logger::FULL_POLICY_BLOCK);
+	const double async = Run();
+
+	// writer thread sleeps on condition variable once queues are drained
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	const double cpu = CpuSeconds();
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	const double idle = CpuSeconds() - cpu;
+	Gamnet::Log::Logger::GetInstance().Stop();
+
+	std::cout << "threads:" << THREAD_COUNT << " sync lines/s:" << (int64_t)sync << " async lines/s:" << (int64_t)async
+		<< " idle cpu ms/s:" << idle * 1000 << std::endl;
+	boost::filesystem::remove_all(path);
+	return 0;
+}
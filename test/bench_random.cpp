@@ -0,0 +1,48 @@
+// ns per number of std::mt19937 with distribution vs Random::Range, and ns per sample of WeightRandom vs AliasRandom
+#include <Gamnet.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+static const int COUNT = 10000000;
+
+template <class F>
+static double Run(F f)
+{
+	int64_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < COUNT; i++)
+	{
+		total += f();
+	}
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / COUNT;
+	if(0 == total)
+	{
+		std::cerr << "no number" << std::endl;
+	}
+	return ns;
+}
+
+int main()
+{
+	std::mt19937 mt(std::random_device{}());
+	std::uniform_int_distribution<int32_t> dist(1, 99999);
+	const double mt19937 = Run([&]() { return dist(mt); });
+	const double range = Run([]() { return Gamnet::Random::Range(1, 99999); });
+	const double real = Run([]() { return (int64_t)(Gamnet::Random::Range(0.0, 100.0) + 1); });
+
+	Gamnet::WeightRandom<int> weight;
+	Gamnet::AliasRandom<int> alias;
+	for(int i = 1; i <= 1000; i++)
+	{
+		weight.SetWeight(i, (uint32_t)(i % 97 + 1));
+		alias.SetWeight(i, (uint64_t)(i % 97 + 1));
+	}
+	alias.Build();
+	const double weightSample = Run([&weight]() { return weight.Random(); });
+	const double aliasSample = Run([&alias]() { return alias.Random(); });
+
+	std::cout << "ns/number mt19937+distribution:" << mt19937 << " Random::Range(int):" << range << " Random::Range(double):" << real << std::endl;
+	std::cout << "ns/sample of 1000 entries WeightRandom:" << weightSample << " AliasRandom:" << aliasSample << std::endl;
+	return 0;
+}
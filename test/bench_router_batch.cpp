@@ -0,0 +1,203 @@
+// router frames/s over loopback between two processes, without batch and with batch of each delay. receiver checks order of frames
+#include <Gamnet.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Gamnet::Network;
+
+static const uint32_t FRAME_COUNT = 500000;
+static const uint32_t ACK_INTERVAL = 10000;
+static const uint32_t WINDOW = 50000; // frames in flight, so the sender doesn't queue every packet at once
+static const size_t PAYLOAD_SIZE = 64;
+
+struct Bench_Frame_Ntf
+{
+	enum { MSG_ID = 90001 };
+	uint32_t seq;
+	char payload[PAYLOAD_SIZE];
+	size_t Size() const
+	{
+		return sizeof(uint32_t) + PAYLOAD_SIZE;
+	}
+	bool Store(char** buf) const
+	{
+		std::memcpy(*buf, &seq, sizeof(uint32_t));
+		std::memcpy(*buf + sizeof(uint32_t), payload, PAYLOAD_SIZE);
+		*buf += Size();
+		return true;
+	}
+	bool Load(const char** buf, size_t& size)
+	{
+		if(Size() > size)
+		{
+			return false;
+		}
+		std::memcpy(&seq, *buf, sizeof(uint32_t));
+		*buf += Size();
+		size -= Size();
+		return true;
+	}
+};
+
+// received frames so far and frames out of order
+struct Bench_Ack_Ntf
+{
+	enum { MSG_ID = 90002 };
+	uint32_t count;
+	uint32_t disorder;
+	size_t Size() const
+	{
+		return sizeof(uint32_t) * 2;
+	}
+	bool Store(char** buf) const
+	{
+		std::memcpy(*buf, &count, sizeof(uint32_t));
+		std::memcpy(*buf + sizeof(uint32_t), &disorder, sizeof(uint32_t));
+		*buf += Size();
+		return true;
+	}
+	bool Load(const char** buf, size_t& size)
+	{
+		if(Size() > size)
+		{
+			return false;
+		}
+		std::memcpy(&count, *buf, sizeof(uint32_t));
+		std::memcpy(&disorder, *buf + sizeof(uint32_t), sizeof(uint32_t));
+		*buf += Size();
+		size -= Size();
+		return true;
+	}
+};
+
+static std::mutex lock;
+static std::condition_variable cond;
+static Bench_Ack_Ntf last_ack = { 0, 0 };
+static uint32_t next_seq = 0;
+
+struct BenchHandler : public IHandler
+{
+	void Recv_Frame(const Router::Address& from, const std::shared_ptr<Tcp::Packet>& packet)
+	{
+		Bench_Frame_Ntf ntf;
+		if(false == Tcp::Packet::Load(ntf, packet))
+		{
+			return;
+		}
+		if(next_seq != ntf.seq)
+		{
+			last_ack.disorder++;
+		}
+		next_seq = ntf.seq + 1;
+		last_ack.count++;
+		if(0 == last_ack.count % ACK_INTERVAL || FRAME_COUNT == last_ack.count)
+		{
+			Router::SendMsg(from, last_ack);
+		}
+	}
+	void Recv_Ack(const Router::Address& from, const std::shared_ptr<Tcp::Packet>& packet)
+	{
+		Bench_Ack_Ntf ntf;
+		if(false == Tcp::Packet::Load(ntf, packet))
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lo(lock);
+		last_ack = ntf;
+		cond.notify_one();
+	}
+};
+
+GAMNET_BIND_ROUTER_HANDLER(Bench_Frame_Ntf, BenchHandler, Recv_Frame, HandlerStatic);
+GAMNET_BIND_ROUTER_HANDLER(Bench_Ack_Ntf, BenchHandler, Recv_Ack, HandlerStatic);
+
+static void InitLog(const std::string& log_path, const char* prefix)
+{
+	Gamnet::Log::Init(log_path.c_str(), prefix, 1024);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_DEV, Gamnet::Log::Logger::LOG_FILE);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_INF, Gamnet::Log::Logger::LOG_FILE);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_WRN, Gamnet::Log::Logger::LOG_FILE);
+}
+
+static void Receive(const std::string& log_path, int port)
+{
+	InitLog(log_path, "recv");
+	Router::Listen("BENCH_RECV", port);
+	Gamnet::Run(0);
+}
+
+static void Send(const std::string& log_path, const std::string& name, int port, size_t batch_size, int batch_delay)
+{
+	InitLog(log_path, "send");
+	Router::SetBatch(batch_size, batch_delay);
+	Router::Listen("BENCH_SEND", port + 1);
+	std::shared_ptr<std::promise<Router::Address>> connected = std::make_shared<std::promise<Router::Address>>();
+	Router::Connect("127.0.0.1", port, 5, [connected](const Router::Address& addr) {
+		connected->set_value(addr);
+	});
+	std::thread io([]() { Gamnet::Run(0); });
+
+	std::future<Router::Address> future = connected->get_future();
+	if(std::future_status::ready != future.wait_for(std::chrono::seconds(10)))
+	{
+		std::cout << name << " connect fail" << std::endl;
+		_exit(1);
+	}
+	const Router::Address addr = future.get();
+
+	Bench_Frame_Ntf ntf;
+	std::memset(ntf.payload, 'x', PAYLOAD_SIZE);
+	auto start = std::chrono::steady_clock::now();
+	for(uint32_t seq = 0; seq < FRAME_COUNT; seq++)
+	{
+		if(0 == seq % ACK_INTERVAL)
+		{
+			std::unique_lock<std::mutex> lo(lock);
+			cond.wait(lo, [seq]() { return seq < last_ack.count + WINDOW; });
+		}
+		ntf.seq = seq;
+		Router::SendMsg(addr, ntf);
+	}
+	Bench_Ack_Ntf ack;
+	{
+		std::unique_lock<std::mutex> lo(lock);
+		cond.wait_for(lo, std::chrono::seconds(30), []() { return FRAME_COUNT == last_ack.count; });
+		ack = last_ack;
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << name << " frames/s:" << (int64_t)(ack.count / seconds) << " received:" << ack.count << "/" << FRAME_COUNT << " out of order:" << ack.disorder << std::endl;
+	_exit(0);
+}
+
+static void Run(const std::string& name, int port, size_t batch_size, int batch_delay)
+{
+	const std::string log_path = Gamnet::Format("/tmp/bench_router_batch_", getpid());
+	pid_t receiver = fork();
+	if(0 == receiver)
+	{
+		Receive(log_path, port);
+		_exit(0);
+	}
+	pid_t sender = fork();
+	if(0 == sender)
+	{
+		Send(log_path, name, port, batch_size, batch_delay);
+	}
+	waitpid(sender, nullptr, 0);
+	kill(receiver, SIGKILL);
+	waitpid(receiver, nullptr, 0);
+	boost::filesystem::remove_all(log_path);
+}
+
+int main()
+{
+	const int port = 30000 + getpid() % 10000;
+	Run("no batch         ", port, 0, 0);
+	Run("batch 64KB 0ms   ", port + 10, 65536, 0);
+	Run("batch 64KB 1ms   ", port + 20, 65536, 1);
+	return 0;
+}
@@ -0,0 +1,205 @@
+// router call round trip between two processes of the same host, over tcp and over shared memory
+#include <Gamnet.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Gamnet::Network;
+
+static const int WARMUP_COUNT = 1000;
+static const int CALL_COUNT = 20000;
+static const uint32_t SHM_SIZE = 1024 * 1024;
+
+struct Bench_Ping_Req
+{
+	enum { MSG_ID = 90011 };
+	uint32_t seq;
+	size_t Size() const
+	{
+		return sizeof(uint32_t);
+	}
+	bool Store(char** buf) const
+	{
+		std::memcpy(*buf, &seq, sizeof(uint32_t));
+		*buf += Size();
+		return true;
+	}
+	bool Load(const char** buf, size_t& size)
+	{
+		if(Size() > size)
+		{
+			return false;
+		}
+		std::memcpy(&seq, *buf, sizeof(uint32_t));
+		*buf += Size();
+		size -= Size();
+		return true;
+	}
+};
+
+struct Bench_Ping_Ans : public Bench_Ping_Req
+{
+	enum { MSG_ID = 90012 };
+};
+
+struct BenchHandler : public IHandler
+{
+	void Recv_Ping(const Router::Address& from, const std::shared_ptr<Tcp::Packet>& packet)
+	{
+		Bench_Ping_Req req;
+		if(false == Tcp::Packet::Load(req, packet))
+		{
+			return;
+		}
+		Bench_Ping_Ans ans;
+		ans.seq = req.seq;
+		Router::SendMsg(from, ans);
+	}
+};
+
+GAMNET_BIND_ROUTER_HANDLER(Bench_Ping_Req, BenchHandler, Recv_Ping, HandlerStatic);
+
+static void InitLog(const std::string& log_path, const char* prefix)
+{
+	Gamnet::Log::Init(log_path.c_str(), prefix, 1024);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_DEV, Gamnet::Log::Logger::LOG_FILE);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_INF, Gamnet::Log::Logger::LOG_FILE);
+	Gamnet::Log::SetLevelProperty(Gamnet::Log::Logger::LOG_LEVEL_WRN, Gamnet::Log::Logger::LOG_FILE);
+}
+
+static void Receive(const std::string& log_path, int port, uint32_t shm_size)
+{
+	InitLog(log_path, "recv");
+	Router::SetSharedMemory(shm_size);
+	Router::Listen("BENCH_RECV", port);
+	Gamnet::Run(0);
+}
+
+static bool IsShmAttached()
+{
+	const Json::Value servers = Router::State()["route"]["server"];
+	for(const Json::Value& server : servers)
+	{
+		if("BENCH_RECV" == server["service_name"].asString() && true == server.isMember("shm"))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// next call is made by the callback of the answer, so each one is a full round trip
+struct Pinger : public std::enable_shared_from_this<Pinger>
+{
+	Router::Address addr;
+	std::vector<double> rtt; // us
+	std::chrono::steady_clock::time_point start;
+	uint32_t seq = 0;
+	int call_count = 0;
+	std::promise<void> done;
+
+	void Ping()
+	{
+		Bench_Ping_Req req;
+		req.seq = ++seq;
+		start = std::chrono::steady_clock::now();
+		std::shared_ptr<Pinger> self = shared_from_this();
+		Router::Call<Bench_Ping_Req, Bench_Ping_Ans>(addr, req, 3000, [self](int error_code, const Bench_Ping_Ans& ans) {
+			if(Gamnet::ErrorCode::Success != error_code || self->seq != ans.seq)
+			{
+				self->done.set_value();
+				return;
+			}
+			self->rtt.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - self->start).count());
+			if(self->call_count > (int)self->rtt.size())
+			{
+				self->Ping();
+				return;
+			}
+			self->done.set_value();
+		});
+	}
+};
+
+static void Send(const std::string& log_path, const std::string& name, int port, uint32_t shm_size)
+{
+	InitLog(log_path, "send");
+	Router::SetSharedMemory(shm_size);
+	Router::Listen("BENCH_SEND", port + 1);
+	std::shared_ptr<std::promise<Router::Address>> connected = std::make_shared<std::promise<Router::Address>>();
+	Router::Connect("127.0.0.1", port, 5, [connected](const Router::Address& addr) {
+		connected->set_value(addr);
+	});
+	std::thread io([]() { Gamnet::Run(0); });
+
+	std::future<Router::Address> future = connected->get_future();
+	if(std::future_status::ready != future.wait_for(std::chrono::seconds(10)))
+	{
+		std::cout << name << " connect fail" << std::endl;
+		_exit(1);
+	}
+	auto wait = std::chrono::steady_clock::now();
+	while(0 < shm_size && false == IsShmAttached() && std::chrono::steady_clock::now() - wait < std::chrono::seconds(5))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	const bool shm = IsShmAttached();
+	const Router::Address addr = future.get();
+
+	std::vector<double> rtt;
+	for(int call_count : { WARMUP_COUNT, CALL_COUNT })
+	{
+		std::shared_ptr<Pinger> pinger = std::make_shared<Pinger>();
+		pinger->addr = addr;
+		pinger->call_count = call_count;
+		pinger->rtt.reserve(call_count);
+		std::future<void> done = pinger->done.get_future();
+		pinger->Ping();
+		done.wait();
+		rtt.swap(pinger->rtt);
+	}
+	if(CALL_COUNT != (int)rtt.size())
+	{
+		std::cout << name << " call fail after " << rtt.size() << " calls" << std::endl;
+		_exit(1);
+	}
+	std::sort(rtt.begin(), rtt.end());
+	double total = 0;
+	for(double us : rtt)
+	{
+		total += us;
+	}
+	std::cout << name << " shm:" << (true == shm ? "on " : "off") << " rtt us avg:" << (int64_t)(total / rtt.size()) << " p50:" << (int64_t)rtt[rtt.size() / 2] << " p99:" << (int64_t)rtt[rtt.size() * 99 / 100] << std::endl;
+	_exit(0);
+}
+
+static void Run(const std::string& name, int port, uint32_t shm_size)
+{
+	const std::string log_path = Gamnet::Format("/tmp/bench_router_shm_", getpid());
+	pid_t receiver = fork();
+	if(0 == receiver)
+	{
+		Receive(log_path, port, shm_size);
+		_exit(0);
+	}
+	pid_t sender = fork();
+	if(0 == sender)
+	{
+		Send(log_path, name, port, shm_size);
+	}
+	waitpid(sender, nullptr, 0);
+	kill(receiver, SIGKILL);
+	waitpid(receiver, nullptr, 0);
+	boost::filesystem::remove_all(log_path);
+}
+
+int main()
+{
+	const int port = 30000 + getpid() % 10000;
+	Run("tcp", port, 0);
+	Run("shm", port + 10, SHM_SIZE);
+	return 0;
+}
@@ -0,0 +1,75 @@
+// wall ns per routing table read over all threads: thread-local snapshot vs atomic_load of shared_ptr, while another thread publishes tables
+#include <Gamnet.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace Gamnet::Network::Router;
+
+static const int THREAD_COUNT = 4;
+static const int READ_COUNT = 2000000; // per thread
+
+template <class F>
+static double Run(F f)
+{
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for(int t = 0; t < THREAD_COUNT; t++)
+	{
+		threads.push_back(std::thread([&f]() {
+			size_t count = 0;
+			for(int i = 0; i < READ_COUNT; i++)
+			{
+				count += f();
+			}
+			if(0 == count)
+			{
+				std::cerr << "no table" << std::endl;
+			}
+		}));
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ((double)READ_COUNT * THREAD_COUNT);
+}
+
+int main()
+{
+	RouterCaster caster;
+	std::atomic<bool> stop(false);
+	std::atomic<int> publishes(0);
+	// a table change every millisecond, much more often than servers join or leave
+	std::thread publisher([&]() {
+		while(false == stop)
+		{
+			caster.SetAnyCastPolicy("BENCH", (ANY_CAST_POLICY)(publishes++ % 2));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+
+	const double snapshot = Run([&caster]() {
+		return (size_t)(nullptr != caster.GetTable()->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST]);
+	});
+	const double shared = Run([&caster]() {
+		std::shared_ptr<const RouterCaster::RoutingTable> table = std::atomic_load(&caster.table_);
+		return (size_t)(nullptr != table->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST]);
+	});
+	// nested read keeps the outer table alive even when a newer one is loaded
+	size_t nested = 0;
+	for(int i = 0; i < 1000; i++)
+	{
+		const RouterCaster::Snapshot outer = caster.GetTable();
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+		const RouterCaster::Snapshot inner = caster.GetTable();
+		nested += (size_t)(nullptr != outer->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST] && nullptr != inner->arrCasterImpl_[ROUTER_CAST_TYPE::ANY_CAST]);
+	}
+	stop = true;
+	publisher.join();
+
+	std::cout << "threads:" << THREAD_COUNT << " ns/read snapshot:" << snapshot << " atomic_load:" << shared
+		<< " publishes:" << publishes << " nested ok:" << nested << "/1000" << std::endl;
+	return 0;
+}
@@ -0,0 +1,104 @@
+// writes/s and reads/s across threads. shared cache and WAL, each with string queries and with prepared statements
+#include <Gamnet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+using namespace Gamnet::Database;
+
+static const int THREAD_COUNT = 4;
+static const int ROW_COUNT = 2000; // per thread
+
+template <class F>
+static double Run(F f)
+{
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for(int t = 0; t < THREAD_COUNT; t++)
+	{
+		threads.push_back(std::thread(f, t));
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return THREAD_COUNT * ROW_COUNT / seconds;
+}
+
+// a write fails with SQLITE_BUSY when the busy timeout runs out. it is counted, not thrown out of the thread
+template <class F>
+static void Try(std::atomic<int>& errors, F f)
+{
+	try {
+		if(false == f())
+		{
+			errors++;
+		}
+	}
+	catch(const Gamnet::Exception&)
+	{
+		errors++;
+	}
+}
+
+static void Bench(int db_type, bool wal, bool prepare)
+{
+	const std::string path = Gamnet::Format("/tmp/bench_sqlite_", getpid(), "_", db_type, ".db");
+	std::remove(path.c_str());
+	if(false == SQLite::Connect(db_type, path.c_str(), wal))
+	{
+		std::cerr << "can not open " << path << std::endl;
+		return;
+	}
+	SQLite::Execute(db_type, "CREATE TABLE user(user_seq INTEGER PRIMARY KEY, user_name TEXT, user_level INTEGER)");
+
+	std::atomic<int> errors(0);
+	const double writes = Run([db_type, prepare, &errors](int t) {
+		for(int i = 0; i < ROW_COUNT; i++)
+		{
+			Try(errors, [db_type, prepare, t, i]() {
+				if(true == prepare)
+				{
+					SQLite::Statement stmt = SQLite::Prepare(db_type, "INSERT INTO user(user_seq, user_name, user_level) VALUES(?, ?, ?)");
+					return 1 == stmt.BindAll(t * ROW_COUNT + i + 1, Gamnet::Format("user_", i), i % 100).Execute();
+				}
+				SQLite::Execute(db_type, "INSERT INTO user(user_seq, user_name, user_level) VALUES(", t * ROW_COUNT + i + 1, ", 'user_", i, "', ", i % 100, ")");
+				return true;
+			});
+		}
+	});
+	const double reads = Run([db_type, prepare, &errors](int t) {
+		for(int i = 0; i < ROW_COUNT; i++)
+		{
+			Try(errors, [db_type, prepare, t, i]() {
+				if(true == prepare)
+				{
+					SQLite::Statement stmt = SQLite::Prepare(db_type, "SELECT user_name, user_level FROM user WHERE user_seq = ?");
+					stmt.Bind(1, t * ROW_COUNT + i + 1);
+					return true == stmt.Step() && i % 100 == stmt.GetInt(1);
+				}
+				SQLite::ResultSet res = SQLite::Execute(db_type, "SELECT user_name, user_level FROM user WHERE user_seq = ", t * ROW_COUNT + i + 1);
+				SQLite::ResultSet::iterator itr = res.begin();
+				return res.end() != itr && i % 100 == (int)itr["user_level"];
+			});
+		}
+	});
+	std::cout << (true == wal ? "wal         " : "shared_cache") << (true == prepare ? " prepare" : " string ") << " threads:" << THREAD_COUNT
+		<< " writes/s:" << (int64_t)writes << " reads/s:" << (int64_t)reads << " errors:" << errors << std::endl;
+	std::remove(path.c_str());
+	std::remove((path + "-wal").c_str());
+	std::remove((path + "-shm").c_str());
+}
+
+int main()
+{
+	Bench(1, false, false);
+	Bench(2, false, true);
+	Bench(3, true, false);
+	Bench(4, true, true);
+	return 0;
+}
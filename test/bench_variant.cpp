@@ -0,0 +1,107 @@
+// ns per column read: boost::lexical_cast of string(old Variant), Variant of string, Variant of integer column, repeated read,
+// and read of integer and double columns through sqlite 'ResultSet' against lexical_cast of the same rows
+#include <Gamnet.h>
+#include <boost/lexical_cast.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <unistd.h>
+
+static const int COUNT = 1000000;
+
+template <class F>
+static double Run(F f)
+{
+	int64_t total = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < COUNT; i++)
+	{
+		total += f(i);
+	}
+	const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / COUNT;
+	if(0 == total)
+	{
+		std::cerr << "nothing read" << std::endl;
+	}
+	return ns;
+}
+
+int main()
+{
+	std::vector<std::string> columns;
+	for(int i = 0; i < 1024; i++)
+	{
+		columns.push_back(std::to_string(1000000 + i * 7919));
+	}
+	const double lexical = Run([&columns](int i) {
+		return boost::lexical_cast<int32_t>(columns[i & 1023]);
+	});
+	const double string = Run([&columns](int i) {
+		Gamnet::Variant value(columns[i & 1023]);
+		return (int32_t)value;
+	});
+	const double column = Run([&columns](int i) {
+		const std::string& data = columns[i & 1023];
+		Gamnet::Variant value(data.data(), data.size(), Gamnet::Variant::TYPE_INT);
+		return (int32_t)value;
+	});
+	const Gamnet::Variant parsed(columns[0]);
+	const double read = Run([&parsed](int) {
+		return (int64_t)parsed;
+	});
+
+	const int DB_TYPE = 1;
+	const std::string path = Gamnet::Format("/tmp/bench_variant_", getpid(), ".db");
+	std::remove(path.c_str());
+	if(false == Gamnet::Database::SQLite::Connect(DB_TYPE, path.c_str()))
+	{
+		std::cerr << "can not open " << path << std::endl;
+		return 1;
+	}
+	Gamnet::Database::SQLite::Execute(DB_TYPE, "CREATE TABLE item(item_seq INTEGER PRIMARY KEY, item_count INTEGER, item_rate REAL)");
+	{
+		Gamnet::Database::SQLite::Transaction transaction(DB_TYPE);
+		for(int i = 0; i < 1024; i++)
+		{
+			transaction.Execute("INSERT INTO item VALUES(", i + 1, ", ", 1000000 + i * 7919, ", ", i + 0.5, ")");
+		}
+		transaction.Commit();
+	}
+	Gamnet::Database::SQLite::ResultSet res = Gamnet::Database::SQLite::Execute(DB_TYPE, "SELECT item_count, item_rate FROM item");
+	std::vector<Gamnet::Database::SQLite::ResultSet::iterator> rows;
+	for(auto row = res.begin(); row != res.end(); row++)
+	{
+		rows.push_back(row);
+	}
+	// old 'operator []' looked the column up by name, then lexical_cast converted its text
+	std::map<std::string, unsigned short>& columnNames = res.impl_->mapColumnName_;
+	const double lexical_int = Run([&rows, &columnNames](int i) {
+		return boost::lexical_cast<int32_t>((*rows[i & 1023].itr_)[columnNames.find("item_count")->second]);
+	});
+	const double result_int = Run([&rows](int i) {
+		return (int32_t)rows[i & 1023]["item_count"];
+	});
+	const double lexical_double = Run([&rows, &columnNames](int i) {
+		return (int64_t)boost::lexical_cast<double>((*rows[i & 1023].itr_)[columnNames.find("item_rate")->second]);
+	});
+	const double result_double = Run([&rows](int i) {
+		return (int64_t)(double)rows[i & 1023]["item_rate"];
+	});
+	std::remove(path.c_str());
+
+	// failed conversion is caught as boost::bad_lexical_cast, like before
+	int caught = 0;
+	try {
+		(int32_t)Gamnet::Variant(std::string("abc"));
+	}
+	catch(const boost::bad_lexical_cast& e)
+	{
+		caught++;
+	}
+	std::cout << "ns/read lexical_cast:" << lexical << " Variant(string):" << string << " Variant(int column):" << column
+		<< " repeated read:" << read << " bad_lexical_cast caught:" << caught << std::endl;
+	std::cout << "ns/read of sqlite ResultSet int lexical_cast:" << lexical_int << " Variant:" << result_int
+		<< " double lexical_cast:" << lexical_double << " Variant:" << result_double << std::endl;
+	return 0;
+}
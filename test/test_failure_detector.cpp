@@ -0,0 +1,87 @@
+// phi grows with silence since the last heartbeat, crosses the threshold later on a jittery link, and falls back when heartbeat comes again
+#include <Gamnet.h>
+#include <iostream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+static const double THRESHOLD = 8.0;
+
+// ms after the last heartbeat when phi goes over THRESHOLD
+static uint64_t Crossing(Gamnet::FailureDetector& detector, uint64_t last)
+{
+	for(uint64_t elapsed = 0; elapsed < 60000; elapsed += 10)
+	{
+		if(THRESHOLD < detector.Phi(last + elapsed))
+		{
+			return elapsed;
+		}
+	}
+	return 60000;
+}
+
+int main()
+{
+	const uint64_t INTERVAL = 1000;
+	uint64_t now = 1000000;
+	uint64_t last = 0;
+
+	Gamnet::FailureDetector steady;
+	CHECK(0.0 == steady.Phi(now));
+	for(int i = 0; i < 50; i++)
+	{
+		last = now;
+		steady.HeartBeat(now, INTERVAL);
+		now += INTERVAL - 20 + (i % 5) * 10;
+	}
+
+	// grows while nothing comes
+	double phi = steady.Phi(last + 1);
+	CHECK(1.0 > phi);
+	for(uint64_t elapsed = 100; elapsed <= 5000; elapsed += 100)
+	{
+		const double next = steady.Phi(last + elapsed);
+		CHECK(phi <= next);
+		phi = next;
+	}
+	CHECK(1.0 > steady.Phi(last + INTERVAL));
+	CHECK(THRESHOLD < steady.Phi(last + 5 * INTERVAL));
+
+	// crosses after a few missed heartbeats, not on the first late one. least deviation is quarter of expected interval
+	const uint64_t steady_crossing = Crossing(steady, last);
+	CHECK(INTERVAL * 3 / 2 < steady_crossing && INTERVAL * 4 > steady_crossing);
+
+	// same mean with wider deviation tolerates longer silence
+	Gamnet::FailureDetector jittery;
+	now = 1000000;
+	uint64_t jittery_last = 0;
+	for(int i = 0; i < 50; i++)
+	{
+		jittery_last = now;
+		jittery.HeartBeat(now, INTERVAL);
+		now += (0 == i % 2 ? INTERVAL / 2 : INTERVAL * 3 / 2);
+	}
+	CHECK(steady_crossing + INTERVAL / 2 < Crossing(jittery, jittery_last));
+
+	// suspected peer comes back. heartbeat ends the silence, and next late one is judged by the window again
+	now = last + 5 * INTERVAL;
+	CHECK(THRESHOLD < steady.Phi(now));
+	steady.HeartBeat(now, INTERVAL);
+	CHECK(0.0 == steady.Phi(now));
+	CHECK(1.0 > steady.Phi(now + INTERVAL));
+	CHECK(THRESHOLD < steady.Phi(now + 10 * INTERVAL));
+
+	steady.Reset();
+	CHECK(0.0 == steady.Phi(now + 10 * INTERVAL));
+
+	// without expected interval, the first one is learned
+	Gamnet::FailureDetector learned;
+	learned.HeartBeat(1000000, 0);
+	CHECK(0.0 == learned.Phi(1000000 + 10 * INTERVAL));
+	learned.HeartBeat(1000000 + INTERVAL, 0);
+	CHECK(1.0 > learned.Phi(1000000 + 2 * INTERVAL));
+	CHECK(THRESHOLD < learned.Phi(1000000 + 10 * INTERVAL));
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,40 @@
+// Format matches std::ostream, and FormatTemp results do not overwrite each other
+#include <Gamnet.h>
+#include <climits>
+#include <iostream>
+#include <sstream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+template <class... ARGS>
+static std::string Stream(const ARGS&... args)
+{
+	std::stringstream stream;
+	Gamnet::Concat(stream, args...);
+	return stream.str();
+}
+
+int main()
+{
+	CHECK(Stream("a", 1, -2, 3u, LLONG_MIN, ULLONG_MAX, 'c', true, 0.1, 1e300, 2.5f) == Gamnet::Format("a", 1, -2, 3u, LLONG_MIN, ULLONG_MAX, 'c', true, 0.1, 1e300, 2.5f));
+
+	char buf[8];
+	CHECK(7 == Gamnet::FormatTo(buf, "truncated ", 12345));
+	CHECK(std::string("truncat") == buf);
+
+	// nested and sibling calls get their own strings while the first one is alive
+	{
+		Gamnet::FormatTempString first = Gamnet::FormatTemp("first:", 1);
+		Gamnet::FormatTempString nested = Gamnet::FormatTemp("outer(", Gamnet::FormatTemp("inner:", 2), ")");
+		CHECK("first:1" == first.str());
+		CHECK("outer(inner:2)" == nested.str());
+		CHECK("a:3, b:4" == Gamnet::Format(Gamnet::FormatTemp("a:", 3), ", ", Gamnet::FormatTemp("b:", 4)));
+	}
+	// thread buffer is free again
+	const char* data = Gamnet::FormatTemp("x").c_str();
+	CHECK(data == Gamnet::FormatTemp("y").c_str());
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,80 @@
+// journal append, rollover over small segments and replay after reopen
+#include <Gamnet.h>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+int main()
+{
+	const std::string path = Gamnet::Format("/tmp/test_journal_", getpid());
+	const int RECORD_COUNT = 2000;
+	boost::filesystem::remove_all(path);
+
+	boost::asio::io_service io_service;
+	boost::asio::strand strand(io_service);
+	std::thread worker([&io_service]() {
+		boost::asio::io_service::work work(io_service);
+		io_service.run();
+	});
+
+	std::mutex lock;
+	std::vector<uint64_t> applied;
+	std::atomic<int> committed(0);
+	{
+		Gamnet::Journal journal;
+		// 64KB segments, so records roll over many times
+		CHECK(true == journal.Init(path, [&](uint64_t lsn, const std::string& record) {
+			std::lock_guard<std::mutex> lo(lock);
+			applied.push_back(lsn);
+			return true;
+		}, 65536, 1));
+		for(int i = 0; i < RECORD_COUNT; i++)
+		{
+			journal.Append(std::string(200, 'a' + i % 26), strand, [&committed](int error_code) {
+				if(0 == error_code)
+				{
+					committed++;
+				}
+			});
+		}
+		journal.Close();
+	}
+	for(int i = 0; i < 100 && RECORD_COUNT != committed; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	CHECK(RECORD_COUNT == committed);
+	CHECK(RECORD_COUNT == (int)applied.size());
+	for(int i = 0; i < RECORD_COUNT; i++)
+	{
+		CHECK((uint64_t)i + 1 == applied[i]);
+	}
+	CHECK(false == boost::filesystem::exists(path + "/spare.tmp"));
+
+	// records applied before close are not replayed, and lsn continues
+	applied.clear();
+	{
+		Gamnet::Journal journal;
+		CHECK(true == journal.Init(path, [&](uint64_t lsn, const std::string& record) {
+			std::lock_guard<std::mutex> lo(lock);
+			applied.push_back(lsn);
+			return true;
+		}, 65536, 1));
+		CHECK((uint64_t)RECORD_COUNT + 1 == journal.Append("next", strand, [](int) {}));
+		journal.Close();
+	}
+	CHECK(1 == applied.size() && (uint64_t)RECORD_COUNT + 1 == applied[0]);
+
+	io_service.stop();
+	worker.join();
+	boost::filesystem::remove_all(path);
+	std::cout << "ok" << std::endl;
+	return 0;
+}
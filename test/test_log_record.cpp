@@ -0,0 +1,49 @@
+// decoded log record prints the same text as Format
+#include <Gamnet.h>
+#include <climits>
+#include <iostream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+template <class... ARGS>
+static std::string RoundTrip(const ARGS&... args)
+{
+	std::string data;
+	Gamnet::Log::EncodeRecord(data, args...);
+	std::string text;
+	if(false == Gamnet::Log::DecodeRecord(data.data(), data.size(), text))
+	{
+		return "(broken record)";
+	}
+	return text;
+}
+
+int main()
+{
+	const char* name = "user";
+	std::string str = "value";
+	char buf[16] = "buffer";
+	CHECK(Gamnet::Format("INF ", 1, ", ", -2, ", ", 3u, ", ", (short)-4, ", ", (unsigned short)5) == RoundTrip("INF ", 1, ", ", -2, ", ", 3u, ", ", (short)-4, ", ", (unsigned short)5));
+	CHECK(Gamnet::Format(LLONG_MIN, ", ", ULLONG_MAX, ", ", INT_MIN) == RoundTrip(LLONG_MIN, ", ", ULLONG_MAX, ", ", INT_MIN));
+	CHECK(Gamnet::Format('c', (signed char)'d', (unsigned char)'e', true, false) == RoundTrip('c', (signed char)'d', (unsigned char)'e', true, false));
+	CHECK(Gamnet::Format(0.25f, ", ", 1.0 / 3, ", ", 1e300, ", ", (long double)2.5) == RoundTrip(0.25f, ", ", 1.0 / 3, ", ", 1e300, ", ", (long double)2.5));
+	CHECK(Gamnet::Format(name, str, buf, "") == RoundTrip(name, str, buf, ""));
+	CHECK(std::string(1000, 'x') == RoundTrip(std::string(1000, 'x')));
+	CHECK("" == RoundTrip());
+
+	Gamnet::Log::Throttle::Suppressed suppressed;
+	suppressed.count = 0;
+	CHECK(Gamnet::Format("line", suppressed) == RoundTrip("line", suppressed));
+	suppressed.count = 12;
+	CHECK(Gamnet::Format("line", suppressed) == RoundTrip("line", suppressed));
+
+	// cut record is reported, not read over
+	std::string data;
+	Gamnet::Log::EncodeRecord(data, "text", 1);
+	std::string text;
+	CHECK(false == Gamnet::Log::DecodeRecord(data.data(), data.size() - 1, text));
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,26 @@
+// batch query built by Loader keeps the meaning of the original select. no mysql server is needed
+#include <Gamnet.h>
+#include <iostream>
+
+#define CHECK_QUERY(select, expected) \
+	if(std::string(expected) != Loader::MakeQuery(select, "USER_SEQ", "'1','2'")) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << Loader::MakeQuery(select, "USER_SEQ", "'1','2'") << std::endl; return 1; }
+
+using namespace Gamnet::Database::MySQL;
+
+int main()
+{
+	CHECK_QUERY("SELECT * FROM USER", "SELECT * FROM USER WHERE USER_SEQ IN ('1','2')");
+	// OR of the original condition must not swallow the key condition
+	CHECK_QUERY("SELECT * FROM USER WHERE LEVEL > 10 OR VIP = 1", "SELECT * FROM USER WHERE (LEVEL > 10 OR VIP = 1) AND USER_SEQ IN ('1','2')");
+	// key condition goes before trailing clauses
+	CHECK_QUERY("SELECT * FROM USER_ITEM ORDER BY ITEM_SEQ LIMIT 100", "SELECT * FROM USER_ITEM WHERE USER_SEQ IN ('1','2') ORDER BY ITEM_SEQ LIMIT 100");
+	CHECK_QUERY("SELECT USER_SEQ, COUNT(*) FROM USER_ITEM where DELETED = 0 group by USER_SEQ having COUNT(*) > 1",
+		"SELECT USER_SEQ, COUNT(*) FROM USER_ITEM where (DELETED = 0) AND USER_SEQ IN ('1','2') group by USER_SEQ having COUNT(*) > 1");
+	CHECK_QUERY("SELECT * FROM USER WHERE NAME = 'where order by' FOR UPDATE", "SELECT * FROM USER WHERE (NAME = 'where order by') AND USER_SEQ IN ('1','2') FOR UPDATE");
+	// keywords in subquery or as part of a name are not clauses of the outer select
+	CHECK_QUERY("SELECT * FROM USER WHERE GUILD_SEQ IN (SELECT GUILD_SEQ FROM GUILD WHERE LEVEL > 1 ORDER BY LEVEL LIMIT 10)",
+		"SELECT * FROM USER WHERE (GUILD_SEQ IN (SELECT GUILD_SEQ FROM GUILD WHERE LEVEL > 1 ORDER BY LEVEL LIMIT 10)) AND USER_SEQ IN ('1','2')");
+	CHECK_QUERY("SELECT ORDER_SEQ, LIMIT_COUNT FROM USER_ORDER", "SELECT ORDER_SEQ, LIMIT_COUNT FROM USER_ORDER WHERE USER_SEQ IN ('1','2')");
+	std::cout << "ok" << std::endl;
+	return 0;
+}
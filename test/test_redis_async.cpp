@@ -0,0 +1,191 @@
+// async redis commands are encoded as RESP arrays, replies are parsed in pieces, and sharded db_type sends each command to the node of its key
+#include <Gamnet.h>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Database;
+
+// answers RESP array commands with the name of this node. ECHO returns its argument
+class FakeNode
+{
+	boost::asio::io_service io_service_;
+	boost::asio::ip::tcp::acceptor acceptor_;
+public :
+	const std::string name;
+	std::atomic<bool> down; // drops the connection instead of answering
+
+	FakeNode(const std::string& name) : acceptor_(io_service_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0)), name(name), down(false)
+	{
+		std::thread([this]() {
+			while(true)
+			{
+				std::shared_ptr<boost::asio::ip::tcp::socket> socket = std::make_shared<boost::asio::ip::tcp::socket>(io_service_);
+				boost::system::error_code ec;
+				acceptor_.accept(*socket, ec);
+				if(ec)
+				{
+					return;
+				}
+				std::thread(std::bind(&FakeNode::Serve, this, socket)).detach();
+			}
+		}).detach();
+	}
+
+	int Port() const
+	{
+		return acceptor_.local_endpoint().port();
+	}
+
+	void Serve(std::shared_ptr<boost::asio::ip::tcp::socket> socket)
+	{
+		std::string buffer;
+		char chunk[8192];
+		while(true)
+		{
+			boost::system::error_code ec;
+			size_t readbytes = socket->read_some(boost::asio::buffer(chunk, sizeof(chunk)), ec);
+			if(ec || true == down)
+			{
+				return;
+			}
+			buffer.append(chunk, readbytes);
+			std::string reply;
+			size_t offset = 0;
+			while(true)
+			{
+				Redis::Reply command;
+				const size_t consumed = Redis::Reply::Parse(buffer.data() + offset, buffer.size() - offset, command);
+				if(0 == consumed)
+				{
+					break;
+				}
+				offset += consumed;
+				std::string answer = name;
+				if(2 == command.elements.size() && "ECHO" == command.elements[0].str)
+				{
+					answer = command.elements[1].str;
+				}
+				reply += "$" + std::to_string(answer.size()) + "\r\n" + answer + "\r\n";
+			}
+			buffer.erase(0, offset);
+			boost::asio::write(*socket, boost::asio::buffer(reply), ec);
+		}
+	}
+};
+
+static Redis::ResultSet Wait(int db_type, boost::asio::strand& strand, const std::vector<std::string>& args)
+{
+	std::shared_ptr<std::promise<Redis::ResultSet>> promise = std::make_shared<std::promise<Redis::ResultSet>>();
+	Redis::AsyncExecute(db_type, strand, [promise](const Redis::ResultSet& res) {
+		promise->set_value(res);
+	}, args);
+	return promise->get_future().get();
+}
+
+int main()
+{
+	// an argument keeps its spaces, quotes and CR/LF
+	CHECK("*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$7\r\na b\r\n\"c\r\n" == Redis::AsyncConnection::Encode({ "SET", "key", "a b\r\n\"c" }));
+	const std::vector<std::string> split = Redis::AsyncConnection::Split("PUBLISH 'chat room' \"hello world\\r\\n\" \"\\x41\"");
+	CHECK(4 == split.size() && "chat room" == split[1] && "hello world\r\n" == split[2] && "A" == split[3]);
+	bool thrown = false;
+	try {
+		Redis::AsyncConnection::Split("GET \"key");
+	}
+	catch(const Gamnet::Exception& e) {
+		thrown = (Gamnet::ErrorCode::InvalidArgumentError == e.error_code());
+	}
+	CHECK(true == thrown);
+
+	// reply cut anywhere is not consumed until the rest arrives
+	const std::string data = "*3\r\n$5\r\nhello\r\n:42\r\n*2\r\n+OK\r\n$-1\r\n-ERR tail\r\n";
+	const size_t first = data.size() - std::string("-ERR tail\r\n").size();
+	for(size_t size = 0; size < first; size++)
+	{
+		Redis::Reply reply;
+		CHECK(0 == Redis::Reply::Parse(data.data(), size, reply));
+	}
+	Redis::Reply reply;
+	CHECK(first == Redis::Reply::Parse(data.data(), data.size(), reply));
+	CHECK(Redis::Reply::TYPE_ARRAY == reply.type && 3 == reply.elements.size());
+	CHECK("hello" == reply.elements[0].str && Redis::Reply::TYPE_INTEGER == reply.elements[1].type && "42" == reply.elements[1].str);
+	CHECK(Redis::Reply::TYPE_NIL == reply.elements[2].elements[1].type);
+	std::shared_ptr<Redis::ResultSetImpl> impl(new Redis::ResultSetImpl());
+	reply.ToResultSet(impl);
+	CHECK(3 == impl->size() && true == impl->error.empty());
+	Redis::Reply error;
+	CHECK(data.size() - first == Redis::Reply::Parse(data.data() + first, data.size() - first, error));
+	CHECK(Redis::Reply::TYPE_ERROR == error.type && "ERR tail" == error.str);
+
+	boost::asio::io_service& io_service = Gamnet::Singleton<boost::asio::io_service>::GetInstance();
+	boost::asio::io_service::work work(io_service);
+	std::thread io([&io_service]() { io_service.run(); });
+	boost::asio::strand strand(io_service);
+
+	const int DB_TYPE = 1;
+	std::vector<FakeNode*> fakeNodes; // not deleted. their threads block in accept until exit
+	std::vector<Redis::Connection::ConnectionInfo> nodes;
+	for(int i = 0; i < 3; i++)
+	{
+		fakeNodes.push_back(new FakeNode(Gamnet::Format("node", i)));
+		Redis::Connection::ConnectionInfo connInfo;
+		connInfo.host = "127.0.0.1";
+		connInfo.port = fakeNodes.back()->Port();
+		nodes.push_back(connInfo);
+	}
+	CHECK(true == Redis::Connect(DB_TYPE, nodes));
+	std::shared_ptr<Redis::Shard> shard = Gamnet::Singleton<Redis::ShardManager>::GetInstance().Find(DB_TYPE);
+
+	// each key goes to its own node, the same one as blocking 'Execute'
+	std::set<size_t> used;
+	for(int i = 0; i < 30; i++)
+	{
+		const std::string key = Gamnet::Format("user:", i);
+		Redis::ResultSet res = Wait(DB_TYPE, strand, { "GET", key });
+		CHECK(true == res.error().empty());
+		CHECK(Gamnet::Format("node", shard->GetNode(key)) == (std::string)res[0]);
+		used.insert(shard->GetNode(key));
+	}
+	CHECK(3 == used.size());
+	CHECK("a b\r\nc" == (std::string)Wait(DB_TYPE, strand, { "ECHO", "a b\r\nc" })[0]);
+	CHECK("node0" == (std::string)Wait(DB_TYPE, strand, { "PUBLISH", "user:1", "message" })[0]);
+	CHECK(Gamnet::Format("node", shard->GetNode("{user:1}")) == (std::string)Wait(DB_TYPE, strand, { "MGET", "{user:1}:a", "{user:1}:b" })[0]);
+
+	// multi-key command over nodes can't be sent as it is
+	thrown = false;
+	try {
+		std::vector<std::string> mget = { "MGET" };
+		for(int i = 0; i < 30; i++)
+		{
+			mget.push_back(Gamnet::Format("user:", i));
+		}
+		Wait(DB_TYPE, strand, mget);
+	}
+	catch(const Gamnet::Exception& e) {
+		thrown = (Gamnet::ErrorCode::InvalidArgumentError == e.error_code());
+	}
+	CHECK(true == thrown);
+
+	// handler throwing on error reply of a closed connection doesn't stop the io thread
+	const size_t node = shard->GetNode("user:1");
+	fakeNodes[node]->down = true;
+	std::shared_ptr<std::promise<std::string>> closed = std::make_shared<std::promise<std::string>>();
+	Redis::AsyncExecute(DB_TYPE, strand, [closed](const Redis::ResultSet& res) {
+		closed->set_value(res.error());
+		throw GAMNET_EXCEPTION(Gamnet::ErrorCode::UndefinedError, "handler fail");
+	}, std::vector<std::string>{ "GET", "user:1" });
+	CHECK(false == closed->get_future().get().empty());
+	fakeNodes[node]->down = false;
+	CHECK(Gamnet::Format("node", node) == (std::string)Wait(DB_TYPE, strand, { "GET", "user:1" })[0]);
+
+	io_service.stop();
+	io.join();
+	std::cout << "ok" << std::endl;
+	return 0;
+}
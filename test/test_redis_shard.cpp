@@ -0,0 +1,249 @@
+// sharded redis against in-process fake nodes. no redis-server is needed
+#include <Gamnet.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Database;
+
+// answers inline commands of Redis::Connection. only what this test sends
+class FakeNode
+{
+	boost::asio::io_service io_service_;
+	boost::asio::ip::tcp::acceptor acceptor_;
+	std::mutex lock_;
+	std::map<std::string, std::string> data_;
+public :
+	std::atomic<bool> down; // drops the connection instead of answering
+	std::atomic<int> delay; // ms before each answer
+
+	FakeNode() : acceptor_(io_service_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string("127.0.0.1"), 0)), down(false), delay(0)
+	{
+		std::thread([this]() {
+			while(true)
+			{
+				std::shared_ptr<boost::asio::ip::tcp::socket> socket = std::make_shared<boost::asio::ip::tcp::socket>(io_service_);
+				boost::system::error_code ec;
+				acceptor_.accept(*socket, ec);
+				if(ec)
+				{
+					return;
+				}
+				std::thread(std::bind(&FakeNode::Serve, this, socket)).detach();
+			}
+		}).detach();
+	}
+
+	int Port() const
+	{
+		return acceptor_.local_endpoint().port();
+	}
+
+	size_t KeyCount()
+	{
+		std::lock_guard<std::mutex> lo(lock_);
+		return data_.size();
+	}
+
+	std::string Answer(const std::string& line)
+	{
+		std::istringstream is(line);
+		std::vector<std::string> args;
+		std::string arg;
+		while(is >> arg)
+		{
+			args.push_back(arg);
+		}
+		std::lock_guard<std::mutex> lo(lock_);
+		if(true == args.empty())
+		{
+			return "-ERR empty\r\n";
+		}
+		if("GET" == args[0] && 2 == args.size())
+		{
+			auto itr = data_.find(args[1]);
+			return data_.end() == itr ? "$-1\r\n" : "$" + std::to_string(itr->second.size()) + "\r\n" + itr->second + "\r\n";
+		}
+		if("SET" == args[0] && 3 == args.size())
+		{
+			data_[args[1]] = args[2];
+			return "+OK\r\n";
+		}
+		if("MSET" == args[0])
+		{
+			for(size_t i = 1; i + 1 < args.size(); i += 2)
+			{
+				data_[args[i]] = args[i + 1];
+			}
+			return "+OK\r\n";
+		}
+		if("MGET" == args[0])
+		{
+			std::string reply = "*" + std::to_string(args.size() - 1) + "\r\n";
+			for(size_t i = 1; i < args.size(); i++)
+			{
+				auto itr = data_.find(args[i]);
+				reply += data_.end() == itr ? "$-1\r\n" : "$" + std::to_string(itr->second.size()) + "\r\n" + itr->second + "\r\n";
+			}
+			return reply;
+		}
+		if("DEL" == args[0])
+		{
+			size_t count = 0;
+			for(size_t i = 1; i < args.size(); i++)
+			{
+				count += data_.erase(args[i]);
+			}
+			return ":" + std::to_string(count) + "\r\n";
+		}
+		if("BROKEN" == args[0])
+		{
+			return "?broken\r\n";
+		}
+		return "-ERR unknown command '" + args[0] + "'\r\n";
+	}
+
+	void Serve(std::shared_ptr<boost::asio::ip::tcp::socket> socket)
+	{
+		std::string buffer;
+		char chunk[8192];
+		while(true)
+		{
+			boost::system::error_code ec;
+			size_t readbytes = socket->read_some(boost::asio::buffer(chunk, sizeof(chunk)), ec);
+			if(ec || true == down)
+			{
+				return;
+			}
+			buffer.append(chunk, readbytes);
+			std::string reply;
+			size_t pos = 0;
+			while(std::string::npos != buffer.find("\r\n", pos))
+			{
+				const size_t end = buffer.find("\r\n", pos);
+				reply += Answer(buffer.substr(pos, end - pos));
+				pos = end + 2;
+			}
+			buffer.erase(0, pos);
+			if(true == reply.empty())
+			{
+				continue;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+			// replies after the broken one come late, after the client gave up on them
+			const size_t broken = reply.find("?broken\r\n");
+			if(std::string::npos != broken)
+			{
+				boost::asio::write(*socket, boost::asio::buffer(reply.substr(0, broken + 9)), ec);
+				std::this_thread::sleep_for(std::chrono::milliseconds(200));
+				reply.erase(0, broken + 9);
+			}
+			boost::asio::write(*socket, boost::asio::buffer(reply), ec);
+		}
+	}
+};
+
+int main()
+{
+	const int DB_TYPE = 1;
+	const int NODE_COUNT = 3;
+	const int KEY_COUNT = 30;
+
+	std::vector<FakeNode*> fakeNodes; // not deleted. their threads block in accept until exit
+	std::vector<Redis::Connection::ConnectionInfo> nodes;
+	for(int i = 0; i < NODE_COUNT; i++)
+	{
+		fakeNodes.push_back(new FakeNode());
+		Redis::Connection::ConnectionInfo connInfo;
+		connInfo.host = "127.0.0.1";
+		connInfo.port = fakeNodes.back()->Port();
+		nodes.push_back(connInfo);
+	}
+	CHECK(true == Redis::Connect(DB_TYPE, nodes));
+
+	// keys are spread over the nodes and come back in key order
+	std::string mset = "MSET";
+	std::string mget = "MGET";
+	for(int i = 0; i < KEY_COUNT; i++)
+	{
+		mset += Gamnet::Format(" user:", i, " value", i);
+		mget += Gamnet::Format(" user:", i);
+	}
+	CHECK(true == Redis::Execute(DB_TYPE, mset).error().empty());
+	size_t keyCount = 0;
+	for(auto& fakeNode : fakeNodes)
+	{
+		CHECK(0 < fakeNode->KeyCount());
+		keyCount += fakeNode->KeyCount();
+	}
+	CHECK(KEY_COUNT == (int)keyCount);
+
+	Redis::ResultSet res = Redis::Execute(DB_TYPE, mget);
+	std::vector<std::string> queries;
+	std::vector<Redis::ResultSet> results;
+	CHECK(true == res.error().empty());
+	CHECK(KEY_COUNT == (int)res->size());
+	for(int i = 0; i < KEY_COUNT; i++)
+	{
+		CHECK(Gamnet::Format("value", i) == (std::string)res[i]);
+	}
+
+	// nodes are asked at the same time, so a pipeline costs about one delay, not one per node
+	for(auto& fakeNode : fakeNodes)
+	{
+		fakeNode->delay = 200;
+	}
+	auto start = std::chrono::steady_clock::now();
+	res = Redis::Execute(DB_TYPE, mget);
+	const int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	CHECK(true == res.error().empty());
+	CHECK(400 > elapsed);
+	for(auto& fakeNode : fakeNodes)
+	{
+		fakeNode->delay = 0;
+	}
+
+	// connection of a failed pipeline is not given out with the replies it didn't read
+	CHECK(true == Redis::Execute(DB_TYPE, "MSET {tag}:a first {tag}:b second").error().empty());
+	results = Redis::Pipeline(DB_TYPE, { "BROKEN {tag}:a", "GET {tag}:a" });
+	CHECK(false == results[0].error().empty() && false == results[1].error().empty());
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	res = Redis::Execute(DB_TYPE, "GET {tag}:b");
+	CHECK(true == res.error().empty());
+	CHECK("second" == (std::string)res[0]);
+
+	// a dead node fails its own parts. other queries in the pipeline still succeed
+	fakeNodes[1]->down = true;
+	queries.clear();
+	for(int i = 0; i < KEY_COUNT; i++)
+	{
+		queries.push_back(Gamnet::Format("GET user:", i));
+	}
+	results = Redis::Pipeline(DB_TYPE, queries);
+	CHECK(KEY_COUNT == (int)results.size());
+	int failCount = 0;
+	for(int i = 0; i < KEY_COUNT; i++)
+	{
+		const std::string key = Gamnet::Format("user:", i);
+		if(1 == Gamnet::Singleton<Redis::ShardManager>::GetInstance().Find(DB_TYPE)->GetNode(key))
+		{
+			CHECK(false == results[i].error().empty());
+			failCount++;
+			continue;
+		}
+		CHECK(true == results[i].error().empty());
+		CHECK(Gamnet::Format("value", i) == (std::string)results[i][0]);
+	}
+	CHECK(0 < failCount);
+	CHECK(false == Redis::Execute(DB_TYPE, mget).error().empty());
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
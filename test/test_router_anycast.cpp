@@ -0,0 +1,141 @@
+// any-cast policies under skewed load and weights, and ServerLoad of heartbeat reaching the policies
+#include <Gamnet.h>
+#include <Network/Router/RouterHandler.h>
+#include <iostream>
+#include <map>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network;
+using namespace Gamnet::Network::Router;
+
+static boost::asio::ip::address ip = boost::asio::ip::address_v4::loopback();
+
+static std::shared_ptr<Router::Session> CreateSession(uint32_t id)
+{
+	std::shared_ptr<Router::Session> session = std::make_shared<Router::Session>();
+	session->address.service_name = "TEST";
+	session->address.cast_type = ROUTER_CAST_TYPE::ANY_CAST;
+	session->address.id = id;
+	session->remote_address = &ip;
+	return session;
+}
+
+// selected count of each server id
+static std::map<uint32_t, int> Select(const RouterCasterImpl_Any& caster, int count)
+{
+	Address addr;
+	addr.service_name = "TEST";
+	addr.cast_type = ROUTER_CAST_TYPE::ANY_CAST;
+	std::map<uint32_t, int> selected;
+	for(int i = 0; i < count; i++)
+	{
+		selected[caster.Select(addr)->address.id]++;
+	}
+	return selected;
+}
+
+int main()
+{
+	std::vector<std::shared_ptr<Router::Session>> sessions;
+	RouterCasterImpl_Any caster;
+	for(uint32_t id = 1; id <= 3; id++)
+	{
+		sessions.push_back(CreateSession(id));
+		CHECK(true == caster.RegisterAddress(sessions.back()->address, sessions.back()));
+	}
+
+	// fewest outstanding calls wins, and servers of the same count take turns
+	caster.SetPolicy("TEST", LEAST_OUTSTANDING);
+	sessions[0]->outstanding = 5;
+	sessions[1]->outstanding = 0;
+	sessions[2]->outstanding = 3;
+	CHECK(1000 == Select(caster, 1000)[2]);
+	sessions[2]->outstanding = 0;
+	std::map<uint32_t, int> selected = Select(caster, 1000);
+	CHECK(0 == selected[1] && 300 < selected[2] && 300 < selected[3]);
+	for(auto& session : sessions)
+	{
+		session->outstanding = 0;
+	}
+
+	// the busiest never wins a pair. queue depth and outstanding add up, cpu only breaks tie
+	caster.SetPolicy("TEST", POWER_OF_TWO_CHOICES);
+	ServerLoad load;
+	load.queue_depth = 0;
+	sessions[0]->SetLoad(load);
+	load.queue_depth = 10;
+	sessions[1]->SetLoad(load);
+	load.queue_depth = 100;
+	sessions[2]->SetLoad(load);
+	selected = Select(caster, 3000);
+	CHECK(0 == selected[3] && selected[2] < selected[1]);
+	// each pair is picked about 1000 times. the lightest wins both of its pairs
+	CHECK(1800 < selected[1] && 700 < selected[2]);
+	sessions[0]->outstanding = 20;
+	selected = Select(caster, 3000);
+	CHECK(0 == selected[3] && selected[1] < selected[2]);
+	sessions[0]->outstanding = 0;
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		load.queue_depth = 7;
+		load.cpu = 100 - i * 40;
+		sessions[i]->SetLoad(load);
+	}
+	selected = Select(caster, 3000);
+	CHECK(0 == selected[1] && selected[2] < selected[3]);
+
+	// turns follow weights over a round, and a server of weight 0 gets none
+	caster.SetPolicy("TEST", WEIGHTED_ROUND_ROBIN);
+	const uint32_t weights[3] = { 1, 3, 0 };
+	for(uint32_t i = 0; i < 3; i++)
+	{
+		load.weight = weights[i];
+		sessions[i]->SetLoad(load);
+	}
+	selected = Select(caster, 4000);
+	CHECK(0 == selected[3]);
+	CHECK(980 <= selected[1] && selected[1] <= 1020 && 2980 <= selected[2] && selected[2] <= 3020);
+	// heavy server's turns are spread, not given in a row
+	Address addr;
+	addr.service_name = "TEST";
+	int longest = 0;
+	int run = 0;
+	for(int i = 0; i < 400; i++)
+	{
+		run = (2 == caster.Select(addr)->address.id ? run + 1 : 0);
+		longest = std::max(longest, run);
+	}
+	CHECK(longest <= 4);
+
+	// heartbeat carries ServerLoad to the session which the policies read
+	RouterHandler handler;
+	MsgRouter_HeartBeat_Ntf ntf;
+	ntf.load.cpu = 250;
+	ntf.load.session_count = 1234;
+	ntf.load.queue_depth = 56;
+	ntf.load.weight = 9;
+	ntf.interval = 1000;
+	std::shared_ptr<Tcp::Packet> packet = Tcp::Packet::Create();
+	CHECK(true == packet->Write(0, ntf));
+	handler.Recv_HeartBeat_Ntf(sessions[0], packet);
+	CHECK(250 == sessions[0]->cpu && 1234 == sessions[0]->session_count && 56 == sessions[0]->queue_depth && 9 == sessions[0]->weight);
+	const Json::Value state = sessions[0]->State();
+	CHECK(250 == state["cpu"].asUInt() && 1234 == state["session_count"].asUInt() && 56 == state["queue_depth"].asUInt() && 9 == state["weight"].asUInt());
+
+	// heartbeat of a router which doesn't report load keeps the last one
+	struct Empty
+	{
+		enum { MSG_ID = MsgRouter_HeartBeat_Ntf::MSG_ID };
+		size_t Size() const { return 0; }
+		bool Store(char**) const { return true; }
+	};
+	std::shared_ptr<Tcp::Packet> empty = Tcp::Packet::Create();
+	CHECK(true == empty->Write(0, Empty()));
+	handler.Recv_HeartBeat_Ntf(sessions[0], empty);
+	CHECK(56 == sessions[0]->queue_depth && 9 == sessions[0]->weight);
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,55 @@
+// CallManager is not created until the first call, and an answer coming after its call completed is dropped, not dispatched
+#include <Gamnet.h>
+#include <iostream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network;
+using namespace Gamnet::Network::Router;
+
+int main()
+{
+	CHECK(nullptr == CallManager::Find());
+	CHECK(0 == Router::State()["call"]["in_flight"].asInt());
+	CHECK(nullptr == CallManager::Find());
+
+	CallManager& callManager = Gamnet::Singleton<CallManager>::GetInstance();
+	CHECK(&callManager == CallManager::Find());
+
+	const uint32_t ANS_MSG_ID = MsgRouter_JoinLink_Ntf::MSG_ID;
+	Address addr;
+	addr.service_name = "TEST";
+	addr.cast_type = ROUTER_CAST_TYPE::MULTI_CAST;
+	// no server of the service, so the call completes with send failure right away
+	int error_code = Gamnet::ErrorCode::Success;
+	callManager.Call(addr, Tcp::Packet::Create(), ANS_MSG_ID, 1000, [&error_code](int code, const std::shared_ptr<Tcp::Packet>&) {
+		error_code = code;
+	});
+	CHECK(Gamnet::ErrorCode::SendMsgFailError == error_code);
+
+	// first slot, first generation
+	const uint32_t msg_seq = CallManager::CALL_SEQ | (1 << CallManager::SLOT_BITS);
+	MsgRouter_JoinLink_Ntf ntf;
+	std::shared_ptr<Tcp::Packet> answer = Tcp::Packet::Create();
+	CHECK(true == answer->Write(msg_seq, ntf));
+	std::shared_ptr<Tcp::Packet> request = Tcp::Packet::Create();
+	CHECK(true == request->Write(msg_seq, MsgRouter_SetAddress_Req()));
+
+	Address from;
+	from.service_name = "TEST";
+	from.cast_type = ROUTER_CAST_TYPE::UNI_CAST;
+	from.id = 3;
+	from.msg_seq = msg_seq;
+	CHECK(true == callManager.OnRecvMsg(from, answer));
+	// request of a remote call with the same msg_seq, or answer of other service goes to handlers
+	CHECK(false == callManager.OnRecvMsg(from, request));
+	Address other = from;
+	other.service_name = "OTHER";
+	CHECK(false == callManager.OnRecvMsg(other, answer));
+	from.msg_seq = msg_seq + (1 << CallManager::SLOT_BITS);
+	CHECK(false == callManager.OnRecvMsg(from, answer));
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,71 @@
+// router handshake features and MsgRouter_SendMsg_Ntf made from envelope for router of older build
+#include <Gamnet.h>
+#include <iostream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network;
+using namespace Gamnet::Network::Router;
+
+int main()
+{
+	MsgRouter_SetAddress_Req req;
+	req.local_address.service_name = "service";
+	req.local_address.id = 3;
+	Handshake handshake;
+	handshake.features = Router::Session::FEATURE_ALL;
+
+	// new router to new router
+	std::shared_ptr<Tcp::Packet> packet = Tcp::Packet::Create();
+	CHECK(true == packet->Write(1, req, handshake));
+	MsgRouter_SetAddress_Req recv_req;
+	Handshake recv_handshake;
+	CHECK(true == packet->Read(recv_req, recv_handshake));
+	CHECK(req.local_address == recv_req.local_address);
+	CHECK((uint32_t)Router::Session::FEATURE_ALL == recv_handshake.features);
+
+	// new router to older one, which reads the message only
+	MsgRouter_SetAddress_Req old_req;
+	CHECK(true == Tcp::Packet::Load(old_req, packet));
+	CHECK(req.local_address == old_req.local_address);
+
+	// older router to new one
+	CHECK(true == packet->Write(1, req));
+	Handshake old_handshake;
+	CHECK(true == packet->Read(recv_req, old_handshake));
+	CHECK(0 == old_handshake.features);
+
+	// envelope sent to older router is the same bytes as MsgRouter_SendMsg_Ntf it used to send
+	MsgRouter_JoinLink_Ntf inner;
+	inner.local_address = req.local_address;
+	inner.link_index = 1;
+	inner.link_count = 2;
+	std::shared_ptr<Tcp::Packet> envelope = Tcp::Packet::Create();
+	CHECK(true == envelope->WriteEnvelope(MsgRouter_Envelope_Ntf::MSG_ID, 0, 7, inner));
+	envelope->SetSEQ(42);
+
+	std::shared_ptr<Gamnet::Buffer> buffers[2];
+	CHECK(true == Router::Session::WriteSendMsgNtf(envelope, buffers));
+	std::string sent(buffers[0]->ReadPtr(), buffers[0]->Size());
+	sent.append(buffers[1]->ReadPtr(), buffers[1]->Size());
+
+	std::shared_ptr<Tcp::Packet> frame = Tcp::Packet::Create();
+	CHECK(true == frame->Write(7, inner));
+	MsgRouter_SendMsg_Ntf ntf;
+	ntf.msg_seq = 42;
+	ntf.buffer.assign(frame->ReadPtr(), frame->Size());
+	std::shared_ptr<Tcp::Packet> legacy = Tcp::Packet::Create();
+	CHECK(true == legacy->Write(0, ntf));
+	CHECK(std::string(legacy->ReadPtr(), legacy->Size()) == sent);
+
+	// view points into the envelope, not a copy, and keeps it
+	CHECK(envelope->ReadPtr() + Tcp::Packet::HEADER_SIZE == buffers[1]->ReadPtr());
+	const char* data = envelope->ReadPtr();
+	envelope = nullptr;
+	CHECK(data + Tcp::Packet::HEADER_SIZE == buffers[1]->ReadPtr());
+	CHECK(std::string(frame->ReadPtr(), frame->Size()) == std::string(buffers[1]->ReadPtr(), buffers[1]->Size()));
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
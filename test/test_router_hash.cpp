@@ -0,0 +1,150 @@
+// hash-cast ring: 160 points per server by splitmix64 of (id, node), same ring in any registration order, a key on a point
+// goes to the next one, keys stay on their server until it leaves, and Address::key is not on the wire
+#include <Gamnet.h>
+#include <iostream>
+#include <set>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network;
+using namespace Gamnet::Network::Router;
+
+static const int KEY_COUNT = 100000;
+
+static boost::asio::ip::address ip = boost::asio::ip::address_v4::loopback();
+
+// every router should place points with this hash
+static uint64_t SplitMix(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+static Address MakeAddress(uint32_t id, uint64_t key)
+{
+	Address addr;
+	addr.service_name = "TEST";
+	addr.cast_type = ROUTER_CAST_TYPE::HASH_CAST;
+	addr.id = id;
+	addr.key = key;
+	return addr;
+}
+
+static std::shared_ptr<Router::Session> CreateSession(uint32_t id)
+{
+	std::shared_ptr<Router::Session> session = std::make_shared<Router::Session>();
+	session->address = MakeAddress(id, 0);
+	session->remote_address = &ip;
+	return session;
+}
+
+static std::vector<uint32_t> Owners(const RouterCasterImpl_Hash& caster)
+{
+	std::vector<uint32_t> owners;
+	for(uint64_t key = 0; key < KEY_COUNT; key++)
+	{
+		owners.push_back(caster.Select(MakeAddress(0, key))->address.id);
+	}
+	return owners;
+}
+
+int main()
+{
+	std::vector<std::shared_ptr<Router::Session>> sessions;
+	for(uint32_t id = 1; id <= 5; id++)
+	{
+		sessions.push_back(CreateSession(id));
+	}
+
+	RouterCasterImpl_Hash forward;
+	RouterCasterImpl_Hash backward;
+	for(int i = 0; i < 4; i++)
+	{
+		CHECK(true == forward.RegisterAddress(sessions[i]->address, sessions[i]));
+		CHECK(true == backward.RegisterAddress(sessions[3 - i]->address, sessions[3 - i]));
+	}
+	const RouterCasterImpl_Hash::Ring& ring = forward.mapRouteTable["TEST"];
+	CHECK(4 * RouterCasterImpl_Hash::VIRTUAL_NODE_COUNT == ring.points.size());
+	std::set<uint64_t> expected;
+	for(uint64_t id = 1; id <= 4; id++)
+	{
+		for(uint64_t node = 0; node < RouterCasterImpl_Hash::VIRTUAL_NODE_COUNT; node++)
+		{
+			expected.insert(SplitMix((id << 32) | node));
+		}
+	}
+	std::set<uint64_t> placed;
+	for(size_t i = 0; i < ring.points.size(); i++)
+	{
+		placed.insert(ring.points[i].first);
+		CHECK(0 == i || ring.points[i - 1].first <= ring.points[i].first);
+	}
+	CHECK(expected == placed);
+
+	// key of which hash is a point itself is past it, so it goes to the next point. last one wraps to the first
+	for(size_t i = 0; i < ring.points.size(); i++)
+	{
+		const RouterCasterImpl_Hash::Node& node = ring.nodes[ring.points[i].second];
+		const uint64_t key = ((uint64_t)node.id << 32) | 0;
+		if(SplitMix(key) != ring.points[i].first)
+		{
+			continue;
+		}
+		CHECK(ring.nodes[ring.points[(i + 1) % ring.points.size()].second].session == ring.Find(key));
+	}
+	uint64_t past = 0;
+	while(SplitMix(past) <= ring.points.back().first)
+	{
+		past++;
+	}
+	CHECK(ring.nodes[ring.points.front().second].session == ring.Find(past));
+
+	// order of registration doesn't matter, and each server takes about a quarter
+	const std::vector<uint32_t> owners = Owners(forward);
+	CHECK(owners == Owners(backward));
+	int count[6] = { 0 };
+	for(uint32_t id : owners)
+	{
+		count[id]++;
+	}
+	for(uint32_t id = 1; id <= 4; id++)
+	{
+		CHECK(KEY_COUNT * 20 / 100 < count[id] && count[id] < KEY_COUNT * 30 / 100);
+	}
+
+	// joining server takes keys only for itself, and leaving one gives away only its own
+	CHECK(true == forward.RegisterAddress(sessions[4]->address, sessions[4]));
+	const std::vector<uint32_t> joined = Owners(forward);
+	int moved = 0;
+	for(int key = 0; key < KEY_COUNT; key++)
+	{
+		CHECK(owners[key] == joined[key] || 5 == joined[key]);
+		moved += (owners[key] != joined[key]);
+	}
+	CHECK(KEY_COUNT * 15 / 100 < moved && moved < KEY_COUNT * 25 / 100);
+	CHECK(true == forward.UnregisterAddress(sessions[1]->address));
+	const std::vector<uint32_t> left = Owners(forward);
+	for(int key = 0; key < KEY_COUNT; key++)
+	{
+		CHECK(joined[key] == left[key] || 2 == joined[key]);
+		CHECK(2 != left[key]);
+	}
+
+	// key routes only. it is not serialized, so Address has the same bytes as before hash-cast
+	Address addr = MakeAddress(7, 12345);
+	addr.msg_seq = 99;
+	std::vector<char> buffer;
+	CHECK(true == addr.Store(buffer));
+	CHECK(sizeof(uint32_t) + addr.service_name.size() + sizeof(ROUTER_CAST_TYPE::TYPE) + sizeof(uint32_t) + sizeof(uint64_t) == buffer.size());
+	Address loaded;
+	CHECK(true == loaded.Load(buffer));
+	CHECK(addr == loaded && 99 == loaded.msg_seq && 0 == loaded.key);
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
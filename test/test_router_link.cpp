@@ -0,0 +1,170 @@
+// reconnect backoff is capped and jittered and starts over after a successful connect, and frames of a key go through its lane or the first link
+#include <Gamnet.h>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network;
+
+static const int RECEIVER_COUNT = 3;
+
+// listens after a byte comes through 'fd'. forked before any thread starts
+static void Receive(int fd, int port)
+{
+	char c = 0;
+	if(1 != read(fd, &c, 1))
+	{
+		_exit(1);
+	}
+	Router::Listen("LINK_RECV", port);
+	Gamnet::Run(0);
+}
+
+// 0 after stopped, so pid is not killed again after it is reused
+static void Stop(pid_t& receiver)
+{
+	if(0 < receiver)
+	{
+		kill(receiver, SIGKILL);
+		waitpid(receiver, nullptr, 0);
+		receiver = 0;
+	}
+}
+
+struct Connection
+{
+	std::mutex lock;
+	std::condition_variable cond;
+	int count = 0;
+	Router::Address addr;
+
+	bool Wait(int count, int timeout)
+	{
+		std::unique_lock<std::mutex> lo(lock);
+		return cond.wait_for(lo, std::chrono::milliseconds(timeout), [this, count]() { return count <= this->count; });
+	}
+};
+
+static int Backoff()
+{
+	// exponential up to the cap, jittered in [delay / 2, delay]
+	for(uint32_t retry_count : { 0u, 1u, 3u, 8u, 9u, 16u, 17u, 1000u })
+	{
+		const int64_t delay = std::min((int64_t)Router::LinkManager::RECONNECT_MAX_DELAY, (int64_t)Router::LinkManager::RECONNECT_MIN_DELAY << std::min(retry_count, 16u));
+		int64_t min = delay;
+		int64_t max = 0;
+		for(int i = 0; i < 10000; i++)
+		{
+			const int64_t jitter_delay = Router::LinkManager::ReconnectDelay(retry_count);
+			min = std::min(min, jitter_delay);
+			max = std::max(max, jitter_delay);
+		}
+		CHECK(delay / 2 <= min && max <= delay);
+		// spread over the whole range, so servers dropped together come back apart
+		CHECK(delay / 2 + delay / 10 > min && delay - delay / 10 < max);
+	}
+	CHECK(Router::LinkManager::RECONNECT_MIN_DELAY >= Router::LinkManager::ReconnectDelay(0));
+	CHECK(Router::LinkManager::RECONNECT_MAX_DELAY >= Router::LinkManager::ReconnectDelay(9));
+	CHECK(Router::LinkManager::RECONNECT_MAX_DELAY / 2 <= Router::LinkManager::ReconnectDelay(100));
+	return 0;
+}
+
+static int Lanes()
+{
+	// key goes to its lane while the lane is attached, and to the first link otherwise
+	std::shared_ptr<Router::Session> session = std::make_shared<Router::Session>();
+	session->link_count = 3;
+	for(uint64_t key = 0; key < 6; key++)
+	{
+		CHECK(0 == session->GetLinkIndex(key));
+	}
+	std::shared_ptr<Link> lane = std::make_shared<Tcp::Link>(&Gamnet::Singleton<Router::LinkManager>::GetInstance());
+	CHECK(true == session->AttachLane(2, lane));
+	for(uint64_t key = 0; key < 6; key++)
+	{
+		CHECK((2 == key % 3 ? 2u : 0u) == session->GetLinkIndex(key));
+	}
+	session->link_count = 1;
+	CHECK(0 == session->GetLinkIndex(2));
+	session->link_count = 3;
+	session->DetachLane(2, lane);
+	CHECK(0 == session->GetLinkIndex(2));
+	return 0;
+}
+
+// receiver goes down and a new one comes up on the same port
+static int Reconnect(pid_t* receivers, const int* fds, int port)
+{
+	std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+	CHECK(1 == write(fds[0], "x", 1));
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	Router::Listen("LINK_SEND", port + 1);
+	Router::Connect("127.0.0.1", port, 5, [connection](const Router::Address& addr) {
+		std::lock_guard<std::mutex> lo(connection->lock);
+		connection->count++;
+		connection->addr = addr;
+		connection->cond.notify_all();
+	});
+	std::thread([]() { Gamnet::Run(0); }).detach();
+	CHECK(true == connection->Wait(1, 10000));
+
+	// refused while down, so retry_count grows and the delay reaches seconds
+	Stop(receivers[0]);
+	std::this_thread::sleep_for(std::chrono::milliseconds(5000));
+	CHECK(nullptr == Gamnet::Singleton<Router::RouterCaster>::GetInstance().FindSession(connection->addr));
+	CHECK(1 == write(fds[1], "x", 1));
+	CHECK(true == connection->Wait(2, 10000));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	std::shared_ptr<Router::Session> session = Gamnet::Singleton<Router::RouterCaster>::GetInstance().FindSession(connection->addr);
+	CHECK(nullptr != session);
+	CHECK(0 == session->retry_count);
+
+	// next drop starts from the shortest delay, not from the one before the connect
+	Stop(receivers[1]);
+	const auto start = std::chrono::steady_clock::now();
+	CHECK(1 == write(fds[2], "x", 1));
+	CHECK(true == connection->Wait(3, 10000));
+	const int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	CHECK(2500 > elapsed);
+	return 0;
+}
+
+int main()
+{
+	// receivers are forked before io_service is created, so they don't share its descriptors
+	const int port = 30000 + getpid() % 10000 + 20;
+	pid_t receivers[RECEIVER_COUNT];
+	int fds[RECEIVER_COUNT];
+	for(int i = 0; i < RECEIVER_COUNT; i++)
+	{
+		int pipe_fds[2];
+		CHECK(0 == pipe(pipe_fds));
+		receivers[i] = fork();
+		if(0 == receivers[i])
+		{
+			close(pipe_fds[1]);
+			Receive(pipe_fds[0], port);
+			_exit(0);
+		}
+		close(pipe_fds[0]);
+		fds[i] = pipe_fds[1];
+	}
+	const int result = Backoff() || Lanes() || Reconnect(receivers, fds, port);
+	for(int i = 0; i < RECEIVER_COUNT; i++)
+	{
+		close(fds[i]);
+		Stop(receivers[i]);
+	}
+	if(0 == result)
+	{
+		std::cout << "ok" << std::endl;
+	}
+	// io thread is still running
+	_exit(result);
+}
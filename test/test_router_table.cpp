@@ -0,0 +1,63 @@
+// routing table replaced while a thread is idle is freed, and one replaced under a snapshot lives until the snapshot ends
+#include <Gamnet.h>
+#include <condition_variable>
+#include <iostream>
+#include <thread>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network::Router;
+
+int main()
+{
+	RouterCaster caster;
+	std::weak_ptr<const RouterCaster::RoutingTable> first = std::atomic_load(&caster.table_);
+
+	// reader takes a snapshot once and then waits without taking another
+	std::mutex lock;
+	std::condition_variable cond;
+	bool read = false;
+	bool done = false;
+	std::thread reader([&]() {
+		{
+			const RouterCaster::Snapshot snapshot = caster.GetTable();
+		}
+		std::unique_lock<std::mutex> lo(lock);
+		read = true;
+		cond.notify_all();
+		cond.wait(lo, [&]() { return done; });
+	});
+	{
+		std::unique_lock<std::mutex> lo(lock);
+		cond.wait(lo, [&]() { return read; });
+	}
+	caster.SetAnyCastPolicy("TEST", ANY_CAST_POLICY::LEAST_OUTSTANDING);
+	CHECK(true == first.expired());
+	{
+		std::lock_guard<std::mutex> lo(lock);
+		done = true;
+		cond.notify_all();
+	}
+	reader.join();
+
+	// same on this thread, and nested snapshot keeps the outer table
+	std::weak_ptr<const RouterCaster::RoutingTable> second = std::atomic_load(&caster.table_);
+	{
+		const RouterCaster::Snapshot outer = caster.GetTable();
+		caster.SetAnyCastPolicy("TEST", ANY_CAST_POLICY::ROUND_ROBIN);
+		const RouterCaster::Snapshot inner = caster.GetTable();
+		CHECK(false == second.expired());
+		CHECK(&*outer != &*inner);
+	}
+	CHECK(true == second.expired());
+	std::weak_ptr<const RouterCaster::RoutingTable> third = std::atomic_load(&caster.table_);
+	{
+		const RouterCaster::Snapshot snapshot = caster.GetTable();
+		CHECK(&*snapshot == third.lock().get());
+	}
+	caster.SetAnyCastPolicy("TEST", ANY_CAST_POLICY::LEAST_OUTSTANDING);
+	CHECK(true == third.expired());
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,57 @@
+// shared memory link delivers the frames queued before the reader starts, and writer gives up on a ring nobody drains
+#include <Gamnet.h>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Network;
+
+int main()
+{
+	std::shared_ptr<Router::ShmLink> writer = Router::ShmLink::Create(Router::ShmLink::MIN_SIZE);
+	CHECK(nullptr != writer);
+	std::shared_ptr<Router::ShmLink> reader = Router::ShmLink::Open(writer->GetName(), writer->GetSize());
+	CHECK(nullptr != reader);
+
+	std::shared_ptr<Gamnet::Buffer> buffer = Gamnet::Buffer::Create();
+	buffer->Append(std::string(1000, 'x').c_str(), 1000);
+
+	// nobody reads, so the ring fills up and the writer stops waiting after SEND_TIMEOUT
+	uint32_t sent = 0;
+	auto start = std::chrono::steady_clock::now();
+	while(true == writer->Send(buffer))
+	{
+		sent++;
+	}
+	const int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	CHECK(Router::ShmLink::MIN_SIZE / 1004 == sent);
+	CHECK(Router::ShmLink::SEND_TIMEOUT <= elapsed && Router::ShmLink::SEND_TIMEOUT * 3 > elapsed);
+
+	std::mutex lock;
+	std::condition_variable cond;
+	uint32_t received = 0;
+	reader->Start([&](const std::shared_ptr<Tcp::Packet>& packet) {
+		std::lock_guard<std::mutex> lo(lock);
+		if(1000 == packet->Size())
+		{
+			received++;
+		}
+		cond.notify_one();
+	});
+	{
+		std::unique_lock<std::mutex> lo(lock);
+		CHECK(true == cond.wait_for(lo, std::chrono::seconds(5), [&]() { return sent == received; }));
+	}
+	// drained, so it sends again
+	CHECK(true == writer->Send(buffer));
+
+	writer->Close();
+	CHECK(false == writer->Send(buffer));
+	reader->Close();
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
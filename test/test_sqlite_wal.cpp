@@ -0,0 +1,53 @@
+// in WAL mode, transactions on one thread follow each other and queries outside of an open transaction are not part of it
+#include <Gamnet.h>
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+using namespace Gamnet::Database;
+
+static int Count(int db_type)
+{
+	SQLite::ResultSet res = SQLite::Execute(db_type, "SELECT COUNT(*) AS count FROM user");
+	return (int)res.begin()["count"];
+}
+
+int main()
+{
+	const int DB_TYPE = 1;
+	const std::string path = Gamnet::Format("/tmp/test_sqlite_wal_", getpid(), ".db");
+	std::remove(path.c_str());
+	CHECK(true == SQLite::Connect(DB_TYPE, path.c_str(), true));
+	SQLite::Execute(DB_TYPE, "CREATE TABLE user(user_seq INTEGER PRIMARY KEY, user_name TEXT)");
+
+	{
+		SQLite::Transaction transaction(DB_TYPE);
+		transaction.Execute("INSERT INTO user VALUES(1, 'first')");
+		transaction.Commit();
+	}
+	{
+		SQLite::Transaction transaction(DB_TYPE);
+		transaction.Execute("INSERT INTO user VALUES(2, 'second')");
+		// read of the thread's connection sees the last commit, not this transaction
+		CHECK(1 == Count(DB_TYPE));
+		// rolled back
+	}
+	CHECK(1 == Count(DB_TYPE));
+
+	SQLite::Execute(DB_TYPE, "INSERT INTO user VALUES(3, 'third')");
+	{
+		SQLite::Transaction transaction(DB_TYPE);
+		transaction.Execute("INSERT INTO user VALUES(4, 'fourth')");
+		transaction.Commit();
+	}
+	CHECK(3 == Count(DB_TYPE));
+
+	std::remove(path.c_str());
+	std::remove((path + "-wal").c_str());
+	std::remove((path + "-shm").c_str());
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,47 @@
+// timing wheel expires by steady clock, whether 'Advance' is called late or often
+#include <Gamnet.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+int main()
+{
+	Gamnet::TimingWheel<int> wheel(16, 10);
+	std::vector<int> expired;
+	auto advance = [&wheel, &expired]() {
+		wheel.Advance([&expired](int value) { expired.push_back(value); });
+	};
+
+	// one late call expires everything due, even over a whole round
+	wheel.Add(30, 1);
+	wheel.Add(250, 2);
+	wheel.Add(1000, 3);
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+	advance();
+	CHECK(2 == expired.size());
+	CHECK(3 == expired[0] + expired[1]);
+
+	// calls faster than the tick don't expire early
+	expired.clear();
+	wheel.Add(200, 4);
+	auto start = std::chrono::steady_clock::now();
+	while(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(150))
+	{
+		advance();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK(true == expired.empty());
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	advance();
+	CHECK(1 == expired.size() && 4 == expired[0]);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(700));
+	advance();
+	CHECK(2 == expired.size() && 3 == expired[1]);
+
+	std::cout << "ok" << std::endl;
+	return 0;
+}
@@ -0,0 +1,49 @@
+// Variant of a column string is a number only in decimal form, like mysql and sqlite print it
+#include <Gamnet.h>
+#include <iostream>
+
+#define CHECK(expr) \
+	if(false == (expr)) { std::cerr << __FILE__ << ":" << __LINE__ << " check fail : " << #expr << std::endl; return 1; }
+
+static bool IsDouble(const char* value, double expected)
+{
+	try {
+		return expected == (double)Gamnet::Variant(std::string(value));
+	}
+	catch(const boost::bad_lexical_cast&)
+	{
+		return false;
+	}
+}
+
+static bool IsNotNumber(const char* value)
+{
+	try {
+		(double)Gamnet::Variant(std::string(value));
+	}
+	catch(const boost::bad_lexical_cast&)
+	{
+		return true;
+	}
+	return false;
+}
+
+int main()
+{
+	CHECK(true == IsDouble("1.5", 1.5));
+	CHECK(true == IsDouble("-1e3", -1000.0));
+	CHECK(true == IsDouble("+2.5E-1", 0.25));
+	CHECK(true == IsDouble(".5", 0.5));
+	CHECK(true == IsDouble("5.", 5.0));
+	CHECK(true == IsDouble("18446744073709551616", 18446744073709551616.0));
+	CHECK(-42 == (int)Gamnet::Variant(std::string("-42")));
+
+	for(const char* value : { "0x10", "inf", "-inf", "nan", "infinity", " 1.5", "1.5 ", "1e", "1e+", ".", "-", "+.e1", "1.5.2", "0x1p3", "" })
+	{
+		CHECK(true == IsNotNumber(value));
+		// still readable as string
+		CHECK(value == (std::string)Gamnet::Variant(std::string(value)));
+	}
+	std::cout << "ok" << std::endl;
+	return 0;
+}